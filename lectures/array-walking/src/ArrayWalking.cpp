@@ -1,3 +1,5 @@
+#include "utils/Benchmark.h"
+#include "utils/PerfCounters.h"
 #include "utils/Stopwatch.h"
 
 int main()
@@ -11,10 +13,14 @@ int main()
 	unsigned long long sum;
 	Stopwatch sw;
 
+	// Show why the two orders differ: cache and TLB misses (where the counters are available)
+	PerfCounters counters;
+
 	//
 	// Initialize the elements of the array
 	//
 	std::cout << "Initializing the elements of the array...";
+	counters.start();
 	sw.start();
 
 	for (row = 0; row < RowsCount; ++row)
@@ -22,7 +28,8 @@ int main()
 			parr[ColsCount * row + col] = static_cast<int>(row);
 
 	sw.stop();
-	std::cout << "\n    execution took " << sw << "\n\n";
+	counters.stop();
+	std::cout << "\n    execution took " << sw << "\n    counters: " << counters << "\n\n";
 
 
 	//
@@ -31,14 +38,17 @@ int main()
 	std::cout << "Iterating by columns and then rows...";
 
 	sum = 0;
+	counters.start();
 	sw.start();
 
 	for (col = 0; col < ColsCount; ++col)
 		for (row = 0; row < RowsCount; ++row)
 			sum += parr[ColsCount * row + col];
 
+	doNotOptimize(sum); // Otherwise the unused sum and the whole loop can be removed
 	sw.stop();
-	std::cout << "\n    execution took " << sw << "\n\n";
+	counters.stop();
+	std::cout << "\n    execution took " << sw << "\n    counters: " << counters << "\n\n";
 
 
 	//
@@ -47,14 +57,17 @@ int main()
 	std::cout << "Iterating by rows and then columns...";
 
 	sum = 0;
+	counters.start();
 	sw.start();
 
 	for (row = 0; row < RowsCount; ++row)
 		for (col = 0; col < ColsCount; ++col)
 			sum += parr[ColsCount * row + col];
 
+	doNotOptimize(sum);
 	sw.stop();
-	std::cout << "\n    execution took " << sw << "\n\n";
+	counters.stop();
+	std::cout << "\n    execution took " << sw << "\n    counters: " << counters << "\n\n";
 
 	delete[] parr;
 
@@ -0,0 +1,613 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+///
+/// An ordered set (Mapped = void) or map, implemented as a B+-tree
+///
+/// Each node holds many keys in an array and has the size of a few
+/// cache lines (NodeBytes). A lookup visits one node per level and
+/// the tree has log_B(n) levels, where B is the number of keys in a
+/// node: with int keys and 256-byte nodes, a tree of 10 million keys
+/// has 5-6 levels, while a balanced binary tree has more than 23.
+/// Thus a lookup takes a few cache misses instead of one per level,
+/// and a node uses about 4-8 bytes per key instead of two pointers.
+///
+/// The keys are stored only in the leaves, which are linked in order,
+/// so iterating over a range reads consecutive keys from a few nodes.
+/// The inner nodes contain only separator keys and child pointers.
+///
+/// The keys are unique. Key (and Mapped) must be default-constructible
+/// and copyable, because the nodes store them in arrays. Inserting or
+/// erasing a key invalidates the iterators.
+///
+template <typename Key, typename Mapped = void, size_t NodeBytes = 256>
+class BPlusTree {
+public:
+    using key_type = Key;
+    using mapped_type = Mapped;
+
+private:
+    static constexpr bool IsMap = ! std::is_void_v<Mapped>;
+
+    // Stored in the leaves of a map; a set has no values
+    struct NoValue {};
+    using Value = std::conditional_t<IsMap, Mapped, NoValue>;
+
+    struct Node {
+        unsigned count = 0; // Number of keys
+        bool isLeaf;
+
+        explicit Node(bool isLeaf)
+            : isLeaf(isLeaf)
+        {
+        }
+    };
+
+    static constexpr size_t HeaderBytes = sizeof(Node) + sizeof(void*);
+
+public:
+    /// Maximal number of keys in a leaf
+    static constexpr size_t LeafCapacity = std::max<size_t>(4, (NodeBytes - HeaderBytes) / (sizeof(Key) + (IsMap ? sizeof(Value) : 0)));
+
+    /// Maximal number of keys in an inner node, which has one more child than keys
+    static constexpr size_t InnerCapacity = std::max<size_t>(4, (NodeBytes - HeaderBytes) / (sizeof(Key) + sizeof(void*)));
+
+private:
+    struct Leaf : Node {
+        Key keys[LeafCapacity];
+        [[no_unique_address]] std::conditional_t<IsMap, Value[LeafCapacity], NoValue> values;
+        Leaf* next = nullptr;
+
+        Leaf()
+            : Node(true)
+        {
+        }
+
+        Value& valueAt(size_t i)
+        {
+            if constexpr (IsMap)
+                return values[i];
+            else
+                return values;
+        }
+    };
+
+    struct Inner : Node {
+        // keys[i] is not larger than all keys in children[i+1] and larger than all keys in children[i]
+        Key keys[InnerCapacity];
+        Node* children[InnerCapacity + 1];
+
+        Inner()
+            : Node(false)
+        {
+        }
+    };
+
+    // The result of inserting into a subtree, which had to be split
+    struct Split {
+        bool happened = false;
+        Key separator = Key();
+        Node* right = nullptr;
+    };
+
+    Node* m_root = nullptr;
+    size_t m_size = 0;
+
+    static Leaf* asLeaf(Node* node) noexcept
+    {
+        return static_cast<Leaf*>(node);
+    }
+
+    static Inner* asInner(Node* node) noexcept
+    {
+        return static_cast<Inner*>(node);
+    }
+
+    /// Index of the child of an inner node, whose subtree holds key
+    static size_t childIndex(const Inner* inner, const Key& key)
+    {
+        return std::upper_bound(inner->keys, inner->keys + inner->count, key) - inner->keys;
+    }
+
+    static size_t positionIn(const Leaf* leaf, const Key& key)
+    {
+        return std::lower_bound(leaf->keys, leaf->keys + leaf->count, key) - leaf->keys;
+    }
+
+    Leaf* findLeaf(const Key& key) const
+    {
+        Node* node = m_root;
+
+        while(node && ! node->isLeaf)
+            node = asInner(node)->children[childIndex(asInner(node), key)];
+
+        return asLeaf(node);
+    }
+
+    static void insertIntoLeaf(Leaf* leaf, size_t position, const Key& key, const Value& value)
+    {
+        std::move_backward(leaf->keys + position, leaf->keys + leaf->count, leaf->keys + leaf->count + 1);
+        leaf->keys[position] = key;
+
+        if constexpr (IsMap) {
+            std::move_backward(leaf->values + position, leaf->values + leaf->count, leaf->values + leaf->count + 1);
+            leaf->values[position] = value;
+        }
+
+        ++leaf->count;
+    }
+
+    static void insertIntoInner(Inner* inner, size_t position, const Key& separator, Node* right)
+    {
+        std::move_backward(inner->keys + position, inner->keys + inner->count, inner->keys + inner->count + 1);
+        std::move_backward(inner->children + position + 1, inner->children + inner->count + 1, inner->children + inner->count + 2);
+        inner->keys[position] = separator;
+        inner->children[position + 1] = right;
+        ++inner->count;
+    }
+
+    static void removeFromInner(Inner* inner, size_t position)
+    {
+        // Removes keys[position] and children[position + 1]
+        std::move(inner->keys + position + 1, inner->keys + inner->count, inner->keys + position);
+        std::move(inner->children + position + 2, inner->children + inner->count + 1, inner->children + position + 1);
+        --inner->count;
+    }
+
+    /// Moves the keys from `from` onwards to `to`, which must be empty
+    static void moveTail(Leaf* leaf, size_t from, Leaf* to)
+    {
+        std::move(leaf->keys + from, leaf->keys + leaf->count, to->keys);
+
+        if constexpr (IsMap)
+            std::move(leaf->values + from, leaf->values + leaf->count, to->values);
+
+        to->count = leaf->count - static_cast<unsigned>(from);
+        leaf->count = static_cast<unsigned>(from);
+    }
+
+    Split insertInto(Node* node, const Key& key, const Value& value, bool& inserted)
+    {
+        Split result;
+
+        if(node->isLeaf) {
+            Leaf* leaf = asLeaf(node);
+            size_t position = positionIn(leaf, key);
+
+            if(position < leaf->count && ! (key < leaf->keys[position])) {
+                inserted = false;
+                return result;
+            }
+
+            inserted = true;
+
+            if(leaf->count < LeafCapacity) {
+                insertIntoLeaf(leaf, position, key, value);
+                return result;
+            }
+
+            // Split a full leaf in two halves and insert into one of them
+            Leaf* right = new Leaf();
+            moveTail(leaf, LeafCapacity / 2, right);
+            right->next = leaf->next;
+            leaf->next = right;
+
+            if(position <= leaf->count)
+                insertIntoLeaf(leaf, position, key, value);
+            else
+                insertIntoLeaf(right, position - leaf->count, key, value);
+
+            result.happened = true;
+            result.separator = right->keys[0];
+            result.right = right;
+            return result;
+        }
+
+        Inner* inner = asInner(node);
+        size_t index = childIndex(inner, key);
+        Split childSplit = insertInto(inner->children[index], key, value, inserted);
+
+        if( ! childSplit.happened )
+            return result;
+
+        if(inner->count < InnerCapacity) {
+            insertIntoInner(inner, index, childSplit.separator, childSplit.right);
+            return result;
+        }
+
+        // Split a full inner node. The middle key moves up to the parent.
+        size_t middle = InnerCapacity / 2;
+        Inner* right = new Inner();
+        Key separator = inner->keys[middle];
+
+        right->count = static_cast<unsigned>(InnerCapacity - middle - 1);
+        std::move(inner->keys + middle + 1, inner->keys + InnerCapacity, right->keys);
+        std::move(inner->children + middle + 1, inner->children + InnerCapacity + 1, right->children);
+        inner->count = static_cast<unsigned>(middle);
+
+        if(index <= middle)
+            insertIntoInner(inner, index, childSplit.separator, childSplit.right);
+        else
+            insertIntoInner(right, index - middle - 1, childSplit.separator, childSplit.right);
+
+        result.happened = true;
+        result.separator = separator;
+        result.right = right;
+        return result;
+    }
+
+    /// Restores the minimal number of keys in parent->children[index], by borrowing from or merging with a sibling
+    static void fixUnderflow(Inner* parent, size_t index)
+    {
+        Node* child = parent->children[index];
+        Node* left = index > 0 ? parent->children[index - 1] : nullptr;
+        Node* right = index < parent->count ? parent->children[index + 1] : nullptr;
+
+        if(child->isLeaf) {
+            Leaf* leaf = asLeaf(child);
+
+            if(left && left->count > LeafCapacity / 2) {
+                Leaf* from = asLeaf(left);
+                --from->count;
+                insertIntoLeaf(leaf, 0, from->keys[from->count], from->valueAt(from->count));
+                parent->keys[index - 1] = leaf->keys[0];
+            }
+            else if(right && right->count > LeafCapacity / 2) {
+                Leaf* from = asLeaf(right);
+                insertIntoLeaf(leaf, leaf->count, from->keys[0], from->valueAt(0));
+
+                std::move(from->keys + 1, from->keys + from->count, from->keys);
+                if constexpr (IsMap)
+                    std::move(from->values + 1, from->values + from->count, from->values);
+                --from->count;
+
+                parent->keys[index] = from->keys[0];
+            }
+            else {
+                // Merge with a sibling; the right one of the pair is deleted
+                size_t separator = left ? index - 1 : index;
+                Leaf* into = asLeaf(parent->children[separator]);
+                Leaf* from = asLeaf(parent->children[separator + 1]);
+
+                std::move(from->keys, from->keys + from->count, into->keys + into->count);
+                if constexpr (IsMap)
+                    std::move(from->values, from->values + from->count, into->values + into->count);
+                into->count += from->count;
+                into->next = from->next;
+
+                removeFromInner(parent, separator);
+                delete from;
+            }
+
+            return;
+        }
+
+        Inner* inner = asInner(child);
+
+        if(left && left->count > InnerCapacity / 2) {
+            // The separator moves down, the last key of the sibling moves up
+            Inner* from = asInner(left);
+            std::move_backward(inner->keys, inner->keys + inner->count, inner->keys + inner->count + 1);
+            std::move_backward(inner->children, inner->children + inner->count + 1, inner->children + inner->count + 2);
+            inner->keys[0] = parent->keys[index - 1];
+            inner->children[0] = from->children[from->count];
+            ++inner->count;
+
+            parent->keys[index - 1] = from->keys[from->count - 1];
+            --from->count;
+        }
+        else if(right && right->count > InnerCapacity / 2) {
+            Inner* from = asInner(right);
+            inner->keys[inner->count] = parent->keys[index];
+            inner->children[inner->count + 1] = from->children[0];
+            ++inner->count;
+
+            parent->keys[index] = from->keys[0];
+            std::move(from->keys + 1, from->keys + from->count, from->keys);
+            std::move(from->children + 1, from->children + from->count + 1, from->children);
+            --from->count;
+        }
+        else {
+            size_t separator = left ? index - 1 : index;
+            Inner* into = asInner(parent->children[separator]);
+            Inner* from = asInner(parent->children[separator + 1]);
+
+            into->keys[into->count] = parent->keys[separator];
+            std::move(from->keys, from->keys + from->count, into->keys + into->count + 1);
+            std::move(from->children, from->children + from->count + 1, into->children + into->count + 1);
+            into->count += from->count + 1;
+
+            removeFromInner(parent, separator);
+            delete from;
+        }
+    }
+
+    static bool eraseFrom(Node* node, const Key& key)
+    {
+        if(node->isLeaf) {
+            Leaf* leaf = asLeaf(node);
+            size_t position = positionIn(leaf, key);
+
+            if(position == leaf->count || key < leaf->keys[position])
+                return false;
+
+            std::move(leaf->keys + position + 1, leaf->keys + leaf->count, leaf->keys + position);
+            if constexpr (IsMap)
+                std::move(leaf->values + position + 1, leaf->values + leaf->count, leaf->values + position);
+            --leaf->count;
+
+            return true;
+        }
+
+        Inner* inner = asInner(node);
+        size_t index = childIndex(inner, key);
+
+        if( ! eraseFrom(inner->children[index], key) )
+            return false;
+
+        Node* child = inner->children[index];
+        size_t minimum = (child->isLeaf ? LeafCapacity : InnerCapacity) / 2;
+
+        if(child->count < minimum)
+            fixUnderflow(inner, index);
+
+        return true;
+    }
+
+    static void release(Node* node)
+    {
+        if( ! node )
+            return;
+
+        if(node->isLeaf) {
+            delete asLeaf(node);
+        }
+        else {
+            Inner* inner = asInner(node);
+
+            for(size_t i = 0; i <= inner->count; ++i)
+                release(inner->children[i]);
+
+            delete inner;
+        }
+    }
+
+public:
+    class Iterator {
+        Leaf* m_leaf;
+        size_t m_index;
+
+    public:
+        Iterator(Leaf* leaf, size_t index)
+            : m_leaf(leaf), m_index(index)
+        {
+            // Positions past the end of a leaf refer to the start of the next one
+            if(m_leaf && m_index == m_leaf->count) {
+                m_leaf = m_leaf->next;
+                m_index = 0;
+            }
+        }
+
+        const Key& operator*() const
+        {
+            return m_leaf->keys[m_index];
+        }
+
+        const Key* operator->() const
+        {
+            return &m_leaf->keys[m_index];
+        }
+
+        /// The value of the current key (maps only)
+        template <typename M = Mapped, typename = std::enable_if_t<! std::is_void_v<M>>>
+        M& mapped() const
+        {
+            return m_leaf->values[m_index];
+        }
+
+        void operator++()
+        {
+            if(++m_index == m_leaf->count) {
+                m_leaf = m_leaf->next;
+                m_index = 0;
+            }
+        }
+
+        bool operator==(const Iterator& other) const
+        {
+            return m_leaf == other.m_leaf && m_index == other.m_index;
+        }
+
+        bool operator!=(const Iterator& other) const
+        {
+            return ! (*this == other);
+        }
+    };
+
+public:
+    BPlusTree() = default;
+
+    ~BPlusTree()
+    {
+        clear();
+    }
+
+    BPlusTree(const BPlusTree& other)
+    {
+        // The keys come in order, so only the rightmost leaf and inner nodes are split
+        try {
+            for(Iterator it = other.beginIterator(); it != other.endIterator(); ++it) {
+                if constexpr (IsMap)
+                    insert(*it, it.mapped());
+                else
+                    insert(*it);
+            }
+        }
+        catch(...) {
+            clear();
+            throw;
+        }
+    }
+
+    BPlusTree(BPlusTree&& other) noexcept
+        : m_root(std::exchange(other.m_root, nullptr)), m_size(std::exchange(other.m_size, 0))
+    {
+        // Nothing to do here
+    }
+
+    BPlusTree& operator=(BPlusTree other) noexcept
+    {
+        std::swap(m_root, other.m_root);
+        std::swap(m_size, other.m_size);
+        return *this;
+    }
+
+    void clear()
+    {
+        release(m_root);
+        m_root = nullptr;
+        m_size = 0;
+    }
+
+    size_t size() const noexcept
+    {
+        return m_size;
+    }
+
+    bool empty() const noexcept
+    {
+        return m_size == 0;
+    }
+
+    /// Number of levels (0 for an empty tree, 1 when the root is a leaf)
+    size_t height() const noexcept
+    {
+        size_t result = 0;
+
+        for(Node* node = m_root; node; node = node->isLeaf ? nullptr : asInner(node)->children[0])
+            ++result;
+
+        return result;
+    }
+
+    bool contains(const Key& key) const
+    {
+        Leaf* leaf = findLeaf(key);
+
+        if( ! leaf )
+            return false;
+
+        size_t position = positionIn(leaf, key);
+        return position < leaf->count && ! (key < leaf->keys[position]);
+    }
+
+    ///
+    /// Returns a pointer to the value of a key, or nullptr if the key is not in the map
+    ///
+    template <typename M = Mapped, typename = std::enable_if_t<! std::is_void_v<M>>>
+    M* find(const Key& key)
+    {
+        Leaf* leaf = findLeaf(key);
+
+        if( ! leaf )
+            return nullptr;
+
+        size_t position = positionIn(leaf, key);
+        return position < leaf->count && ! (key < leaf->keys[position]) ? &leaf->values[position] : nullptr;
+    }
+
+    ///
+    /// Inserts a key into a set
+    ///
+    /// @return true if the key was inserted, false if it was already present
+    ///
+    template <typename M = Mapped, typename = std::enable_if_t<std::is_void_v<M>>>
+    bool insert(const Key& key)
+    {
+        return insertValue(key, Value());
+    }
+
+    ///
+    /// Inserts a key and its value into a map
+    ///
+    /// @return true if the key was inserted, false if it was already present (its value is not changed)
+    ///
+    template <typename M = Mapped, typename = std::enable_if_t<! std::is_void_v<M>>>
+    bool insert(const Key& key, const M& value)
+    {
+        return insertValue(key, value);
+    }
+
+    /// @return true if the key was erased, false if it was not present
+    bool erase(const Key& key)
+    {
+        if( ! m_root || ! eraseFrom(m_root, key) )
+            return false;
+
+        --m_size;
+
+        // The root may be left without keys
+        if(m_root->isLeaf && m_root->count == 0) {
+            delete asLeaf(m_root);
+            m_root = nullptr;
+        }
+        else if( ! m_root->isLeaf && m_root->count == 0 ) {
+            Inner* old = asInner(m_root);
+            m_root = old->children[0];
+            delete old;
+        }
+
+        return true;
+    }
+
+    Iterator beginIterator() const
+    {
+        Node* node = m_root;
+
+        while(node && ! node->isLeaf)
+            node = asInner(node)->children[0];
+
+        return Iterator(asLeaf(node), 0);
+    }
+
+    Iterator endIterator() const
+    {
+        return Iterator(nullptr, 0);
+    }
+
+    /// Returns an iterator to the smallest key, which is not less than `key`
+    Iterator lowerBound(const Key& key) const
+    {
+        Leaf* leaf = findLeaf(key);
+        return leaf ? Iterator(leaf, positionIn(leaf, key)) : endIterator();
+    }
+
+private:
+    bool insertValue(const Key& key, const Value& value)
+    {
+        if( ! m_root )
+            m_root = new Leaf();
+
+        bool inserted = false;
+        Split split = insertInto(m_root, key, value, inserted);
+
+        if(split.happened) {
+            Inner* root = new Inner();
+            root->count = 1;
+            root->keys[0] = split.separator;
+            root->children[0] = m_root;
+            root->children[1] = split.right;
+            m_root = root;
+        }
+
+        if(inserted)
+            ++m_size;
+
+        return inserted;
+    }
+};
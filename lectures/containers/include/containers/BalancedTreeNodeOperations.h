@@ -0,0 +1,578 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <utility>
+
+#include "containers/TreeNode.h"
+#include "containers/TreeNodeOperations.h"
+
+///
+/// Rotations, which are shared by the self-balancing NodeOperations
+///
+/// A rotation changes the shape of a subtree, but not the order of
+/// its values. `root` is the pointer, which refers to the subtree
+/// (the root pointer of the tree, or a `left` or `right` member),
+/// and is updated to refer to the new root of the subtree. Parent
+/// pointers and subtree sizes (if the nodes have them) are kept consistent.
+///
+template <typename ElementType, typename NodeType = TreeNode<ElementType>>
+class TreeRotations {
+public:
+    using node_type = NodeType;
+
+    ///
+    /// Makes the left successor of `root` the root of the subtree
+    ///
+    /// Writing a node as node(left, right), the subtree
+    /// root(L(A, B), C) becomes L(A, root(B, C)).
+    ///
+    static void rotateRight(node_type*& root)
+    {
+        node_type* promoted = root->left;
+        root->left = promoted->right;
+        linkParent(root->left, root);
+        linkParent(promoted, parentOf(root));
+        promoted->right = root;
+        linkParent(root, promoted);
+        updateSubtreeSize(root);
+        updateSubtreeSize(promoted);
+        root = promoted;
+    }
+
+    /// Makes the right successor of `root` the root of the subtree (the mirror of rotateRight)
+    static void rotateLeft(node_type*& root)
+    {
+        node_type* promoted = root->right;
+        root->right = promoted->left;
+        linkParent(root->right, root);
+        linkParent(promoted, parentOf(root));
+        promoted->left = root;
+        linkParent(root, promoted);
+        updateSubtreeSize(root);
+        updateSubtreeSize(promoted);
+        root = promoted;
+    }
+};
+
+///
+/// AVL tree operations
+///
+/// `balance` stores the height of the subtree of a node (1 for a leaf).
+/// The heights of the two subtrees of each node differ by at most one,
+/// so the height of a tree with n nodes is less than 1.45 log2(n) and
+/// insert, extract and findPointerTo take O(log n) time even when the
+/// values arrive in sorted order.
+///
+/// The operations are recursive, but the recursion is as deep as
+/// the tree, so the stack cannot overflow.
+///
+template <typename ElementType, typename NodeType = TreeNode<ElementType>>
+class AvlNodeOperations : public RecursiveNodeOperations<ElementType, NodeType> {
+public:
+    using value_type = ElementType;
+    using node_type = NodeType;
+
+private:
+    using Rotations = TreeRotations<value_type, node_type>;
+
+    static unsigned height(const node_type* node) noexcept
+    {
+        return node ? node->balance : 0;
+    }
+
+    static void updateHeight(node_type* node) noexcept
+    {
+        node->balance = 1 + std::max(height(node->left), height(node->right));
+    }
+
+    static void rotateRight(node_type*& root)
+    {
+        Rotations::rotateRight(root);
+        updateHeight(root->right);
+        updateHeight(root);
+    }
+
+    static void rotateLeft(node_type*& root)
+    {
+        Rotations::rotateLeft(root);
+        updateHeight(root->left);
+        updateHeight(root);
+    }
+
+    ///
+    /// Restores the AVL property of `root`, after one of its subtrees changed its height by one
+    ///
+    static void rebalance(node_type*& root)
+    {
+        unsigned left = height(root->left);
+        unsigned right = height(root->right);
+
+        if(left > right + 1) {
+            // A left-right case becomes a left-left one
+            if(height(root->left->left) < height(root->left->right))
+                rotateLeft(root->left);
+            rotateRight(root);
+        }
+        else if(right > left + 1) {
+            if(height(root->right->right) < height(root->right->left))
+                rotateRight(root->right);
+            rotateLeft(root);
+        }
+        else {
+            updateHeight(root);
+            updateSubtreeSize(root);
+        }
+    }
+
+    static node_type* extractSmallest(node_type*& root)
+    {
+        if(root->left == nullptr) {
+            node_type* result = root;
+            root = root->right;
+            linkParent(root, parentOf(result));
+            return result;
+        }
+
+        node_type* result = extractSmallest(root->left);
+        rebalance(root);
+        return result;
+    }
+
+public:
+    /// @copydoc RecursiveNodeOperations::insert
+    static void insert(node_type*& rootptr, node_type& node)
+    {
+        if(rootptr == nullptr) {
+            node.detachSuccessors();
+            node.balance = 1;
+            updateSubtreeSize(&node);
+            linkParent<node_type>(&node, nullptr); // The caller links it to its parent
+            rootptr = &node;
+            return;
+        }
+
+        node_type*& successor = rootptr->whichSuccessorWouldStore(node.data);
+        insert(successor, node);
+        linkParent(successor, rootptr);
+        rebalance(rootptr);
+    }
+
+    /// @copydoc RecursiveNodeOperations::extract
+    static node_type* extract(node_type*& rootptr, const value_type& data)
+    {
+        if(rootptr == nullptr)
+            return nullptr;
+
+        node_type* result = nullptr;
+
+        if(data < rootptr->data) {
+            result = extract(rootptr->left, data);
+        }
+        else if(rootptr->data < data) {
+            result = extract(rootptr->right, data);
+        }
+        else {
+            result = rootptr;
+
+            if(result->left == nullptr) {
+                rootptr = result->right;
+            }
+            else if(result->right == nullptr) {
+                rootptr = result->left;
+            }
+            else {
+                // The successor of the extracted node takes its place
+                node_type* promoted = extractSmallest(result->right);
+                promoted->left = result->left;
+                promoted->right = result->right;
+                linkParent(promoted->left, promoted);
+                linkParent(promoted->right, promoted);
+                rootptr = promoted;
+            }
+
+            linkParent(rootptr, parentOf(result));
+            linkParent<node_type>(result, nullptr);
+            result->detachSuccessors();
+        }
+
+        if(result && rootptr)
+            rebalance(rootptr);
+
+        return result;
+    }
+
+    /// @copydoc RecursiveNodeOperations::buildBalanced
+    static node_type* buildBalanced(node_type* list, size_t count)
+    {
+        node_type* root = buildBalancedTree(list, count, [](node_type* node, size_t, size_t) { updateHeight(node); });
+        linkParent<node_type>(root, nullptr);
+        return root;
+    }
+};
+
+///
+/// Red-black tree operations
+///
+/// Implements the left-leaning red-black tree of R. Sedgewick: red
+/// links lean left and no node has two red links, so the tree
+/// corresponds to a 2-3 tree. `balance` stores the color of the link,
+/// which points to a node. The height is at most 2 log2(n), so the
+/// operations take O(log n) time. Compared to AvlNodeOperations, the
+/// trees are less strictly balanced, but insertions rotate less.
+///
+template <typename ElementType, typename NodeType = TreeNode<ElementType>>
+class RedBlackNodeOperations : public RecursiveNodeOperations<ElementType, NodeType> {
+public:
+    using value_type = ElementType;
+    using node_type = NodeType;
+
+    static constexpr unsigned Black = 0;
+    static constexpr unsigned Red = 1;
+
+private:
+    using Rotations = TreeRotations<value_type, node_type>;
+
+    static bool isRed(const node_type* node) noexcept
+    {
+        return node && node->balance == Red;
+    }
+
+    static void rotateLeft(node_type*& root)
+    {
+        unsigned color = root->balance;
+        Rotations::rotateLeft(root);
+        root->balance = color;
+        root->left->balance = Red;
+    }
+
+    static void rotateRight(node_type*& root)
+    {
+        unsigned color = root->balance;
+        Rotations::rotateRight(root);
+        root->balance = color;
+        root->right->balance = Red;
+    }
+
+    static void flipColors(node_type* node) noexcept
+    {
+        node->balance ^= 1;
+        node->left->balance ^= 1;
+        node->right->balance ^= 1;
+    }
+
+    /// Restores the invariants of the tree on the way up from an insertion or a deletion
+    static void fixUp(node_type*& root)
+    {
+        updateSubtreeSize(root);
+
+        if(isRed(root->right) && ! isRed(root->left))
+            rotateLeft(root);
+        if(isRed(root->left) && isRed(root->left->left))
+            rotateRight(root);
+        if(isRed(root->left) && isRed(root->right))
+            flipColors(root);
+    }
+
+    /// Makes root->left or one of its successors red, assuming root is red and both of them are black
+    static void moveRedLeft(node_type*& root)
+    {
+        flipColors(root);
+
+        if(isRed(root->right->left)) {
+            rotateRight(root->right);
+            rotateLeft(root);
+            flipColors(root);
+        }
+    }
+
+    /// Makes root->right or one of its successors red, assuming root is red and both of them are black
+    static void moveRedRight(node_type*& root)
+    {
+        flipColors(root);
+
+        if(isRed(root->left->left)) {
+            rotateRight(root);
+            flipColors(root);
+        }
+    }
+
+    static void insertInto(node_type*& root, node_type& node)
+    {
+        if(root == nullptr) {
+            node.detachSuccessors();
+            node.balance = Red;
+            updateSubtreeSize(&node);
+            linkParent<node_type>(&node, nullptr); // The caller links it to its parent
+            root = &node;
+            return;
+        }
+
+        node_type*& successor = root->whichSuccessorWouldStore(node.data);
+        insertInto(successor, node);
+        linkParent(successor, root);
+        fixUp(root);
+    }
+
+    static node_type* extractSmallest(node_type*& root)
+    {
+        // A node without a left successor has no right one either
+        if(root->left == nullptr) {
+            node_type* result = root;
+            root = nullptr;
+            return result;
+        }
+
+        if( ! isRed(root->left) && ! isRed(root->left->left) )
+            moveRedLeft(root);
+
+        node_type* result = extractSmallest(root->left);
+        fixUp(root);
+        return result;
+    }
+
+    /// Extracts a node with value `data`, which must be present in the tree
+    static node_type* extractFrom(node_type*& root, const value_type& data)
+    {
+        node_type* result = nullptr;
+
+        if(data < root->data) {
+            if( ! isRed(root->left) && ! isRed(root->left->left) )
+                moveRedLeft(root);
+
+            result = extractFrom(root->left, data);
+        }
+        else {
+            if(isRed(root->left))
+                rotateRight(root);
+
+            if( ! (root->data < data) && root->right == nullptr ) {
+                result = root;
+                root = nullptr;
+                return result;
+            }
+
+            node_type* before = root;
+
+            if( ! isRed(root->right) && ! isRed(root->right->left) )
+                moveRedRight(root);
+
+            // If moveRedRight rotated, the new root is not larger than
+            // `data`, but the old one (now on the right) may be equal to it.
+            // Descending to the right is then always correct, also when
+            // there are duplicates.
+            if(root == before && ! (root->data < data)) {
+                // The successor of the extracted node takes its place
+                result = root;
+                node_type* promoted = extractSmallest(result->right);
+                promoted->left = result->left;
+                promoted->right = result->right;
+                promoted->balance = result->balance;
+                linkParent(promoted, parentOf(result));
+                linkParent(promoted->left, promoted);
+                linkParent(promoted->right, promoted);
+                root = promoted;
+            }
+            else {
+                result = extractFrom(root->right, data);
+            }
+        }
+
+        fixUp(root);
+        return result;
+    }
+
+public:
+    /// @copydoc RecursiveNodeOperations::insert
+    static void insert(node_type*& rootptr, node_type& node)
+    {
+        insertInto(rootptr, node);
+        rootptr->balance = Black;
+    }
+
+    /// @copydoc RecursiveNodeOperations::extract
+    static node_type* extract(node_type*& rootptr, const value_type& data)
+    {
+        if(RecursiveNodeOperations<ElementType, NodeType>::findPointerTo(data, rootptr) == nullptr)
+            return nullptr;
+
+        if( ! isRed(rootptr->left) && ! isRed(rootptr->right) )
+            rootptr->balance = Red;
+
+        node_type* result = extractFrom(rootptr, data);
+
+        if(rootptr)
+            rootptr->balance = Black;
+
+        linkParent<node_type>(result, nullptr);
+        result->detachSuccessors();
+        return result;
+    }
+
+    ///
+    /// @copydoc RecursiveNodeOperations::buildBalanced
+    ///
+    /// A subtree of n nodes has std::bit_width(n + 1) - 1 full levels,
+    /// which are black. The subtrees of a node differ in that only when
+    /// the left one is full and has one more level than the right one.
+    /// The root of the left one is then red, so all paths have the same
+    /// number of black nodes and red links only lean left.
+    ///
+    static node_type* buildBalanced(node_type* list, size_t count)
+    {
+        node_type* root = buildBalancedTree(list, count, [](node_type* node, size_t leftCount, size_t rightCount) {
+            node->balance = Black;
+
+            if(std::bit_width(leftCount + 1) != std::bit_width(rightCount + 1))
+                node->left->balance = Red;
+        });
+
+        linkParent<node_type>(root, nullptr);
+        return root;
+    }
+};
+
+///
+/// Treap operations
+///
+/// Each node gets a random priority (stored in `balance`) when it is
+/// inserted, and the tree is kept a heap by priority with rotations.
+/// The shape of the tree is then that of an unbalanced BST, into which
+/// the values were inserted in random order, regardless of the actual
+/// order. The expected height is O(log n), but it is not guaranteed.
+/// The implementation is the simplest of the three.
+///
+template <typename ElementType, typename NodeType = TreeNode<ElementType>>
+class TreapNodeOperations : public RecursiveNodeOperations<ElementType, NodeType> {
+public:
+    using value_type = ElementType;
+    using node_type = NodeType;
+
+private:
+    using Rotations = TreeRotations<value_type, node_type>;
+
+    static unsigned randomPriority() noexcept
+    {
+        // splitmix64, seeded differently in each thread
+        static std::atomic<uint64_t> seeds{0};
+        thread_local uint64_t state = seeds.fetch_add(0x9E3779B97F4A7C15ULL, std::memory_order_relaxed);
+
+        uint64_t x = (state += 0x9E3779B97F4A7C15ULL);
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+        return static_cast<unsigned>((x ^ (x >> 31)) >> 32);
+    }
+
+    static void insertInto(node_type*& root, node_type& node)
+    {
+        if(root == nullptr) {
+            root = &node;
+            return;
+        }
+
+        node_type*& successor = root->whichSuccessorWouldStore(node.data);
+        insertInto(successor, node);
+        linkParent(successor, root);
+        updateSubtreeSize(root);
+
+        // Rotate the new node up, while its priority is higher
+        if(successor->balance > root->balance) {
+            if(&successor == &root->left)
+                Rotations::rotateRight(root);
+            else
+                Rotations::rotateLeft(root);
+        }
+    }
+
+    /// Swaps the priority of `node` with those below it, until it is not lower than the priorities of its successors
+    static void siftDownPriority(node_type* node) noexcept
+    {
+        while(true) {
+            node_type* highest = node;
+
+            if(node->left && node->left->balance > highest->balance)
+                highest = node->left;
+            if(node->right && node->right->balance > highest->balance)
+                highest = node->right;
+
+            if(highest == node)
+                return;
+
+            std::swap(node->balance, highest->balance);
+            node = highest;
+        }
+    }
+
+    /// Extracts the node `root` refers to, by rotating it down until it has at most one successor
+    static node_type* extractRoot(node_type*& root)
+    {
+        node_type* result = root;
+
+        if(result->left == nullptr) {
+            root = result->right;
+        }
+        else if(result->right == nullptr) {
+            root = result->left;
+        }
+        else if(result->left->balance > result->right->balance) {
+            Rotations::rotateRight(root);
+            extractRoot(root->right);
+            updateSubtreeSize(root);
+            return result;
+        }
+        else {
+            Rotations::rotateLeft(root);
+            extractRoot(root->left);
+            updateSubtreeSize(root);
+            return result;
+        }
+
+        linkParent(root, parentOf(result));
+        linkParent<node_type>(result, nullptr);
+        result->detachSuccessors();
+        return result;
+    }
+
+public:
+    /// @copydoc RecursiveNodeOperations::insert
+    static void insert(node_type*& rootptr, node_type& node)
+    {
+        node.detachSuccessors();
+        node.balance = randomPriority();
+        updateSubtreeSize(&node);
+        linkParent(&node, parentOf(rootptr));
+        insertInto(rootptr, node);
+    }
+
+    /// @copydoc RecursiveNodeOperations::extract
+    static node_type* extract(node_type*& rootptr, const value_type& data)
+    {
+        node_type*& ptr = RecursiveNodeOperations<ElementType, NodeType>::findPointerTo(data, rootptr);
+
+        if(ptr == nullptr)
+            return nullptr;
+
+        shrinkSubtreeSizesAbove(rootptr, ptr);
+        return extractRoot(ptr);
+    }
+
+    ///
+    /// @copydoc RecursiveNodeOperations::buildBalanced
+    ///
+    /// Each node gets a random priority, which is then moved down
+    /// like in building a binary heap, so the priorities form a heap
+    /// without changing the shape of the tree.
+    ///
+    static node_type* buildBalanced(node_type* list, size_t count)
+    {
+        node_type* root = buildBalancedTree(list, count, [](node_type* node, size_t, size_t) {
+            node->balance = randomPriority();
+            siftDownPriority(node);
+        });
+
+        linkParent<node_type>(root, nullptr);
+        return root;
+    }
+};
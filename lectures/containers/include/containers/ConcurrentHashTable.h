@@ -0,0 +1,212 @@
+#pragma once
+
+#include <bit>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+
+#include "containers/HashTable.h"
+
+///
+/// A hash table, split into independently locked shards
+///
+/// Each shard is an ordinary (not thread-safe) hash table, guarded by
+/// its own reader/writer lock. A key always goes to the same shard,
+/// which is selected by the highest bits of its mixed hash. The table
+/// in the shard selects a bucket by the lowest bits of the hash, so
+/// the two choices are independent.
+///
+/// Operations on keys from different shards do not contend with each
+/// other. Lookups in the same shard run in parallel and are blocked
+/// only by writers to that shard.
+///
+/// This is the common implementation of ConcurrentHashSet and
+/// ConcurrentHashMap.
+///
+template <typename TableType, size_t ShardsCount>
+class ShardedHashTable {
+    static_assert(std::has_single_bit(ShardsCount), "the number of shards must be a power of two");
+
+public:
+    using key_type = typename TableType::key_type;
+    using value_type = typename TableType::value_type;
+    using hasher = typename TableType::hasher;
+
+protected:
+    /// Each shard takes separate cache lines, so that locking
+    /// one shard does not invalidate the lock of another
+    struct alignas(64) Shard {
+        mutable std::shared_mutex mutex;
+        TableType table;
+    };
+
+    std::unique_ptr<Shard[]> m_shards = std::make_unique<Shard[]>(ShardsCount);
+    hasher m_hash = hasher();
+
+    /// Selects the shard for a key by the highest bits of its (mixed) hash
+    Shard& shardFor(size_t hash) const noexcept
+    {
+        constexpr int shift = std::numeric_limits<size_t>::digits - std::countr_zero(ShardsCount);
+
+        if constexpr (ShardsCount == 1)
+            return m_shards[0];
+        else
+            return m_shards[mixHashBits(hash) >> shift];
+    }
+
+public:
+    ShardedHashTable() = default;
+
+    ShardedHashTable(const ShardedHashTable&) = delete;
+    ShardedHashTable& operator=(const ShardedHashTable&) = delete;
+
+    static constexpr size_t shards_count() noexcept
+    {
+        return ShardsCount;
+    }
+
+    ///
+    /// Returns the number of elements in the table
+    ///
+    /// The shards are counted one after another. If other threads
+    /// modify the table at the same time, the result may not
+    /// correspond to any single moment.
+    ///
+    size_t size() const
+    {
+        size_t result = 0;
+
+        for(size_t i = 0; i < ShardsCount; ++i) {
+            std::shared_lock lock(m_shards[i].mutex);
+            result += m_shards[i].table.size();
+        }
+
+        return result;
+    }
+
+    bool contains(const key_type& key) const
+    {
+        size_t hash = m_hash(key);
+        Shard& shard = shardFor(hash);
+
+        std::shared_lock lock(shard.mutex);
+        return shard.table.contains_hashed(key, hash);
+    }
+
+    ///
+    /// Inserts a value, unless an element with the same key is already present
+    /// @return true if the value was inserted
+    ///
+    bool insert(const value_type& value)
+    {
+        size_t hash = m_hash(TableType::keyOf(value));
+        Shard& shard = shardFor(hash);
+
+        std::unique_lock lock(shard.mutex);
+        return shard.table.insert_hashed(value, hash).second;
+    }
+
+    ///
+    /// Removes the element with a given key
+    /// @return The number of elements removed (0 or 1)
+    ///
+    size_t erase(const key_type& key)
+    {
+        Shard& shard = shardFor(m_hash(key));
+
+        std::unique_lock lock(shard.mutex);
+        return shard.table.erase(key);
+    }
+
+    /// Prepares the table to store elementsCount elements, assuming they are evenly distributed among the shards
+    void reserve(size_t elementsCount)
+    {
+        for(size_t i = 0; i < ShardsCount; ++i) {
+            std::unique_lock lock(m_shards[i].mutex);
+            m_shards[i].table.reserve(elementsCount / ShardsCount + 1);
+        }
+    }
+
+    void clear()
+    {
+        for(size_t i = 0; i < ShardsCount; ++i) {
+            std::unique_lock lock(m_shards[i].mutex);
+            m_shards[i].table.clear();
+        }
+    }
+};
+
+///
+/// Thread-safe hash set with striped (per-shard) locking
+///
+template <typename ElementType, typename Hash = std::hash<ElementType>, size_t ShardsCount = 64>
+using ConcurrentHashSet = ShardedHashTable<SeparateChainingHash<ElementType, Hash>, ShardsCount>;
+
+///
+/// Thread-safe hash map with striped (per-shard) locking
+///
+/// The map never returns references to its values, because another
+/// thread could erase them at any time. Values are returned as copies
+/// or accessed under the lock of their shard via visit().
+///
+template <typename KeyType, typename MappedType, typename Hash = std::hash<KeyType>, size_t ShardsCount = 64>
+class ConcurrentHashMap : public ShardedHashTable<SeparateChainingHashMap<KeyType, MappedType, Hash>, ShardsCount> {
+    using base = ShardedHashTable<SeparateChainingHashMap<KeyType, MappedType, Hash>, ShardsCount>;
+
+public:
+    using mapped_type = MappedType;
+    using typename base::key_type;
+
+    /// Associates a value with a key, replacing the old value if the key is present
+    void insert_or_assign(const key_type& key, const mapped_type& value)
+    {
+        size_t hash = this->m_hash(key);
+        auto& shard = this->shardFor(hash);
+
+        std::unique_lock lock(shard.mutex);
+        auto result = shard.table.insert_hashed(typename base::value_type(key, value), hash);
+
+        if( ! result.second )
+            result.first->second = value;
+    }
+
+    /// Returns a copy of the value associated with a key, or nothing if the key is not present
+    std::optional<mapped_type> get(const key_type& key) const
+    {
+        size_t hash = this->m_hash(key);
+        auto& shard = this->shardFor(hash);
+
+        // Readers share the lock, so they must use only the const interface of the table
+        const auto& table = shard.table;
+
+        std::shared_lock lock(shard.mutex);
+        auto it = table.find_hashed(key, hash);
+
+        return (it == table.end()) ? std::nullopt : std::optional<mapped_type>(it->second);
+    }
+
+    ///
+    /// Calls `visitor(value)` for the value associated with a key, while holding the lock of its shard
+    ///
+    /// The visitor may modify the value. It should be short and must
+    /// not access the map, as this may cause a deadlock.
+    /// @return true if the key was found and the visitor was called
+    ///
+    template <typename Visitor>
+    bool visit(const key_type& key, Visitor&& visitor)
+    {
+        size_t hash = this->m_hash(key);
+        auto& shard = this->shardFor(hash);
+
+        std::unique_lock lock(shard.mutex);
+        auto it = shard.table.find_hashed(key, hash);
+
+        if(it == shard.table.end())
+            return false;
+
+        visitor(it->second);
+        return true;
+    }
+};
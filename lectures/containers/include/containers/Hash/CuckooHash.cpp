@@ -0,0 +1,228 @@
+/********************************************************************
+ *
+ * This file is part of the Data structures and algorithms in C++ package
+ *
+ * Author: Atanas Semerdzhiev
+ * URL: https://github.com/semerdzhiev/sdp-samples
+ *
+ */
+
+#include <algorithm>
+#include <bit>
+#include <iostream>
+#include <utility>
+
+#include "CuckooHash.h"
+
+CuckooHash::CuckooHash(HashingFunction* pHashingFunction, size_t MaxSize)
+    : Hash(pHashingFunction), elementsCount(0), stash(allocator)
+{
+    // Two tables, which together are at most MaxLoadFactor full with MaxSize elements
+    tableSize = std::bit_ceil(static_cast<size_t>(std::max<size_t>(MaxSize, 8) / (2 * MaxLoadFactor)) + 1);
+    tableBits = std::countr_zero(tableSize);
+
+    for (int t = 0; t < 2; t++)
+    {
+        pTables[t] = allocator.allocate(tableSize);
+        std::fill(pTables[t], pTables[t] + tableSize, Empty);
+    }
+}
+
+CuckooHash::~CuckooHash()
+{
+    allocator.deallocate(pTables[0], tableSize);
+    allocator.deallocate(pTables[1], tableSize);
+}
+
+size_t CuckooHash::PositionIn(int Table, int Value) const
+{
+    if (Table == 0)
+        return static_cast<size_t>(pHashingFunction->CalculateHash(Value)) & (tableSize - 1);
+    else
+        return SecondaryHash(Value, tableBits);
+}
+
+int* CuckooHash::Find(int Value, size_t& Probes)
+{
+    for (int t = 0; t < 2; t++)
+    {
+        int* p = &pTables[t][PositionIn(t, Value)];
+        Probes++;
+
+        if (*p == Value)
+            return p;
+    }
+
+    auto it = std::find(stash.begin(), stash.end(), Value);
+    Probes += it - stash.begin();
+
+    return it == stash.end() ? nullptr : &*it;
+}
+
+size_t CuckooHash::Place(int Value)
+{
+    size_t probes = 0;
+
+    for (size_t i = 0; i < MaxDisplacements; i++)
+    {
+        // Take a free position, if there is one
+        for (int t = 0; t < 2; t++)
+        {
+            int& slot = pTables[t][PositionIn(t, Value)];
+            probes++;
+
+            if (slot == Empty)
+            {
+                slot = Value;
+                return probes;
+            }
+        }
+
+        // Both are taken. Displace the value in the table, selected by the step parity,
+        // so that the same value is not kicked back and forth. The eviction counts as a probe.
+        std::swap(Value, pTables[i % 2][PositionIn(i % 2, Value)]);
+        probes++;
+    }
+
+    if ((double)elementsCount < MaxLoadFactor * 2 * tableSize)
+    {
+        // The tables have enough space, so the failure is caused by the
+        // hashing function and growing would not help
+        stash.push_back(Value);
+        probes++;
+    }
+    else
+    {
+        // The whole rehash is charged to this insertion, so it shows in the maximum
+        probes += Grow();
+        probes += Place(Value);
+    }
+
+    return probes;
+}
+
+size_t CuckooHash::Grow()
+{
+    size_t probes = 0;
+    int* pOld[2] = { pTables[0], pTables[1] };
+    size_t oldSize = tableSize;
+
+    tableSize *= 2;
+    tableBits++;
+
+    for (int t = 0; t < 2; t++)
+    {
+        pTables[t] = allocator.allocate(tableSize);
+        std::fill(pTables[t], pTables[t] + tableSize, Empty);
+    }
+
+    std::vector<int, CountingAllocator<int>> oldStash(allocator);
+    oldStash.swap(stash);
+
+    for (int t = 0; t < 2; t++)
+    {
+        for (size_t i = 0; i < oldSize; i++)
+        {
+            if (pOld[t][i] != Empty)
+                probes += Place(pOld[t][i]);
+        }
+
+        allocator.deallocate(pOld[t], oldSize);
+    }
+
+    for (int value : oldStash)
+        probes += Place(value);
+
+    return probes;
+}
+
+bool CuckooHash::Add(const int Value)
+{
+    if (Value < 0)
+        return false;
+
+    // An insertion costs the lookup for a duplicate and the displacement chain
+    size_t probes = 0;
+
+    if (Find(Value, probes))
+    {
+        probeStatistics.Record(probes);
+        return false;
+    }
+
+    probes += Place(Value);
+    probeStatistics.Record(probes);
+    elementsCount++;
+
+    return true;
+}
+
+bool CuckooHash::Search(const int Value)
+{
+    if (Value < 0)
+        return false;
+
+    size_t probes = 0;
+    bool found = Find(Value, probes) != nullptr;
+    probeStatistics.Record(probes);
+
+    return found;
+}
+
+bool CuckooHash::Remove(const int Value)
+{
+    if (Value < 0)
+        return false;
+
+    for (int t = 0; t < 2; t++)
+    {
+        int& slot = pTables[t][PositionIn(t, Value)];
+
+        if (slot == Value)
+        {
+            slot = Empty;
+            elementsCount--;
+            return true;
+        }
+    }
+
+    auto it = std::find(stash.begin(), stash.end(), Value);
+
+    if (it == stash.end())
+        return false;
+
+    stash.erase(it);
+    elementsCount--;
+
+    return true;
+}
+
+size_t CuckooHash::GetElementsCount() const
+{
+    return elementsCount;
+}
+
+size_t CuckooHash::GetStashSize() const
+{
+    return stash.size();
+}
+
+const ProbeStatistics& CuckooHash::GetProbeStatistics() const
+{
+    return probeStatistics;
+}
+
+void CuckooHash::ResetProbeStatistics()
+{
+    probeStatistics.Reset();
+}
+
+void CuckooHash::PrintInfo() const
+{
+    std::cout
+        << "CuckooHash:"
+        << "\n   - Used space: " << (((double)elementsCount * 100) / (2 * tableSize)) << "%"
+        << "\n   - Stash size: " << stash.size();
+
+    PrintCommonInfo(elementsCount, MemoryUsed(sizeof(*this))); // Both tables and the stash
+}
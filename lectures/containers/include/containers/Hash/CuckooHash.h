@@ -0,0 +1,81 @@
+/********************************************************************
+ *
+ * This file is part of the Data structures and algorithms in C++ package
+ *
+ * Author: Atanas Semerdzhiev
+ * URL: https://github.com/semerdzhiev/sdp-samples
+ *
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "Hash.h"
+
+///
+/// An implementation of a 2-choice cuckoo hash
+///
+/// Each value has exactly two possible positions: one in the first
+/// table, given by the hashing function, and one in the second table,
+/// given by SecondaryHash. Thus a search examines at most two positions.
+///
+/// When both positions of a new value are taken, the value takes the
+/// first one anyway and the value it displaces moves to its other
+/// position, possibly displacing another value, and so on. If this
+/// does not end after MaxDisplacements steps, the tables are grown
+/// and rebuilt. When the hashing function is poor (e.g. it has fewer
+/// distinct values than there are elements), growing does not help,
+/// so while the tables are less than MaxLoadFactor full, the last
+/// displaced value goes into a small linear "stash" instead.
+///
+/// The class works only with non-negative integers (-1 marks an empty position).
+///
+class CuckooHash : public Hash
+{
+private:
+    static constexpr int Empty = -1;
+    static constexpr size_t MaxDisplacements = 32;
+    static constexpr double MaxLoadFactor = 0.45;
+
+    size_t tableSize; // Size of each of the two tables, a power of two
+    int tableBits;
+    size_t elementsCount;
+    int* pTables[2];
+    std::vector<int, CountingAllocator<int>> stash;
+    ProbeStatistics probeStatistics;
+
+    size_t PositionIn(int Table, int Value) const;
+
+    /// Looks up a value and adds the number of examined positions to Probes
+    int* Find(int Value, size_t& Probes);
+
+    ///
+    /// Places a value, which is not in the hash, displacing others if needed
+    ///
+    /// Returns the number of positions examined along the displacement
+    /// chain, including those of a rehash, which the placement triggers.
+    ///
+    size_t Place(int Value);
+
+    /// Doubles the tables and places all elements again. Returns the number of probes.
+    size_t Grow();
+
+public:
+    CuckooHash(HashingFunction* pHashingFunction, size_t MaxSize = 8);
+    ~CuckooHash() override;
+
+    CuckooHash(const CuckooHash&) = delete;
+    CuckooHash& operator=(const CuckooHash&) = delete;
+
+    bool Add(const int Value) override;
+    bool Search(const int Value) override;
+    bool Remove(const int Value);
+    void PrintInfo() const override;
+
+    size_t GetElementsCount() const;
+    size_t GetStashSize() const;
+
+    const ProbeStatistics& GetProbeStatistics() const;
+    void ResetProbeStatistics();
+};
@@ -9,8 +9,14 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
 
+#include "../HashFunctions.h"
+#include "utils/CountingAllocator.h"
+
 ///
 ///	Represents a hashing function
 ///	
@@ -73,14 +79,130 @@ public:
 };
 
 
+///
+/// A multiplicative (Fibonacci) hashing function
+///
+/// Spreads sequential and strided values evenly over [0, Range),
+/// unlike ModularHashingFunction, which keeps their patterns.
+/// See FibonacciHash in HashFunctions.h.
+///
+class FibonacciHashingFunction : public HashingFunction
+{
+private:
+	uint64_t Range;
+
+public:
+	FibonacciHashingFunction(int Range)
+		: Range(Range)
+	{
+		// Nothing to do here
+	}
+
+	int CalculateHash(int Value) override
+	{
+		return (int)reduceToRange(static_cast<uint64_t>(Value) * FibonacciMultiplier, Range);
+	}
+};
+
+
+///
+/// A seeded hashing function, which returns values in [0, Range)
+///
+/// Different seeds give unrelated functions, so the values which
+/// collide cannot be predicted without knowing the seed.
+/// See SeededHash in HashFunctions.h.
+///
+class SeededHashingFunction : public HashingFunction
+{
+private:
+	uint64_t Range;
+	SeededHash Hasher;
+
+public:
+	SeededHashingFunction(int Range, uint64_t Seed = processHashSeed())
+		: Range(Range), Hasher(Seed)
+	{
+		// Nothing to do here
+	}
+
+	int CalculateHash(int Value) override
+	{
+		return (int)reduceToRange(Hasher(Value), Range);
+	}
+};
+
+
+///
+/// A multiplicative (Fibonacci) hash of an int, which returns its highest Bits bits
+///
+/// It does not depend on the HashingFunction used by a hash, so the
+/// hashes, which need two independent hash values (double hashing,
+/// cuckoo hashing), use it as their second hashing function.
+/// Bits must be in [1, 32].
+///
+inline size_t SecondaryHash(int Value, int Bits)
+{
+	uint32_t product = static_cast<uint32_t>(Value) * 2654435769u; // 2^32 / golden ratio
+	return product >> (32 - Bits);
+}
+
+
+///
+/// Counts how many positions the operations of a hash examine
+///
+/// A probe is one comparison of a stored element (or an empty position)
+/// with the searched value. The ideal is 1 probe per operation.
+///
+struct ProbeStatistics
+{
+	size_t operations = 0;
+	size_t probes = 0;
+	size_t maxProbes = 0;
+
+	void Record(size_t Probes)
+	{
+		operations++;
+		probes += Probes;
+		maxProbes = std::max(maxProbes, Probes);
+	}
+
+	double Average() const
+	{
+		return operations ? (double)probes / operations : 0;
+	}
+
+	void Reset()
+	{
+		*this = ProbeStatistics();
+	}
+};
+
+
 ///
 ///	Parent class for all hashes
 ///
+///
+/// All memory of a hash (nodes, chains, buffers) should be obtained from
+/// its allocator, so that the memory reported by PrintInfo is exactly
+/// what was requested, on any compiler and standard library.
+///
 class Hash
 {
 protected:
 	HashingFunction * pHashingFunction;
 
+	/// Counts the memory allocated by the hash. Rebind it to allocate other types.
+	CountingAllocator<int> allocator;
+
+	///
+	/// Returns the memory used by the hash: the size of the object plus
+	/// everything it has allocated through its allocator and still holds
+	///
+	size_t MemoryUsed(size_t ObjectSize) const
+	{
+		return ObjectSize + allocator.counter().liveBytes;
+	}
+
 public:
 	Hash(HashingFunction* pHashingFunction = nullptr)
         : pHashingFunction(pHashingFunction)
@@ -96,8 +218,14 @@ public:
 
 	virtual void PrintInfo() const = 0;
 
-	void PrintCommonInfo(size_t ElementsCount, size_t MemoryUsed) const
+	static void PrintCommonInfo(size_t ElementsCount, size_t MemoryUsed)
 	{
+		if (ElementsCount == 0 || MemoryUsed == 0)
+		{
+			std::cout << "\n   - Stored elements: 0" << std::endl << std::endl;
+			return;
+		}
+
 		size_t elementsSize = ElementsCount * sizeof(int);
 
 		size_t data = (elementsSize * 100) / MemoryUsed;
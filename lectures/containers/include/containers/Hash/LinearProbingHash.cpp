@@ -14,7 +14,7 @@
 LinearProbingHash::LinearProbingHash(HashingFunction* pHashingFunction, size_t MaxSize)
     : Hash(pHashingFunction), elementsCount(0), bufferSize(MaxSize*2)
 {
-	pBuffer = new int[bufferSize];
+	pBuffer = allocator.allocate(bufferSize);
 
 	// Mark all positions as empty
 	for(size_t i = 0; i < bufferSize; i++)
@@ -24,7 +24,7 @@ LinearProbingHash::LinearProbingHash(HashingFunction* pHashingFunction, size_t M
 
 LinearProbingHash::~LinearProbingHash()
 {
-	delete [] pBuffer;
+	allocator.deallocate(pBuffer, bufferSize);
 }
 
 
@@ -34,10 +34,15 @@ bool LinearProbingHash::Add(const int Value)
 		return false;
 
 	int i = pHashingFunction->CalculateHash(Value);
+	size_t probes = 1;
 
 	while(pBuffer[i] >= 0)
+	{
 		i = (i+1) % bufferSize;
+		probes++;
+	}
 
+	probeStatistics.Record(probes);
 	pBuffer[i] = Value;
 
 	elementsCount++;
@@ -48,15 +53,23 @@ bool LinearProbingHash::Add(const int Value)
 bool LinearProbingHash::Search(const int Value)
 {
 	int i = pHashingFunction->CalculateHash(Value);
+	size_t probes = 1;
 
 	while(pBuffer[i] >= 0)
 	{
 		if(pBuffer[i] == Value)
+		{
+			probeStatistics.Record(probes);
 			return true;
+		}
 		else
+		{
 			i = (i+1) % bufferSize;
+			probes++;
+		}
 	}
 
+	probeStatistics.Record(probes);
 	return false;
 }
 
@@ -66,5 +79,15 @@ void LinearProbingHash::PrintInfo() const
 		<< "LinearProbingHash:"
 		<< "\n   - Used space: " << (((double)elementsCount * 100) / bufferSize) << "%";
 
-	PrintCommonInfo(elementsCount, bufferSize * sizeof(int) + sizeof(*this));
+	PrintCommonInfo(elementsCount, MemoryUsed(sizeof(*this)));
+}
+
+const ProbeStatistics& LinearProbingHash::GetProbeStatistics() const
+{
+	return probeStatistics;
+}
+
+void LinearProbingHash::ResetProbeStatistics()
+{
+	probeStatistics.Reset();
 }
\ No newline at end of file
@@ -14,11 +14,17 @@
 ///
 /// An implementation of a linear probing hash
 ///
+/// The class works only with non-negative integers (-1 marks an empty
+/// position), cannot grow and does not support removing elements.
+/// For a generic, growable linear probing table with erase, check
+/// RobinHoodHash in containers/HashTable.h.
+///
 class LinearProbingHash : public Hash
 {
     size_t bufferSize;
 	size_t elementsCount;
 	int* pBuffer;
+	ProbeStatistics probeStatistics;
 
 public:
     LinearProbingHash(HashingFunction* pHashingFunction, size_t MaxSize);
@@ -27,4 +33,7 @@ public:
 	bool Add(const int Value) override;
 	bool Search(const int Value) override;
 	void PrintInfo() const override;
+
+	const ProbeStatistics& GetProbeStatistics() const;
+	void ResetProbeStatistics();
 };
\ No newline at end of file
@@ -19,7 +19,7 @@
 /// The element is placed at the end of the
 /// underlying STL collection by using push_back.
 ///
-template <class Container>
+template <template <class, class> class Container>
 bool NrhStl<Container>::Add(const int Value)
 {
     data.push_back(Value);
@@ -32,7 +32,7 @@ bool NrhStl<Container>::Add(const int Value)
 ///
 /// The function does this by an exhaustive search.
 ///
-template <class Container>
+template <template <class, class> class Container>
 bool NrhStl<Container>::Search(const int Value)
 {
     for (auto it = data.cbegin(); it != data.cend(); it++)
@@ -48,47 +48,16 @@ bool NrhStl<Container>::Search(const int Value)
 ///
 /// Print information
 ///
-template <class Container>
+/// The container allocates all its memory (list nodes or the vector's
+/// buffer) through the allocator of the hash, so there is no need to
+/// know the implementation of the container.
+///
+template <template <class, class> class Container>
 void NrhStl<Container>::PrintInfo() const
 {
     std::cout << "NrhStl:";
 
-    PrintCommonInfo(data.size(), memoryUsed);
-}
-
-
-///
-/// Specialization of the PrintInfo function for std::list<int>
-///
-template <>
-void NrhStl< std::list<int> >::PrintInfo() const
-{
-    // NOTE: Microsoft specific. Assumes we are storing int elements
-    // and using the default allocator.
-    static const size_t stlListNodeSize = sizeof(std::_List_node<int, void*>);
-
-    size_t memoryUsed =
-        sizeof(*this) +  // object size
-        data.size() * stlListNodeSize; // nodes allocated by the list
-
-    std::cout << "NrhStl<std::list<>>:";
-
-    PrintCommonInfo(data.size(), memoryUsed);
-}
-
-
-
-///
-/// Specialization of the PrintInfo function for std::vector<int>
-///
-template <>
-void NrhStl< std::vector<int> >::PrintInfo() const
-{
-    size_t memoryUsed = data.capacity() * sizeof(int);
-
-    std::cout << "NrhStl<std::vector<>>:";
-
-    PrintCommonInfo(data.size(), memoryUsed);
+    PrintCommonInfo(data.size(), MemoryUsed(sizeof(*this)));
 }
 
 
@@ -122,12 +91,10 @@ bool NrhVectorWithBinarySearch::Search(const int Value)
 ///
 void NrhVectorWithBinarySearch::PrintInfo() const
 {
-    size_t memoryUsed = data.capacity() * sizeof(int);
-
     std::cout << "NrhVectorWithBinarySearch:";
 
-    PrintCommonInfo(data.size(), memoryUsed);
+    PrintCommonInfo(data.size(), MemoryUsed(sizeof(*this)));
 }
 
-template class NrhStl< std::list<int> >;
-template class NrhStl< std::vector<int> >;
\ No newline at end of file
+template class NrhStl<std::list>;
+template class NrhStl<std::vector>;
\ No newline at end of file
@@ -24,13 +24,23 @@
 /// the performance of a hash algorithm, vs. other
 /// data structures.
 ///
-template <class Container>
+/// Container is a class template like std::list or std::vector.
+/// It is instantiated with the allocator of the hash, so that its
+/// memory is measured exactly.
+///
+template <template <class, class> class Container>
 class NrhStl : public Hash
 {
 private:
-	Container data;
+	Container<int, CountingAllocator<int>> data;
 
 public:
+	NrhStl()
+		: data(allocator)
+	{
+		// Nothing to do here
+	}
+
 	bool Add(const int Value) override;
 	bool Search(const int Value) override;
 	void PrintInfo() const override;
@@ -45,9 +55,15 @@ public:
 class NrhVectorWithBinarySearch : public Hash
 {
 private:
-    std::vector<int> data;
+    std::vector<int, CountingAllocator<int>> data;
 
 public:
+    NrhVectorWithBinarySearch()
+        : data(allocator)
+    {
+        // Nothing to do here
+    }
+
     bool Add(const int Value) override;
     bool Search(const int Value) override;
     void PrintInfo() const override;
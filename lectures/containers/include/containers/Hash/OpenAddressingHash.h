@@ -0,0 +1,343 @@
+/********************************************************************
+ *
+ * This file is part of the Data structures and algorithms in C++ package
+ *
+ * Author: Atanas Semerdzhiev
+ * URL: https://github.com/semerdzhiev/sdp-samples
+ *
+ */
+
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <iostream>
+#include <utility>
+
+#include "Hash.h"
+
+///
+/// Hashing and probing policies for OpenAddressingHash
+///
+/// Unlike HashingFunction, the policies below have no virtual functions.
+/// OpenAddressingHash receives them as template parameters, so the
+/// compiler knows the exact function at compile time and can inline it
+/// into the probing loop.
+///
+
+///
+/// Calculates the hash of V as V % Mod (the same as ModularHashingFunction)
+///
+class ModularHashingPolicy
+{
+private:
+	int Mod;
+
+public:
+	ModularHashingPolicy(int Mod)
+		: Mod(Mod)
+	{
+		// Nothing to do here
+	}
+
+	int CalculateHash(int Value) const
+	{
+		return Value % Mod;
+	}
+};
+
+
+///
+/// Calculates the hash of V as (V % Mod) * Multiplier (the same as ModAndMultiplyHashingFunction)
+///
+class ModAndMultiplyHashingPolicy
+{
+private:
+	int Mod;
+	int Multiplier;
+
+public:
+	ModAndMultiplyHashingPolicy(int Mod, int Multiplier)
+		: Mod(Mod), Multiplier(Multiplier)
+	{
+		// Nothing to do here
+	}
+
+	int CalculateHash(int Value) const
+	{
+		return (Value % Mod) * Multiplier;
+	}
+};
+
+
+///
+/// Forwards to a HashingFunction object through a virtual call
+///
+/// Allows OpenAddressingHash to use any of the existing hashing
+/// functions and to measure the cost of the virtual call alone.
+///
+class VirtualHashingPolicy
+{
+private:
+	HashingFunction* pHashingFunction;
+
+public:
+	VirtualHashingPolicy(HashingFunction* pHashingFunction)
+		: pHashingFunction(pHashingFunction)
+	{
+		// Nothing to do here
+	}
+
+	int CalculateHash(int Value) const
+	{
+		return pHashingFunction->CalculateHash(Value);
+	}
+};
+
+
+///
+/// Probing policies
+///
+/// A policy object is created for each operation from the value being
+/// looked up. Next() returns the position to examine after a collision
+/// at Position. Attempt is 1 for the first collision, 2 for the second
+/// and so on. The table size is a power of two and Mask = size - 1.
+///
+
+///
+/// Linear probing: checks the positions h, h+1, h+2, ...
+///
+/// Consecutive probes stay in the same cache line, which makes this
+/// the fastest strategy, as long as the hash does not form long clusters.
+///
+struct LinearProbingPolicy
+{
+	LinearProbingPolicy(int /* Value */)
+	{
+		// Nothing to do here
+	}
+
+	size_t Next(size_t Position, size_t /* Attempt */, size_t Mask) const
+	{
+		return (Position + 1) & Mask;
+	}
+};
+
+
+///
+/// Quadratic probing: checks the positions h, h+1, h+3, h+6, ...
+///
+/// The step grows by one after each probe (triangular numbers). When
+/// the table size is a power of two, this visits every position exactly
+/// once. It breaks up the clusters formed by similar hash values.
+///
+struct QuadraticProbingPolicy
+{
+	QuadraticProbingPolicy(int /* Value */)
+	{
+		// Nothing to do here
+	}
+
+	size_t Next(size_t Position, size_t Attempt, size_t Mask) const
+	{
+		return (Position + Attempt) & Mask;
+	}
+};
+
+
+///
+/// Double hashing: checks the positions h, h+s, h+2s, ...
+///
+/// The step s is calculated from the value by SecondaryHash. Values,
+/// which collide at their first position, usually have different steps,
+/// so they do not follow each other. The step is odd, so it visits every
+/// position of a power of two table.
+///
+class DoubleHashingPolicy
+{
+private:
+	size_t step;
+
+public:
+	DoubleHashingPolicy(int Value)
+		: step(SecondaryHash(Value, 31) | 1)
+	{
+		// Nothing to do here
+	}
+
+	size_t Next(size_t Position, size_t /* Attempt */, size_t Mask) const
+	{
+		return (Position + step) & Mask;
+	}
+};
+
+
+///
+/// An open addressing hash, in which the hashing function and the
+/// probing strategy are compile-time parameters
+///
+/// Like LinearProbingHash, the class works only with non-negative
+/// integers (-1 marks an empty position), cannot grow and does not
+/// support removing elements. The elements are stored in a single
+/// array, whose size is a power of two, so that wrapping around is
+/// a bit mask instead of a division.
+///
+/// The class does not derive from Hash and has no virtual functions.
+/// Use HashAdapter to pass it where a Hash is expected.
+///
+template <class HashingPolicy, class ProbingPolicy = LinearProbingPolicy>
+class OpenAddressingHash
+{
+private:
+	HashingPolicy hashing;
+	size_t bufferSize;
+	size_t mask;
+	size_t elementsCount;
+	int* pBuffer;
+	mutable ProbeStatistics probeStatistics;
+	CountingAllocator<int> allocator; // The class does not derive from Hash, so it has its own
+
+	size_t StartPosition(int Value) const
+	{
+		return static_cast<size_t>(hashing.CalculateHash(Value)) & mask;
+	}
+
+public:
+	///
+	/// Creates a hash, which can store at least MaxSize elements
+	///
+	/// As in LinearProbingHash, the buffer has (at least) twice as
+	/// many positions as elements, to keep the probe sequences short.
+	///
+	OpenAddressingHash(const HashingPolicy& Hashing, size_t MaxSize)
+		: hashing(Hashing),
+		  bufferSize(std::bit_ceil(MaxSize * 2)),
+		  mask(bufferSize - 1),
+		  elementsCount(0)
+	{
+		pBuffer = allocator.allocate(bufferSize);
+
+		// Mark all positions as empty
+		for (size_t i = 0; i < bufferSize; i++)
+			pBuffer[i] = -1;
+	}
+
+	OpenAddressingHash(const OpenAddressingHash&) = delete;
+	OpenAddressingHash& operator=(const OpenAddressingHash&) = delete;
+
+	~OpenAddressingHash()
+	{
+		allocator.deallocate(pBuffer, bufferSize);
+	}
+
+	bool Add(const int Value)
+	{
+		if (elementsCount >= bufferSize)
+			return false;
+
+		ProbingPolicy probing(Value);
+		size_t i = StartPosition(Value);
+		size_t attempt = 1;
+
+		for (; pBuffer[i] >= 0; attempt++)
+			i = probing.Next(i, attempt, mask);
+
+		probeStatistics.Record(attempt);
+		pBuffer[i] = Value;
+
+		elementsCount++;
+
+		return true;
+	}
+
+	bool Search(const int Value) const
+	{
+		ProbingPolicy probing(Value);
+		size_t i = StartPosition(Value);
+		size_t attempt = 1;
+
+		// Each position is visited at most once, so stop after bufferSize probes
+		for (; attempt <= bufferSize && pBuffer[i] >= 0; attempt++)
+		{
+			if (pBuffer[i] == Value)
+			{
+				probeStatistics.Record(attempt);
+				return true;
+			}
+
+			i = probing.Next(i, attempt, mask);
+		}
+
+		probeStatistics.Record(attempt);
+		return false;
+	}
+
+	const ProbeStatistics& GetProbeStatistics() const
+	{
+		return probeStatistics;
+	}
+
+	void ResetProbeStatistics()
+	{
+		probeStatistics.Reset();
+	}
+
+	void PrintInfo() const
+	{
+		std::cout
+			<< "OpenAddressingHash:"
+			<< "\n   - Used space: " << (((double)elementsCount * 100) / bufferSize) << "%";
+
+		Hash::PrintCommonInfo(elementsCount, sizeof(*this) + allocator.counter().liveBytes);
+	}
+};
+
+
+///
+/// Adapts a hash with statically dispatched Add/Search/PrintInfo to the Hash interface
+///
+/// The calls to the adapter are virtual, but inside the wrapped hash
+/// everything (including the hashing function) can be inlined. This
+/// allows HashBenchmark to compare the two approaches side by side.
+///
+template <class StaticHash>
+class HashAdapter : public Hash
+{
+private:
+	StaticHash hash;
+
+public:
+	template <class... Args>
+	HashAdapter(Args&&... args)
+		: hash(std::forward<Args>(args)...)
+	{
+		// Nothing to do here
+	}
+
+	bool Add(const int Value) override
+	{
+		return hash.Add(Value);
+	}
+
+	bool Search(const int Value) override
+	{
+		return hash.Search(Value);
+	}
+
+	void PrintInfo() const override
+	{
+		hash.PrintInfo();
+	}
+
+	const ProbeStatistics& GetProbeStatistics() const
+		requires requires(const StaticHash& h) { h.GetProbeStatistics(); }
+	{
+		return hash.GetProbeStatistics();
+	}
+
+	void ResetProbeStatistics()
+		requires requires(StaticHash& h) { h.ResetProbeStatistics(); }
+	{
+		hash.ResetProbeStatistics();
+	}
+};
@@ -0,0 +1,244 @@
+/********************************************************************
+ *
+ * This file is part of the Data structures and algorithms in C++ package
+ *
+ * Author: Atanas Semerdzhiev
+ * URL: https://github.com/semerdzhiev/sdp-samples
+ *
+ */
+
+#pragma once
+
+#include <bit>
+#include <iostream>
+
+#include "Hash.h"
+#include "OpenAddressingHash.h"
+
+///
+/// An open addressing hash, which can grow and remove elements
+///
+/// The probing strategy is one of the policies from OpenAddressingHash.h.
+/// Use the QuadraticProbingHash and DoubleHashingHash aliases below.
+///
+/// The class works only with non-negative integers. Empty positions
+/// are marked with -1. A removed element cannot simply be replaced by
+/// -1, because this would break the probe sequences, which pass through
+/// it. Instead it is replaced by a tombstone (-2), which searches skip
+/// and insertions reuse.
+///
+/// The table is rebuilt when more than half of its positions are
+/// occupied by elements or tombstones. Its size is always a power of
+/// two. The hashing function is reduced to the table size by taking
+/// its lowest bits.
+///
+template <class ProbingPolicy>
+class ProbingHash : public Hash
+{
+private:
+	static constexpr int Empty = -1;
+	static constexpr int Tombstone = -2;
+
+	size_t bufferSize;
+	size_t elementsCount;
+	size_t tombstonesCount;
+	int* pBuffer;
+	ProbeStatistics probeStatistics;
+
+	size_t StartPosition(int Value) const
+	{
+		return static_cast<size_t>(pHashingFunction->CalculateHash(Value)) & (bufferSize - 1);
+	}
+
+	///
+	/// Finds the position of a value, or nullptr if it is not in the hash
+	///
+	/// If pInsertAt is not nullptr, it receives the position where the
+	/// value should be inserted: the first tombstone or empty position
+	/// on the probe sequence.
+	///
+	int* Find(int Value, int** pInsertAt)
+	{
+		ProbingPolicy probing(Value);
+		size_t mask = bufferSize - 1;
+		size_t i = StartPosition(Value);
+		size_t attempt = 1;
+		int* pFirstFree = nullptr;
+		int* pResult = nullptr;
+
+		// The table always has empty positions, so the loop ends
+		for (; pBuffer[i] != Empty; attempt++)
+		{
+			if (pBuffer[i] == Value)
+			{
+				pResult = &pBuffer[i];
+				break;
+			}
+
+			if (pBuffer[i] == Tombstone && !pFirstFree)
+				pFirstFree = &pBuffer[i];
+
+			i = probing.Next(i, attempt, mask);
+		}
+
+		probeStatistics.Record(attempt);
+
+		if (pInsertAt)
+			*pInsertAt = pFirstFree ? pFirstFree : &pBuffer[i];
+
+		return pResult;
+	}
+
+	/// Rebuilds the table with a new size. All tombstones are discarded.
+	void Rehash(size_t NewSize)
+	{
+		int* pOld = pBuffer;
+		size_t oldSize = bufferSize;
+
+		pBuffer = allocator.allocate(NewSize);
+		bufferSize = NewSize;
+		tombstonesCount = 0;
+
+		for (size_t i = 0; i < bufferSize; i++)
+			pBuffer[i] = Empty;
+
+		size_t mask = bufferSize - 1;
+
+		for (size_t j = 0; j < oldSize; j++)
+		{
+			if (pOld[j] < 0)
+				continue;
+
+			ProbingPolicy probing(pOld[j]);
+			size_t i = StartPosition(pOld[j]);
+
+			for (size_t attempt = 1; pBuffer[i] != Empty; attempt++)
+				i = probing.Next(i, attempt, mask);
+
+			pBuffer[i] = pOld[j];
+		}
+
+		allocator.deallocate(pOld, oldSize);
+	}
+
+public:
+	///
+	/// Creates an empty hash, ready to store MaxSize elements without growing
+	///
+	ProbingHash(HashingFunction* pHashingFunction, size_t MaxSize = 8)
+		: Hash(pHashingFunction),
+		  bufferSize(std::bit_ceil(std::max<size_t>(MaxSize, 4) * 2)),
+		  elementsCount(0),
+		  tombstonesCount(0)
+	{
+		pBuffer = allocator.allocate(bufferSize);
+
+		for (size_t i = 0; i < bufferSize; i++)
+			pBuffer[i] = Empty;
+	}
+
+	ProbingHash(const ProbingHash&) = delete;
+	ProbingHash& operator=(const ProbingHash&) = delete;
+
+	~ProbingHash() override
+	{
+		allocator.deallocate(pBuffer, bufferSize);
+	}
+
+	///
+	/// Adds a value to the hash
+	///
+	/// \return
+	///    false if the value is negative or is already in the hash
+	///
+	bool Add(const int Value) override
+	{
+		if (Value < 0)
+			return false;
+
+		int* pInsertAt = nullptr;
+
+		if (Find(Value, &pInsertAt))
+			return false;
+
+		if (*pInsertAt == Tombstone)
+			tombstonesCount--;
+
+		*pInsertAt = Value;
+		elementsCount++;
+
+		// Keep at least half of the positions empty. If most of the
+		// occupied ones are tombstones, rebuilding at the same size is enough.
+		if ((elementsCount + tombstonesCount) * 2 > bufferSize)
+			Rehash(elementsCount * 4 > bufferSize ? bufferSize * 2 : bufferSize);
+
+		return true;
+	}
+
+	bool Search(const int Value) override
+	{
+		return Value >= 0 && Find(Value, nullptr) != nullptr;
+	}
+
+	///
+	/// Removes a value from the hash
+	///
+	/// \return
+	///    true if the value was found and removed
+	///
+	bool Remove(const int Value)
+	{
+		int* p = Value >= 0 ? Find(Value, nullptr) : nullptr;
+
+		if (!p)
+			return false;
+
+		*p = Tombstone;
+		elementsCount--;
+		tombstonesCount++;
+
+		return true;
+	}
+
+	size_t GetElementsCount() const
+	{
+		return elementsCount;
+	}
+
+	size_t GetBufferSize() const
+	{
+		return bufferSize;
+	}
+
+	const ProbeStatistics& GetProbeStatistics() const
+	{
+		return probeStatistics;
+	}
+
+	void ResetProbeStatistics()
+	{
+		probeStatistics.Reset();
+	}
+
+	void PrintInfo() const override
+	{
+		std::cout
+			<< "ProbingHash:"
+			<< "\n   - Used space: " << (((double)elementsCount * 100) / bufferSize) << "%"
+			<< "\n   - Tombstones: " << tombstonesCount;
+
+		PrintCommonInfo(elementsCount, MemoryUsed(sizeof(*this)));
+	}
+};
+
+
+///
+/// A growable open addressing hash with quadratic probing
+///
+using QuadraticProbingHash = ProbingHash<QuadraticProbingPolicy>;
+
+
+///
+/// A growable open addressing hash with double hashing
+///
+using DoubleHashingHash = ProbingHash<DoubleHashingPolicy>;
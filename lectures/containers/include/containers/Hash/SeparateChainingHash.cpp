@@ -9,25 +9,38 @@
 
 #include <iostream>
 #include <algorithm>
+#include <new>
 
 #include "SeparateChainingHash.h"
 
 SeparateChainingHashStl::SeparateChainingHashStl(HashingFunction* pHashingFunction, size_t ChainsCount)
-    : Hash(pHashingFunction), chainsCount(ChainsCount)
+    : Hash(pHashingFunction), chains(ChainsCount, Chain(allocator), allocator)
 {
-	pChains = new std::list<int>[chainsCount];
+	// Nothing to do here
 }
 
-SeparateChainingHashStl::~SeparateChainingHashStl()
+///
+/// Measures the memory, which a std::list allocates for one more element
+///
+/// The size of the node type is implementation specific (and some
+/// implementations also allocate a sentinel node for each list),
+/// so it is measured instead of computed.
+///
+size_t SeparateChainingHashStl::ListNodeSize()
 {
-	delete [] pChains;
+	Chain list;
+	size_t before = list.get_allocator().counter().liveBytes;
+
+	list.push_back(0);
+
+	return list.get_allocator().counter().liveBytes - before;
 }
 
 bool SeparateChainingHashStl::Add(const int Value)
 {
 	int hash = pHashingFunction->CalculateHash(Value);
 
-	pChains[hash].push_back(Value);
+	chains[hash].push_back(Value);
 
 	return true;
 }
@@ -36,7 +49,7 @@ bool SeparateChainingHashStl::Search(const int Value)
 {
 	int hash = pHashingFunction->CalculateHash(Value);
 
-	for(auto it = pChains[hash].cbegin(); it != pChains[hash].cend(); ++it)
+	for(auto it = chains[hash].cbegin(); it != chains[hash].cend(); ++it)
 	{
 		if( *it == Value )
 			return true;
@@ -47,37 +60,27 @@ bool SeparateChainingHashStl::Search(const int Value)
 
 void SeparateChainingHashStl::PrintInfo() const
 {
-	size_t maxChainSize = pChains[0].size();
-	size_t sumOfSizes = pChains[0].size();
-	size_t minChainSize = pChains[0].size();
+	size_t maxChainSize = chains[0].size();
+	size_t sumOfSizes = chains[0].size();
+	size_t minChainSize = chains[0].size();
 
-	for(size_t i = 1; i < chainsCount; i++)
+	for(size_t i = 1; i < chains.size(); i++)
 	{
-		size_t size = pChains[i].size();
+		size_t size = chains[i].size();
 
 		sumOfSizes += size;
 		maxChainSize = std::max(maxChainSize, size);
 		minChainSize = std::min(minChainSize, size);
 	}
 
-	// NOTE: Microsoft specific. Assumes we are storing int elements
-	// and  using the default allocator.
-	static const size_t stlListNodeSize = sizeof(std::_List_node<int, void*>);
-	
-	size_t memoryUsed =
-		sizeof(*this) +  // object size
-		sizeof(std::list<int>) * chainsCount + // vector of lists
-		sumOfSizes * stlListNodeSize; // Nodes allocated by the lists
-
-	size_t dataSize = sumOfSizes * sizeof(int);
-	size_t overhead = ((memoryUsed - dataSize) * 100) / memoryUsed;
+	size_t memoryUsed = MemoryUsed(sizeof(*this));
 
 	std::cout
 		<< "SeparateChainingHashStl stats:"
 		<< "\n   - Max chain size: " << maxChainSize
-		<< "\n   - Avg chain size: " << (sumOfSizes / chainsCount)
+		<< "\n   - Avg chain size: " << (sumOfSizes / chains.size())
 		<< "\n   - Min chain size: " << minChainSize
-		<< "\n   - std::list node size: " << stlListNodeSize;
+		<< "\n   - std::list node size: " << ListNodeSize();
 
 	PrintCommonInfo(sumOfSizes, memoryUsed);
 }
@@ -85,9 +88,9 @@ void SeparateChainingHashStl::PrintInfo() const
 
 
 SeparateChainingHash::SeparateChainingHash(HashingFunction* pHashingFunction, size_t ChainsCount)
-    : Hash(pHashingFunction), chainsCount(ChainsCount)
+    : Hash(pHashingFunction), chainsCount(ChainsCount), boxAllocator(allocator)
 {
-    pChains = new Box*[chainsCount];
+    pChains = CountingAllocator<Box*>(allocator).allocate(chainsCount);
     
     for (size_t i = 0; i < chainsCount; i++)
         pChains[i] = nullptr;
@@ -103,11 +106,11 @@ SeparateChainingHash::~SeparateChainingHash()
         {
             p = pChains[i];
             pChains[i] = pChains[i]->pNext;
-            delete p;
+            boxAllocator.deallocate(p, 1);
         }
     }
 
-    delete[] pChains;
+    CountingAllocator<Box*>(allocator).deallocate(pChains, chainsCount);
 }
 
 bool SeparateChainingHash::Add(const int Value)
@@ -116,7 +119,8 @@ bool SeparateChainingHash::Add(const int Value)
 
     try
     {
-        pChains[hash] = new Box(Value, pChains[hash]);
+        // Box is trivially destructible, so the destructor only releases the memory
+        pChains[hash] = new (boxAllocator.allocate(1)) Box(Value, pChains[hash]);
     }
     catch (...)
     {
@@ -158,16 +162,10 @@ void SeparateChainingHash::PrintInfo() const
         minChainSize = std::min(minChainSize, size);
     }
 
-    size_t memoryUsed =
-        sizeof(*this) +  // object size
-        sizeof(Box*) * chainsCount + // vector of lists
-        sumOfSizes * sizeof(Box); // Nodes allocated for the lists
-
-    size_t dataSize = sumOfSizes * sizeof(int);
-    size_t overhead = ((memoryUsed - dataSize) * 100) / memoryUsed;
+    size_t memoryUsed = MemoryUsed(sizeof(*this)); // The array of chains and the boxes
 
     std::cout
-        << "SeparateChainingHashStl stats:"
+        << "SeparateChainingHash stats:"
         << "\n   - Max chain size: " << maxChainSize
         << "\n   - Avg chain size: " << (sumOfSizes / chainsCount)
         << "\n   - Min chain size: " << minChainSize
@@ -10,6 +10,7 @@
 #pragma once
 
 #include <list>
+#include <vector>
 
 #include "Hash.h"
 
@@ -20,16 +21,19 @@
 class SeparateChainingHashStl : public Hash
 {
 private:
-	size_t chainsCount;
-	std::list<int> * pChains;
+	using Chain = std::list<int, CountingAllocator<int>>;
+
+	// The vector and the lists allocate their memory from the allocator of the hash
+	std::vector<Chain, CountingAllocator<Chain>> chains;
 
 public:
 	SeparateChainingHashStl(HashingFunction* pHashingFunction, size_t ChainsCount);
-	virtual ~SeparateChainingHashStl();
 
 	bool Add(const int Value) override;
 	bool Search(const int Value) override;
 	void PrintInfo() const override;
+
+	static size_t ListNodeSize();
 };
 
 
@@ -53,6 +57,9 @@ private:
     size_t chainsCount;
     Box ** pChains;
 
+    // Boxes and the array of chains are allocated by the allocator of the hash
+    CountingAllocator<Box> boxAllocator;
+
 public:
     SeparateChainingHash(HashingFunction* pHashingFunction, size_t ChainsCount);
     ~SeparateChainingHash() override;
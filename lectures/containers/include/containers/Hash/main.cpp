@@ -13,6 +13,9 @@
 #include "NotReallyHash.h"
 #include "SeparateChainingHash.h"
 #include "LinearProbingHash.h"
+#include "OpenAddressingHash.h"
+#include "ProbingHash.h"
+#include "CuckooHash.h"
 
 
 class HashBenchmark
@@ -24,13 +27,17 @@ class HashBenchmark
     ///
     /// Sequentially fill a pHash with all integers in [0, elementsToFill]
     ///
+    /// HashType is either Hash (all calls are virtual) or a class with
+    /// the same interface, like OpenAddressingHash (all calls are static).
+    ///
     /// pszName is a string, which will be used as the name of the hash,
     /// when printing information to STDOUT.
     ///
     /// \return
     ///    Amount of time in seconds, it took to fill the hash
     ///
-    time_t Fill(Hash& hash, const char* pszName) const
+    template <class HashType>
+    time_t Fill(HashType& hash, const char* pszName) const
     {
         time_t start = time(nullptr);
 
@@ -55,7 +62,8 @@ class HashBenchmark
     /// pszName is a string, which will be used as the name of the hash,
     /// when printing information to STDOUT.
     ///
-    time_t Lookup(Hash& hash, const char* pszName) const
+    template <class HashType>
+    time_t Lookup(HashType& hash, const char* pszName) const
     {
         int hitCount = 0;
 
@@ -84,12 +92,50 @@ public:
         // Nothing to do here
     }
 
-    void Process(Hash& hash, const char* name)
+    ///
+    /// Prints the average and maximum number of probes per operation
+    ///
+    static void PrintProbes(const char* operation, const ProbeStatistics& stats)
     {
+        std::cout << "\n   - " << operation << " probes: avg " << stats.Average() << ", max " << stats.maxProbes;
+    }
+
+    ///
+    /// Fills the hash and then looks up values in it
+    ///
+    /// For hashes which count their probes (see ProbeStatistics),
+    /// the probe lengths of the insertions and of the lookups are
+    /// printed separately. Finally the hash prints its own information,
+    /// including the memory it uses.
+    ///
+    template <class HashType>
+    void Process(HashType&& hash, const char* name)
+    {
+        constexpr bool countsProbes = requires { hash.GetProbeStatistics(); hash.ResetProbeStatistics(); };
+
         time_t f = Fill(hash, name);
+        ProbeStatistics fillProbes;
+
+        if constexpr (countsProbes)
+        {
+            fillProbes = hash.GetProbeStatistics();
+            hash.ResetProbeStatistics();
+        }
+
         time_t l = Lookup(hash, name);
-        
-        std::cout << name << " (" << f << "/" << l << ")\n\n";
+
+        std::cout << name << " (" << f << "/" << l << ")";
+
+        if constexpr (countsProbes)
+        {
+            PrintProbes("Insert", fillProbes);
+            PrintProbes("Lookup", hash.GetProbeStatistics());
+        }
+
+        std::cout << "\n";
+
+        // Structure and memory usage, as measured by the allocator of the hash
+        hash.PrintInfo();
     }
 
     void PrintInfo() const
@@ -98,6 +144,8 @@ public:
         std::cout << "\n   Each hash will be filled with the integers in [0, " << elementsToFill << "]";
         std::cout << "\n   Searching will perform " << elementsToLookup << " lookups";
         std::cout << "\n   Data is printed in the following format: hash name (fill time/lookup time)";
+        std::cout << "\n   Open addressing hashes also print their average and maximum probe lengths";
+        std::cout << "\n   The memory used by each hash is measured by counting its allocations";
         std::cout << "\n\n";
     }
 };
@@ -127,8 +175,8 @@ int main()
     ModAndMultiplyHashingFunction spreadLow(low, (elementsToFill * 2 ) / low);
     ModAndMultiplyHashingFunction spreadHigh(high, (elementsToFill * 2) / high);
 
-    test.Process(NrhStl<std::list<int>>(), "NrhStl<std::list>");
-    test.Process(NrhStl<std::vector<int>>(), "NrhStl<std::vector>");
+    test.Process(NrhStl<std::list>(), "NrhStl<std::list>");
+    test.Process(NrhStl<std::vector>(), "NrhStl<std::vector>");
     test.Process(NrhVectorWithBinarySearch(), "NrhVectorWithBinarySearch");
     
     test.Process(SeparateChainingHashStl(&modLow, low),    "SeparateChainingHashStl w/ modLow");
@@ -141,5 +189,42 @@ int main()
     test.Process(LinearProbingHash(&spreadLow, elementsToFill), "LinearProbingHash /w spreadLow");
     test.Process(LinearProbingHash(&spreadHigh, elementsToFill), "LinearProbingHash /w spreadHigh");
 
+    // Functions from HashFunctions.h, which spread the values over the whole table
+    FibonacciHashingFunction fibonacci(elementsToFill * 2);
+    SeededHashingFunction seeded(elementsToFill * 2);
+
+    test.Process(LinearProbingHash(&fibonacci, elementsToFill), "LinearProbingHash /w fibonacci");
+    test.Process(LinearProbingHash(&seeded, elementsToFill), "LinearProbingHash /w seeded");
+
+    // The same hashing functions, dispatched statically.
+    // HashAdapter goes through the virtual Add/Search of Hash, but inlines the hashing function.
+    using StaticLinear = OpenAddressingHash<ModAndMultiplyHashingPolicy>;
+    using StaticQuadratic = OpenAddressingHash<ModAndMultiplyHashingPolicy, QuadraticProbingPolicy>;
+
+    ModAndMultiplyHashingPolicy staticSpreadLow(low, (elementsToFill * 2) / low);
+    ModAndMultiplyHashingPolicy staticSpreadHigh(high, (elementsToFill * 2) / high);
+
+    test.Process(OpenAddressingHash<VirtualHashingPolicy>(&spreadHigh, elementsToFill), "OpenAddressingHash<VirtualHashingPolicy> /w spreadHigh");
+    test.Process(HashAdapter<StaticLinear>(staticSpreadHigh, elementsToFill), "HashAdapter<OpenAddressingHash> /w spreadHigh");
+    test.Process(StaticLinear(staticSpreadLow, elementsToFill), "OpenAddressingHash /w spreadLow");
+    test.Process(StaticLinear(staticSpreadHigh, elementsToFill), "OpenAddressingHash /w spreadHigh");
+    test.Process(StaticQuadratic(staticSpreadLow, elementsToFill), "OpenAddressingHash<QuadraticProbingPolicy> /w spreadLow");
+    test.Process(StaticQuadratic(staticSpreadHigh, elementsToFill), "OpenAddressingHash<QuadraticProbingPolicy> /w spreadHigh");
+
+    // Growable hashes with erase. They start small, so the time includes growing.
+    // modFull gives a distinct hash to each value and is the reference for the probe lengths.
+    ModularHashingFunction modFull(elementsToFill * 2);
+
+    test.Process(QuadraticProbingHash(&modLow), "QuadraticProbingHash /w modLow");
+    test.Process(QuadraticProbingHash(&modHigh), "QuadraticProbingHash /w modHigh");
+    test.Process(QuadraticProbingHash(&modFull), "QuadraticProbingHash /w modFull");
+    test.Process(DoubleHashingHash(&modLow), "DoubleHashingHash /w modLow");
+    test.Process(DoubleHashingHash(&modHigh), "DoubleHashingHash /w modHigh");
+    test.Process(DoubleHashingHash(&modFull), "DoubleHashingHash /w modFull");
+
+    // Cuckoo hashing needs a good first hashing function. With a poor one
+    // many values end up in the stash, which is searched linearly.
+    test.Process(CuckooHash(&modFull), "CuckooHash /w modFull");
+
 	return 0;
 }
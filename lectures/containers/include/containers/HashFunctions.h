@@ -0,0 +1,269 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <string_view>
+#include <type_traits>
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+///
+/// Hash functions for the hash tables in HashTable.h and Hash/
+///
+/// The functors below can be used as the Hash template parameter of the
+/// hash tables, e.g. SeparateChainingHash<int, FibonacciHash>. Unlike
+/// std::hash<int>, which is the identity in libstdc++ and MSVC, they
+/// spread sequential and strided keys over all bits of the result,
+/// including the lowest ones, which the tables use to select a bucket.
+///
+/// The byte string hash is modelled after wyhash (https://github.com/wangyi-fudan/wyhash).
+/// It reads the input in 8-byte words with unaligned loads and assumes a
+/// little-endian machine, so the values differ between architectures.
+///
+
+///
+/// Multiplies two 64-bit numbers and returns the 128-bit result as two halves
+///
+inline void multiply128(uint64_t a, uint64_t b, uint64_t& low, uint64_t& high) noexcept
+{
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+    low = static_cast<uint64_t>(product);
+    high = static_cast<uint64_t>(product >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    low = _umul128(a, b, &high);
+#else
+    // Schoolbook multiplication of the 32-bit halves
+    uint64_t aLow = a & 0xFFFFFFFF, aHigh = a >> 32;
+    uint64_t bLow = b & 0xFFFFFFFF, bHigh = b >> 32;
+
+    uint64_t lowLow = aLow * bLow;
+    uint64_t highLow = aHigh * bLow;
+    uint64_t lowHigh = aLow * bHigh;
+    uint64_t highHigh = aHigh * bHigh;
+
+    uint64_t middle = (lowLow >> 32) + (highLow & 0xFFFFFFFF) + lowHigh;
+
+    low = (middle << 32) | (lowLow & 0xFFFFFFFF);
+    high = highHigh + (highLow >> 32) + (middle >> 32);
+#endif
+}
+
+///
+/// Multiplies two numbers and folds the 128-bit product to 64 bits
+///
+/// Every bit of the result depends on every bit of both arguments.
+///
+inline uint64_t foldedMultiply(uint64_t a, uint64_t b) noexcept
+{
+    uint64_t low, high;
+    multiply128(a, b, low, high);
+    return low ^ high;
+}
+
+/// Maps a 64-bit hash to [0, range) by multiplication instead of division (Lemire's reduction)
+inline uint64_t reduceToRange(uint64_t hash, uint64_t range) noexcept
+{
+    uint64_t low, high;
+    multiply128(hash, range, low, high);
+    return high;
+}
+
+/// 2^64 divided by the golden ratio
+inline constexpr uint64_t FibonacciMultiplier = 0x9E3779B97F4A7C15ULL;
+
+namespace hash_detail {
+
+inline constexpr uint64_t Secret[4] = {
+    0xa0761d6478bd642fULL, 0xe7037ed1a0b428dbULL, 0x8ebc6af09c88c6e3ULL, 0x589965cc75374cc3ULL
+};
+
+inline uint64_t read64(const unsigned char* p) noexcept
+{
+    uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+inline uint64_t read32(const unsigned char* p) noexcept
+{
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+/// Reads 1 to 3 bytes
+inline uint64_t readSmall(const unsigned char* p, size_t length) noexcept
+{
+    return (uint64_t(p[0]) << 16) | (uint64_t(p[length >> 1]) << 8) | p[length - 1];
+}
+
+} // namespace hash_detail
+
+///
+/// Hashes a sequence of bytes
+///
+/// Strings of up to 16 bytes are hashed with two loads and two
+/// multiplications. Longer ones are processed in 48-byte blocks with
+/// three independent multiplication chains, which the CPU can run in
+/// parallel. Different seeds give unrelated hash functions.
+///
+inline uint64_t hashBytes(const void* data, size_t length, uint64_t seed = 0) noexcept
+{
+    using namespace hash_detail;
+
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    seed ^= foldedMultiply(seed ^ Secret[0], Secret[1]);
+
+    uint64_t a, b;
+
+    if(length <= 16) {
+        if(length >= 4) {
+            // Two overlapping reads cover all bytes of the string
+            size_t offset = (length >> 3) << 2;
+            a = (read32(p) << 32) | read32(p + offset);
+            b = (read32(p + length - 4) << 32) | read32(p + length - 4 - offset);
+        }
+        else if(length > 0) {
+            a = readSmall(p, length);
+            b = 0;
+        }
+        else {
+            a = b = 0;
+        }
+    }
+    else {
+        size_t remaining = length;
+
+        if(remaining > 48) {
+            uint64_t seed1 = seed, seed2 = seed;
+
+            do {
+                seed = foldedMultiply(read64(p) ^ Secret[1], read64(p + 8) ^ seed);
+                seed1 = foldedMultiply(read64(p + 16) ^ Secret[2], read64(p + 24) ^ seed1);
+                seed2 = foldedMultiply(read64(p + 32) ^ Secret[3], read64(p + 40) ^ seed2);
+                p += 48;
+                remaining -= 48;
+            } while(remaining > 48);
+
+            seed ^= seed1 ^ seed2;
+        }
+
+        while(remaining > 16) {
+            seed = foldedMultiply(read64(p) ^ Secret[1], read64(p + 8) ^ seed);
+            p += 16;
+            remaining -= 16;
+        }
+
+        // The last 16 bytes (possibly overlapping with the previous block)
+        a = read64(p + remaining - 16);
+        b = read64(p + remaining - 8);
+    }
+
+    uint64_t low, high;
+    multiply128(a ^ Secret[1], b ^ seed, low, high);
+
+    return foldedMultiply(low ^ Secret[0] ^ length, high ^ Secret[1]);
+}
+
+///
+/// Multiply-shift (Fibonacci) hashing for integers
+///
+/// The key is multiplied by 2^64 / golden ratio. This spreads
+/// consecutive and strided keys evenly over the high bits of the
+/// product. They are folded into the low bits, which the hash tables
+/// use, so the result is good for any power of two bucket count.
+/// A single multiplication makes it the fastest function here, but it
+/// is easy to find keys which collide, so it should not be used with
+/// keys chosen by an adversary.
+///
+struct FibonacciHash {
+    template <typename T>
+        requires std::is_integral_v<T> || std::is_enum_v<T>
+    size_t operator()(T value) const noexcept
+    {
+        uint64_t product = static_cast<uint64_t>(value) * FibonacciMultiplier;
+        return static_cast<size_t>(product ^ (product >> 32));
+    }
+};
+
+///
+/// wyhash-style hashing of strings
+///
+/// The hasher is transparent, so a table of std::string can be
+/// searched with a std::string_view or a C string without a copy.
+///
+struct WyHash {
+    using is_transparent = void;
+
+    size_t operator()(std::string_view str) const noexcept
+    {
+        return static_cast<size_t>(hashBytes(str.data(), str.size()));
+    }
+};
+
+///
+/// Returns a random seed, chosen once per process
+///
+/// All default-constructed SeededHash objects share it, so that the
+/// hashers of tables, which pass hashes between each other (e.g. the
+/// shards of ShardedHashTable), agree on the values.
+///
+inline uint64_t processHashSeed()
+{
+    static const uint64_t seed = []() {
+        std::random_device device;
+        return (uint64_t(device()) << 32) ^ device();
+    }();
+
+    return seed;
+}
+
+///
+/// A keyed hash function for integers and strings
+///
+/// An attacker, who knows the hash function of a table, can send keys
+/// which all fall into the same bucket and make each operation linear.
+/// SeededHash mixes a secret random seed into each hash, so the colliding
+/// keys cannot be computed in advance. By default the seed is chosen
+/// at random once per process (see processHashSeed).
+///
+/// Note that this makes the iteration order of the tables differ
+/// between runs of the program.
+///
+class SeededHash {
+    uint64_t m_seed;
+
+public:
+    using is_transparent = void;
+
+    SeededHash()
+        : m_seed(processHashSeed())
+    {
+    }
+
+    explicit SeededHash(uint64_t seed)
+        : m_seed(seed)
+    {
+    }
+
+    uint64_t seed() const noexcept
+    {
+        return m_seed;
+    }
+
+    template <typename T>
+        requires std::is_integral_v<T> || std::is_enum_v<T>
+    size_t operator()(T value) const noexcept
+    {
+        return static_cast<size_t>(foldedMultiply(static_cast<uint64_t>(value) ^ m_seed, FibonacciMultiplier ^ hash_detail::Secret[0]));
+    }
+
+    size_t operator()(std::string_view str) const noexcept
+    {
+        return static_cast<size_t>(hashBytes(str.data(), str.size(), m_seed));
+    }
+};
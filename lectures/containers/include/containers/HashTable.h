@@ -1,11 +1,56 @@
 #pragma once
 
 #include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cmath>
+#include <cstdint>
 #include <functional>
+#include <iterator>
+#include <type_traits>
 #include <vector>
 #include <list>
+#include <memory>
+#include <span>
 #include <utility>
 #include <stdexcept>
+#include <string_view>
+
+// SSE2 is always available on x86-64. On other platforms
+// SwissTableHash falls back to a scalar implementation.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HASHTABLE_USE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+/// Hints the processor to start loading the cache line, which contains a given address
+inline void prefetchForRead(const void* address) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(address, 0, 3);
+#elif defined(HASHTABLE_USE_SSE2)
+    _mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0);
+#else
+    (void)address;
+#endif
+}
+
+///
+/// Number of keys, processed together by the bulk operations of the hash tables
+///
+/// All memory accesses for the keys in a batch are prefetched before
+/// any of them is resolved, so that the cache misses overlap.
+/// The batch should be large enough to hide the memory latency,
+/// but small enough for the prefetched lines to stay in L1.
+///
+inline constexpr size_t HashBatchSize = 16;
+
+/// Throws if the output of a bulk lookup cannot hold one result per key
+inline void checkBulkLookupSizes(size_t keysCount, size_t resultsCount)
+{
+    if(resultsCount < keysCount)
+        throw std::invalid_argument("the results span must be at least as large as the keys span");
+}
 
 // Included for comparison only
 template <typename ElementType>
@@ -69,17 +114,211 @@ public:
     }
 };
 
-template <typename ElementType, typename Hash = std::hash<ElementType> >
-class SeparateChainingHash {
+///
+/// Mixes the bits of a hash value
+///
+/// std::hash for integers is usually the identity function.
+/// The open addressing tables below derive the home slot (and
+/// other metadata) from different bits of the hash, so each bit
+/// of the result should depend on all bits of the input.
+///
+inline size_t mixHashBits(size_t hash) noexcept
+{
+    uint64_t h = static_cast<uint64_t>(hash);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return static_cast<size_t>(h);
+}
+
+///
+/// A hasher, which allows heterogeneous lookup
+///
+/// If a hash table uses a transparent hasher, its lookup functions
+/// accept any type K, which can be hashed by the hasher and compared
+/// with the keys using ==, without converting it to key_type first.
+///
+template <typename Hash>
+concept TransparentHash = requires { typename Hash::is_transparent; };
+
+/// Values of type K can be used to look up keys of type Key in a table with a given hasher
+template <typename K, typename Key, typename Hash>
+concept LookupKeyFor = std::same_as<K, Key> || TransparentHash<Hash>;
+
+///
+/// Transparent hasher for strings
+///
+/// std::string, std::string_view and const char* with the same
+/// characters have the same hash. This allows looking up a
+/// std::string_view in a table of std::string without allocating.
+///
+struct StringHash {
+    using is_transparent = void;
+
+    size_t operator()(std::string_view str) const noexcept
+    {
+        return std::hash<std::string_view>()(str);
+    }
+};
+
+///
+/// Policy for hash tables, which store only keys (sets)
+///
+/// The stored values are the keys themselves, so they
+/// cannot be modified through an iterator.
+///
+struct HashSetPolicy {
+    static constexpr bool mutableValues = false;
+
+    template <typename ValueType>
+    static const ValueType& keyOf(const ValueType& value) noexcept
+    {
+        return value;
+    }
+};
+
+///
+/// Policy for hash tables, which store key/value pairs (maps)
+///
+struct HashMapPolicy {
+    static constexpr bool mutableValues = true;
+
+    template <typename PairType>
+    static const auto& keyOf(const PairType& value) noexcept
+    {
+        return value.first;
+    }
+};
+
+///
+/// Separate chaining hash table, which stores each key only once
+///
+/// This is the common implementation of SeparateChainingHash and
+/// SeparateChainingHashMap. `Policy` describes how to obtain the key
+/// of a stored value and whether values can be modified in place.
+///
+/// `Allocator` provides the memory for the nodes and the bucket array.
+/// Use CountingAllocator (utils/CountingAllocator.h) to measure it.
+///
+template <typename KeyType, typename ValueType, typename Policy, typename Hash, typename Allocator = std::allocator<ValueType> >
+class SeparateChainingHashTable {
 public:
-    using value_type = ElementType;
+    using key_type = KeyType;
+    using value_type = ValueType;
     using hasher = Hash;
+    using allocator_type = Allocator;
 
 private:
-    std::vector<std::list<ElementType>> m_buckets = std::vector<std::list<ElementType>>(8);
+    using bucket_type = std::list<value_type, allocator_type>;
+    using bucket_vector_type = std::vector<bucket_type, typename std::allocator_traits<allocator_type>::template rebind_alloc<bucket_type> >;
+
+    // All buckets share the allocator of the table, so nodes can be spliced between them
+    bucket_vector_type m_buckets;
     mutable hasher m_hash = hasher();
     size_t m_size = 0;
     double m_maxLoadFactor = 1.0;
+    size_t m_maxSize = 8; // Largest size for the current buckets (bucket_count * max_load_factor)
+
+public:
+    ///
+    /// Forward iterator over all elements of the table
+    ///
+    /// The elements are visited bucket by bucket.
+    /// Erasing an element invalidates only the iterators to it.
+    /// Inserting an element may cause a rehash, which
+    /// invalidates all iterators.
+    ///
+    template <bool IsConst>
+    class BasicIterator {
+        friend class SeparateChainingHashTable;
+
+        using bucket_vector = std::conditional_t<IsConst, const bucket_vector_type, bucket_vector_type>;
+        using list_iterator = std::conditional_t<IsConst, typename bucket_type::const_iterator, typename bucket_type::iterator>;
+
+        bucket_vector* m_buckets = nullptr;
+        size_t m_bucket = 0;
+        list_iterator m_position = list_iterator();
+
+        BasicIterator(bucket_vector* buckets, size_t bucket, list_iterator position)
+            : m_buckets(buckets), m_bucket(bucket), m_position(position)
+        {
+            skipEmptyBuckets();
+        }
+
+        /// Creates an iterator to the first element of a given bucket (or the one after it)
+        BasicIterator(bucket_vector* buckets, size_t bucket)
+            : m_buckets(buckets), m_bucket(bucket)
+        {
+            if(m_bucket < m_buckets->size())
+                m_position = (*m_buckets)[m_bucket].begin();
+
+            skipEmptyBuckets();
+        }
+
+        void skipEmptyBuckets()
+        {
+            while(m_bucket < m_buckets->size() && m_position == (*m_buckets)[m_bucket].end()) {
+                if(++m_bucket < m_buckets->size())
+                    m_position = (*m_buckets)[m_bucket].begin();
+            }
+        }
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::remove_const_t<ValueType>;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::conditional_t<IsConst, const ValueType&, ValueType&>;
+        using pointer = std::conditional_t<IsConst, const ValueType*, ValueType*>;
+
+        BasicIterator() = default;
+
+        /// Allows conversion from iterator to const_iterator
+        BasicIterator(const BasicIterator<!IsConst>& other) requires IsConst
+            : m_buckets(other.m_buckets), m_bucket(other.m_bucket), m_position(other.m_position)
+        {
+        }
+
+        reference operator*() const
+        {
+            return *m_position;
+        }
+
+        pointer operator->() const
+        {
+            return &*m_position;
+        }
+
+        BasicIterator& operator++()
+        {
+            ++m_position;
+            skipEmptyBuckets();
+            return *this;
+        }
+
+        BasicIterator operator++(int)
+        {
+            BasicIterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        bool operator==(const BasicIterator& other) const
+        {
+            return
+                m_bucket == other.m_bucket &&
+                (m_buckets == nullptr || m_bucket == m_buckets->size() || m_position == other.m_position);
+        }
+
+        bool operator!=(const BasicIterator& other) const
+        {
+            return ! operator==(other);
+        }
+
+        friend class BasicIterator<true>;
+    };
+
+    using const_iterator = BasicIterator<true>;
+    using iterator = std::conditional_t<Policy::mutableValues, BasicIterator<false>, const_iterator>;
 
 public:
     size_t size() const noexcept
@@ -87,6 +326,22 @@ public:
         return m_size;
     }
 
+    bool empty() const noexcept
+    {
+        return m_size == 0;
+    }
+
+    size_t bucket_count() const noexcept
+    {
+        return m_buckets.size();
+    }
+
+    /// Returns the number of elements in the bucket with index n (like std::unordered_set::bucket_size)
+    size_t bucket_size(size_t n) const noexcept
+    {
+        return m_buckets[n].size();
+    }
+
     double load_factor() const noexcept
     {
         return static_cast<double>(m_size) / static_cast<double>(m_buckets.size());
@@ -97,83 +352,1137 @@ public:
         return m_maxLoadFactor;
     }
 
+    /// Sets the maximum load factor and rehashes the table if it is exceeded
     void max_load_factor(double value)
     {
         if(value <= 0)
             throw std::invalid_argument("load factor must be a positive number");
 
         m_maxLoadFactor = value;
+        updateMaxSize();
+
+        if(m_size > m_maxSize)
+            reserve(m_size);
     }
 
-    void swap(SeparateChainingHash& other) noexcept
+    void swap(SeparateChainingHashTable& other) noexcept
     {
         m_buckets.swap(other.m_buckets);
         std::swap(m_hash, other.m_hash);
         std::swap(m_size, other.m_size);
-    }    
+        std::swap(m_maxLoadFactor, other.m_maxLoadFactor);
+        std::swap(m_maxSize, other.m_maxSize);
+    }
+
+    ///
+    /// Changes the number of buckets to at least bucketCount
+    ///
+    /// The number of buckets is rounded up to a power of two, is
+    /// never reduced and is always enough to store the current
+    /// elements without exceeding the maximum load factor. The
+    /// existing nodes are moved (spliced) to their new buckets. No
+    /// elements are copied and no memory is allocated, except for the
+    /// new bucket array.
+    ///
+    void rehash(size_t bucketCount)
+    {
+        size_t newCount = std::bit_ceil(std::max(bucketCount, howManyBucketsFor(m_size)));
+
+        // We already have enough buckets. Nothing to do.
+        if(newCount <= m_buckets.size())
+            return;
+
+        bucket_vector_type buckets(newCount, bucket_type(get_allocator()), m_buckets.get_allocator());
+
+        for(bucket_type& bucket : m_buckets) {
+            while( ! bucket.empty() ) {
+                bucket_type& target = buckets[bucketFor(m_hash(Policy::keyOf(bucket.front())), newCount)];
+                target.splice(target.end(), bucket, bucket.begin());
+            }
+        }
+
+        m_buckets.swap(buckets);
+        updateMaxSize();
+    }
+
+    /// Prepares the table to store elementsCount elements without further rehashing
+    void reserve(size_t elementsCount)
+    {
+        rehash(howManyBucketsFor(elementsCount));
+    }
+
+private:
+    ///
+    /// Maps a hash value to a bucket
+    ///
+    /// The number of buckets is always a power of two,
+    /// so a mask can be used instead of the slower modulo.
+    /// The mask keeps only the lowest bits of the hash, and the
+    /// identity std::hash would put strided integer keys (e.g.
+    /// multiples of 1024) into a few buckets. Therefore the bits are
+    /// mixed first, which is still cheaper than the modulo.
+    ///
+    static size_t bucketFor(size_t hash, size_t bucketCount) noexcept
+    {
+        return mixHashBits(hash) & (bucketCount - 1);
+    }
+
+    size_t bucketFor(size_t hash) const noexcept
+    {
+        return bucketFor(hash, m_buckets.size());
+    }
+
+    bool rehashRequired() const noexcept
+    {
+        return m_size + 1 > m_maxSize;
+    }
+
+    /// The smallest power of two number of buckets, which can store elementsCount elements
+    size_t howManyBucketsFor(size_t elementsCount) const
+    {
+        return std::bit_ceil(std::max<size_t>(8, static_cast<size_t>(std::ceil(static_cast<double>(elementsCount) / max_load_factor()))));
+    }
+
+    /// Recalculates the size at which the table must grow. Called only when the buckets or the load factor change.
+    void updateMaxSize() noexcept
+    {
+        m_maxSize = static_cast<size_t>(static_cast<double>(m_buckets.size()) * max_load_factor());
+    }
+
+    /// Returns the position of key in a given bucket or the end of the bucket
+    template <typename K>
+    typename bucket_type::const_iterator findInBucket(const K& key, size_t bucket) const
+    {
+        return std::find_if(
+            m_buckets[bucket].begin(),
+            m_buckets[bucket].end(),
+            [&key](const value_type& value) { return Policy::keyOf(value) == key; });
+    }
+
+    iterator makeIterator(size_t bucket, typename bucket_type::const_iterator position)
+    {
+        // Obtain a mutable list iterator from a const one
+        return iterator(&m_buckets, bucket, m_buckets[bucket].erase(position, position));
+    }
+
+    template <typename V>
+    std::pair<iterator, bool> insertValue(V&& value)
+    {
+        return insert_hashed(std::forward<V>(value), m_hash(Policy::keyOf(value)));
+    }
+
+public:
+    SeparateChainingHashTable()
+        : SeparateChainingHashTable(8)
+    {
+    }
+
+    explicit SeparateChainingHashTable(const allocator_type& allocator)
+        : SeparateChainingHashTable(8, hasher(), allocator)
+    {
+    }
+
+    SeparateChainingHashTable(size_t bucketCount, hasher hash = hasher(), const allocator_type& allocator = allocator_type())
+        : m_buckets(bucketCount == 0 ? 8 : std::bit_ceil(bucketCount), bucket_type(allocator), allocator),
+          m_hash(hash)
+    {
+        updateMaxSize();
+    }
+
+    hasher hash_function() const
+    {
+        return m_hash;
+    }
+
+    allocator_type get_allocator() const
+    {
+        return allocator_type(m_buckets.get_allocator());
+    }
+
+    /// Returns the key of a value stored in the table
+    static const key_type& keyOf(const value_type& value) noexcept
+    {
+        return Policy::keyOf(value);
+    }
+
+    iterator begin()
+    {
+        return iterator(&m_buckets, 0);
+    }
+
+    iterator end()
+    {
+        return iterator(&m_buckets, m_buckets.size());
+    }
+
+    const_iterator begin() const
+    {
+        return const_iterator(&m_buckets, 0);
+    }
+
+    const_iterator end() const
+    {
+        return const_iterator(&m_buckets, m_buckets.size());
+    }
+
+    ///
+    /// Inserts a value, unless an element with the same key is already present
+    /// @return An iterator to the element with that key and true if the value
+    ///   was inserted, or false if the table already contained the key
+    ///
+    std::pair<iterator, bool> insert(const value_type& value)
+    {
+        return insertValue(value);
+    }
+
+    /// @copydoc insert(const value_type&)
+    std::pair<iterator, bool> insert(value_type&& value)
+    {
+        return insertValue(std::move(value));
+    }
+
+    ///
+    /// Inserts a value, for which the hash of the key is already known
+    ///
+    /// `hash` must be equal to `hash_function()(key)`, where `key` is the key of `value`.
+    /// @copydetails insert(const value_type&)
+    ///
+    template <typename V> requires std::same_as<std::remove_cvref_t<V>, value_type>
+    std::pair<iterator, bool> insert_hashed(V&& value, size_t hash)
+    {
+        const key_type& key = Policy::keyOf(value);
+        size_t bucket = bucketFor(hash);
+        auto position = findInBucket(key, bucket);
+
+        if(position != m_buckets[bucket].end())
+            return std::make_pair(makeIterator(bucket, position), false);
+
+        if(rehashRequired()) {
+            reserve((m_size + 1) * 2);
+            bucket = bucketFor(hash);
+        }
+
+        m_buckets[bucket].push_back(std::forward<V>(value));
+        ++m_size;
+
+        return std::make_pair(makeIterator(bucket, std::prev(m_buckets[bucket].end())), true);
+    }
+
+    bool contains(const key_type& key) const
+    {
+        return contains_hashed(key, m_hash(key));
+    }
+
+    /// Heterogeneous lookup. Available only when the hasher is transparent.
+    template <typename K> requires TransparentHash<hasher>
+    bool contains(const K& key) const
+    {
+        return contains_hashed(key, m_hash(key));
+    }
+
+    ///
+    /// Checks whether the table contains a key, for which the hash is already known
+    ///
+    /// `hash` must be equal to `hash_function()(key)`. Callers which
+    /// look up the same key in several tables, or have received
+    /// the hash together with the key, can skip recalculating it.
+    ///
+    template <typename K> requires LookupKeyFor<K, key_type, hasher>
+    bool contains_hashed(const K& key, size_t hash) const
+    {
+        size_t bucket = bucketFor(hash);
+        return findInBucket(key, bucket) != m_buckets[bucket].end();
+    }
+
+    /// Returns an iterator to the element with a given key, or end() if there is no such element
+    iterator find(const key_type& key)
+    {
+        return find_hashed(key, m_hash(key));
+    }
+
+    /// @copydoc find(const key_type&)
+    const_iterator find(const key_type& key) const
+    {
+        return find_hashed(key, m_hash(key));
+    }
+
+    /// Heterogeneous lookup. Available only when the hasher is transparent.
+    template <typename K> requires TransparentHash<hasher>
+    iterator find(const K& key)
+    {
+        return find_hashed(key, m_hash(key));
+    }
+
+    /// Heterogeneous lookup. Available only when the hasher is transparent.
+    template <typename K> requires TransparentHash<hasher>
+    const_iterator find(const K& key) const
+    {
+        return find_hashed(key, m_hash(key));
+    }
+
+    ///
+    /// Returns an iterator to the element with a given key, for which the hash is already known
+    /// @copydetails contains_hashed
+    ///
+    template <typename K> requires LookupKeyFor<K, key_type, hasher>
+    iterator find_hashed(const K& key, size_t hash)
+    {
+        size_t bucket = bucketFor(hash);
+        auto position = findInBucket(key, bucket);
+
+        return (position == m_buckets[bucket].end()) ? end() : makeIterator(bucket, position);
+    }
+
+    /// @copydoc find_hashed
+    template <typename K> requires LookupKeyFor<K, key_type, hasher>
+    const_iterator find_hashed(const K& key, size_t hash) const
+    {
+        size_t bucket = bucketFor(hash);
+        auto position = findInBucket(key, bucket);
+
+        return (position == m_buckets[bucket].end()) ? end() : const_iterator(&m_buckets, bucket, position);
+    }
+
+    ///
+    /// Removes the element at a given position
+    /// @return An iterator to the element, which followed the erased one
+    ///
+    iterator erase(const_iterator position)
+    {
+        size_t bucket = position.m_bucket;
+        auto next = m_buckets[bucket].erase(position.m_position);
+        --m_size;
+
+        return iterator(&m_buckets, bucket, next);
+    }
+
+    ///
+    /// Removes the element with a given key
+    /// @return The number of elements removed (0 or 1)
+    ///
+    size_t erase(const key_type& key)
+    {
+        size_t bucket = bucketFor(m_hash(key));
+        auto position = findInBucket(key, bucket);
+
+        if(position == m_buckets[bucket].end())
+            return 0;
+
+        m_buckets[bucket].erase(position);
+        --m_size;
+
+        return 1;
+    }
+
+    /// Removes all elements. The number of buckets is not changed.
+    void clear() noexcept
+    {
+        for(bucket_type& bucket : m_buckets)
+            bucket.clear();
+
+        m_size = 0;
+    }
+
+    ///
+    /// Checks which of several keys are present in the table
+    ///
+    /// Sets `results[i]` to `contains(keys[i])`. The keys are processed
+    /// in batches of HashBatchSize. For each batch, all buckets and then
+    /// the first nodes of their chains are prefetched, before any key
+    /// is compared. This way the cache misses for different keys
+    /// overlap, instead of stalling each lookup in turn.
+    /// @exception std::invalid_argument If results is smaller than keys
+    ///
+    void contains_many(std::span<const key_type> keys, std::span<bool> results) const
+    {
+        checkBulkLookupSizes(keys.size(), results.size());
+
+        size_t buckets[HashBatchSize];
+
+        for(size_t first = 0; first < keys.size(); first += HashBatchSize) {
+            size_t count = std::min(HashBatchSize, keys.size() - first);
+
+            for(size_t i = 0; i < count; ++i) {
+                buckets[i] = bucketFor(m_hash(keys[first + i]));
+                prefetchForRead(&m_buckets[buckets[i]]);
+            }
+
+            for(size_t i = 0; i < count; ++i) {
+                if( ! m_buckets[buckets[i]].empty() )
+                    prefetchForRead(&m_buckets[buckets[i]].front());
+            }
+
+            for(size_t i = 0; i < count; ++i)
+                results[first + i] = findInBucket(keys[first + i], buckets[i]) != m_buckets[buckets[i]].end();
+        }
+    }
+
+    ///
+    /// Inserts several values
+    ///
+    /// The table is first grown to accommodate all values, and then
+    /// they are inserted in batches, prefetching their buckets as
+    /// in contains_many(). If some of the values are already
+    /// present, the table may end up with more buckets than needed.
+    /// @return The number of values actually inserted
+    ///
+    size_t insert_many(std::span<const value_type> values)
+    {
+        reserve(m_size + values.size());
+
+        size_t sizeBefore = m_size;
+        size_t hashes[HashBatchSize];
+
+        for(size_t first = 0; first < values.size(); first += HashBatchSize) {
+            size_t count = std::min(HashBatchSize, values.size() - first);
+
+            for(size_t i = 0; i < count; ++i) {
+                hashes[i] = m_hash(Policy::keyOf(values[first + i]));
+                prefetchForRead(&m_buckets[bucketFor(hashes[i])]);
+            }
+
+            for(size_t i = 0; i < count; ++i)
+                insert_hashed(values[first + i], hashes[i]);
+        }
+
+        return m_size - sizeBefore;
+    }
+};
+
+///
+/// Separate chaining hash set
+///
+template <typename ElementType, typename Hash = std::hash<ElementType>, typename Allocator = std::allocator<ElementType> >
+class SeparateChainingHash : public SeparateChainingHashTable<ElementType, ElementType, HashSetPolicy, Hash, Allocator> {
+    using base = SeparateChainingHashTable<ElementType, ElementType, HashSetPolicy, Hash, Allocator>;
+
+public:
+    using base::base;
+};
+
+///
+/// Separate chaining hash map, which associates keys with values
+///
+template <typename KeyType, typename MappedType, typename Hash = std::hash<KeyType>, typename Allocator = std::allocator<std::pair<const KeyType, MappedType> > >
+class SeparateChainingHashMap : public SeparateChainingHashTable<KeyType, std::pair<const KeyType, MappedType>, HashMapPolicy, Hash, Allocator> {
+    using base = SeparateChainingHashTable<KeyType, std::pair<const KeyType, MappedType>, HashMapPolicy, Hash, Allocator>;
+
+public:
+    using mapped_type = MappedType;
+    using typename base::key_type;
+    using typename base::value_type;
+
+    using base::base;
+
+    ///
+    /// Returns a reference to the value associated with key
+    ///
+    /// If the key is not present in the map, it is inserted
+    /// together with a default-constructed value.
+    ///
+    mapped_type& operator[](const key_type& key)
+    {
+        auto it = this->find(key);
+
+        if(it == this->end())
+            it = this->insert(value_type(key, mapped_type())).first;
+
+        return it->second;
+    }
+
+    /// Returns a reference to the value associated with key
+    /// @exception std::out_of_range If the key is not present in the map
+    mapped_type& at(const key_type& key)
+    {
+        auto it = this->find(key);
+
+        if(it == this->end())
+            throw std::out_of_range("key not found");
+
+        return it->second;
+    }
+
+    /// @copydoc at(const key_type&)
+    const mapped_type& at(const key_type& key) const
+    {
+        auto it = this->find(key);
+
+        if(it == this->end())
+            throw std::out_of_range("key not found");
+
+        return it->second;
+    }
+};
+
+///
+/// Open addressing hash set in the style of Google's SwissTable
+///
+/// Next to the array of slots the table keeps an array of one-byte
+/// control values (metadata), one per slot. A control byte is either
+/// EmptySlot, or it stores the lower 7 bits of the hash of the element
+/// in that slot. Slots are grouped in groups of GroupSize. A lookup
+/// compares all the control bytes in a group at once (with SSE2 where
+/// available) and only touches the slots whose 7-bit fragments match.
+/// Thus most of the work is done on a small, contiguous metadata
+/// array and there is no pointer chasing, as in SeparateChainingHash.
+///
+/// Unlike SeparateChainingHash, the class stores each value only once.
+/// Inserting a value which is already present has no effect.
+///
+template <typename ElementType, typename Hash = std::hash<ElementType>, typename Allocator = std::allocator<ElementType> >
+class SwissTableHash {
+public:
+    using value_type = ElementType;
+    using hasher = Hash;
+    using allocator_type = Allocator;
+
+private:
+    static constexpr int8_t EmptySlot = -128; // 0b10000000
+    static constexpr size_t GroupSize = 16;
+
+    ///
+    /// A view of the control bytes of GroupSize consecutive slots
+    ///
+    /// The match functions return a bit mask, where bit i is set
+    /// iff the i-th slot of the group satisfies the condition.
+    ///
+    class Group {
+        const int8_t* m_control;
+
+    public:
+        explicit Group(const int8_t* control)
+            : m_control(control)
+        {
+        }
+
+#ifdef HASHTABLE_USE_SSE2
+        uint32_t match(int8_t fragment) const
+        {
+            __m128i control = _mm_loadu_si128(reinterpret_cast<const __m128i*>(m_control));
+            return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(fragment), control)));
+        }
+#else
+        uint32_t match(int8_t fragment) const
+        {
+            uint32_t mask = 0;
+
+            for(size_t i = 0; i < GroupSize; ++i)
+                mask |= static_cast<uint32_t>(m_control[i] == fragment) << i;
+
+            return mask;
+        }
+#endif
+
+        uint32_t matchEmpty() const
+        {
+            return match(EmptySlot);
+        }
+    };
+
+private:
+    std::vector<int8_t, typename std::allocator_traits<allocator_type>::template rebind_alloc<int8_t> > m_control;
+    std::vector<value_type, allocator_type> m_slots;
+    mutable hasher m_hash = hasher();
+    size_t m_size = 0;
+
+public:
+    size_t size() const noexcept
+    {
+        return m_size;
+    }
+
+    size_t capacity() const noexcept
+    {
+        return m_slots.size();
+    }
+
+    double load_factor() const noexcept
+    {
+        return static_cast<double>(m_size) / static_cast<double>(m_slots.size());
+    }
+
+    /// The table grows when it becomes more than 7/8 full
+    double max_load_factor() const noexcept
+    {
+        return 0.875;
+    }
+
+    void swap(SwissTableHash& other) noexcept
+    {
+        m_control.swap(other.m_control);
+        m_slots.swap(other.m_slots);
+        std::swap(m_hash, other.m_hash);
+        std::swap(m_size, other.m_size);
+    }
 
 private:
     size_t calculateHash(const value_type& value) const
     {
-        return m_hash(value) % m_buckets.size();
+        return mixHashBits(m_hash(value));
     }
 
-    bool rehashRequired() const
+    /// The 7-bit fragment of the hash, which is stored in the control bytes
+    static int8_t fragmentOf(size_t hash) noexcept
     {
-        return max_load_factor() < (static_cast<double>(m_size + 1) / static_cast<double>(m_buckets.size()));
+        return static_cast<int8_t>(hash & 0x7F);
     }
-    
-    size_t howManyBucketsFor(size_t elementsCount)
+
+    size_t groupsCount() const noexcept
     {
-        return (elementsCount == 0) ? 8 : (elementsCount / max_load_factor());
+        return m_control.size() / GroupSize;
     }
 
-    void rehash(size_t bucketCount)
+    /// Index of the first group to probe for a given hash
+    size_t firstGroupFor(size_t hash) const noexcept
     {
-        size_t newCount = std::max(bucketCount, howManyBucketsFor(m_size));
+        return (hash >> 7) & (groupsCount() - 1);
+    }
 
-        // We already have enough buckets. Nothing to do.
-        if(newCount <= m_buckets.size())
-            return;
+    ///
+    /// Index of the group, which follows `group` in the probe sequence
+    ///
+    /// The groups are probed in triangular order (+1, +2, +3, ...).
+    /// When the number of groups is a power of two, this visits
+    /// every group exactly once.
+    ///
+    size_t nextGroup(size_t group, size_t step) const noexcept
+    {
+        return (group + step) & (groupsCount() - 1);
+    }
+
+    bool rehashRequired() const noexcept
+    {
+        return (m_size + 1) * 8 > capacity() * 7;
+    }
+
+    /// Returns the index of the first empty slot on the probe sequence for a hash
+    size_t findEmptySlot(size_t hash) const
+    {
+        size_t group = firstGroupFor(hash);
+
+        for(size_t step = 1; ; ++step) {
+            uint32_t empty = Group(&m_control[group * GroupSize]).matchEmpty();
+
+            if(empty)
+                return group * GroupSize + std::countr_zero(empty);
+
+            group = nextGroup(group, step);
+        }
+    }
+
+    /// Places a value, which is known not to be in the table, into an empty slot
+    void insertUnique(value_type&& value, size_t hash)
+    {
+        size_t slot = findEmptySlot(hash);
+        m_control[slot] = fragmentOf(hash);
+        m_slots[slot] = std::move(value);
+        ++m_size;
+    }
 
-        SeparateChainingHash temp(bucketCount);
+    void rehash(size_t slotsCount)
+    {
+        SwissTableHash temp(slotsCount, m_hash, get_allocator());
 
-        for(const auto& bucket : m_buckets) {
-            for(const auto & value : bucket)
-                temp.insert(value);
+        for(size_t i = 0; i < m_slots.size(); ++i) {
+            if(m_control[i] != EmptySlot) {
+                size_t hash = calculateHash(m_slots[i]);
+                temp.insertUnique(std::move(m_slots[i]), hash);
+            }
         }
 
         swap(temp);
     }
 
-    void reserve(size_t elementsCount)
+    /// Rounds up a number of slots to a power-of-two number of groups
+    static size_t roundUpSlotsCount(size_t slotsCount)
+    {
+        size_t groups = (slotsCount + GroupSize - 1) / GroupSize;
+        return std::bit_ceil(std::max<size_t>(groups, 1)) * GroupSize;
+    }
+
+    /// Prefetches the control bytes and the slots of the first group, probed for a hash
+    void prefetchFirstGroup(size_t hash) const noexcept
     {
-        rehash(static_cast<double>(elementsCount) / max_load_factor());
+        size_t first = firstGroupFor(hash) * GroupSize;
+        prefetchForRead(&m_control[first]);
+        prefetchForRead(&m_slots[first]);
     }
 
 public:
-    SeparateChainingHash() = default;
+    SwissTableHash()
+        : SwissTableHash(GroupSize)
+    {
+    }
 
-    SeparateChainingHash(size_t bucketCount, hasher hash = hasher())
-        : m_buckets(bucketCount == 0 ? 8 : bucketCount), m_hash(hash)
+    explicit SwissTableHash(const allocator_type& allocator)
+        : SwissTableHash(GroupSize, hasher(), allocator)
+    {
+    }
+
+    SwissTableHash(size_t slotsCount, hasher hash = hasher(), const allocator_type& allocator = allocator_type())
+        : m_control(roundUpSlotsCount(slotsCount), EmptySlot, allocator),
+          m_slots(roundUpSlotsCount(slotsCount), allocator),
+          m_hash(hash)
     {
         // Nothing to do here
     }
 
+    hasher hash_function() const
+    {
+        return m_hash;
+    }
+
+    allocator_type get_allocator() const
+    {
+        return m_slots.get_allocator();
+    }
+
+    /// Prepares the table to store elementsCount elements without further rehashing
+    void reserve(size_t elementsCount)
+    {
+        // Keep the load factor at or below 7/8
+        size_t slotsCount = roundUpSlotsCount(elementsCount + elementsCount / 7 + 1);
+
+        if(slotsCount > capacity())
+            rehash(slotsCount);
+    }
+
     void insert(const value_type& value)
     {
+        insertMixed(value, calculateHash(value));
+    }
+
+    /// @copydoc SeparateChainingHashTable::insert_many
+    size_t insert_many(std::span<const value_type> values)
+    {
+        reserve(m_size + values.size());
+
+        size_t sizeBefore = m_size;
+        size_t hashes[HashBatchSize];
+
+        for(size_t first = 0; first < values.size(); first += HashBatchSize) {
+            size_t count = std::min(HashBatchSize, values.size() - first);
+
+            for(size_t i = 0; i < count; ++i) {
+                hashes[i] = calculateHash(values[first + i]);
+                prefetchFirstGroup(hashes[i]);
+            }
+
+            for(size_t i = 0; i < count; ++i)
+                insertMixed(values[first + i], hashes[i]);
+        }
+
+        return m_size - sizeBefore;
+    }
+
+    ///
+    /// Checks which of several values are present in the table
+    ///
+    /// Sets `results[i]` to `contains(values[i])`. The values are
+    /// processed in batches and the first group probed for each
+    /// value is prefetched before any of them is looked up.
+    /// @exception std::invalid_argument If results is smaller than values
+    ///
+    void contains_many(std::span<const value_type> values, std::span<bool> results) const
+    {
+        checkBulkLookupSizes(values.size(), results.size());
+
+        size_t hashes[HashBatchSize];
+
+        for(size_t first = 0; first < values.size(); first += HashBatchSize) {
+            size_t count = std::min(HashBatchSize, values.size() - first);
+
+            for(size_t i = 0; i < count; ++i) {
+                hashes[i] = calculateHash(values[first + i]);
+                prefetchFirstGroup(hashes[i]);
+            }
+
+            for(size_t i = 0; i < count; ++i)
+                results[first + i] = containsMixed(values[first + i], hashes[i]);
+        }
+    }
+
+    bool contains(const value_type& value) const
+    {
+        return containsMixed(value, calculateHash(value));
+    }
+
+    /// Heterogeneous lookup. Available only when the hasher is transparent.
+    template <typename K> requires TransparentHash<hasher>
+    bool contains(const K& key) const
+    {
+        return containsMixed(key, mixHashBits(m_hash(key)));
+    }
+
+    ///
+    /// Checks whether the table contains a value, for which the hash is already known
+    ///
+    /// `hash` must be equal to `hash_function()(value)`.
+    ///
+    template <typename K> requires LookupKeyFor<K, value_type, hasher>
+    bool contains_hashed(const K& value, size_t hash) const
+    {
+        return containsMixed(value, mixHashBits(hash));
+    }
+
+private:
+    /// Inserts a value, given the result of mixHashBits() for its hash
+    void insertMixed(const value_type& value, size_t hash)
+    {
+        if(containsMixed(value, hash))
+            return;
+
         if(rehashRequired())
-            reserve(m_size * 2);
+            rehash(capacity() * 2);
+
+        value_type copy = value;
+        insertUnique(std::move(copy), hash);
+    }
+
+    /// Looks up a value, given the result of mixHashBits() for its hash
+    template <typename K>
+    bool containsMixed(const K& value, size_t hash) const
+    {
+        int8_t fragment = fragmentOf(hash);
+        size_t group = firstGroupFor(hash);
+
+        for(size_t step = 1; ; ++step) {
+            Group g(&m_control[group * GroupSize]);
 
-        size_t bucket = calculateHash(value);
-        m_buckets[bucket].push_back(value);
+            for(uint32_t candidates = g.match(fragment); candidates; candidates &= candidates - 1) {
+                if(m_slots[group * GroupSize + std::countr_zero(candidates)] == value)
+                    return true;
+            }
+
+            // An empty slot terminates the probe sequence, because
+            // the value would have been placed there on insertion
+            if(g.matchEmpty())
+                return false;
+
+            group = nextGroup(group, step);
+        }
+    }
+};
+
+///
+/// Linear probing hash set, which uses Robin Hood hashing
+///
+/// For each slot the table stores the distance between the slot and
+/// the home slot of the element in it (its probe length). On insertion,
+/// an element which has travelled further than the occupant of a slot
+/// takes its place and the insertion continues with the displaced element.
+/// This keeps the probe lengths of all elements close to each other
+/// and lets a lookup stop as soon as it reaches an element which is
+/// closer to its home slot than the one searched for.
+///
+/// Erasing uses backward shifting: the elements that follow the erased
+/// one are moved one slot back, until an empty slot or an element in
+/// its home slot is reached. Thus no tombstones are needed.
+///
+/// Unlike SeparateChainingHash, the class stores each value only once.
+/// Inserting a value which is already present has no effect.
+///
+template <typename ElementType, typename Hash = std::hash<ElementType>, typename Allocator = std::allocator<ElementType> >
+class RobinHoodHash {
+public:
+    using value_type = ElementType;
+    using hasher = Hash;
+    using allocator_type = Allocator;
+
+private:
+    /// Marks an empty slot in m_distances. A full slot stores its probe length + 1.
+    static constexpr uint32_t EmptySlot = 0;
+
+    std::vector<value_type, allocator_type> m_slots;
+    std::vector<uint32_t, typename std::allocator_traits<allocator_type>::template rebind_alloc<uint32_t> > m_distances;
+    mutable hasher m_hash = hasher();
+    size_t m_size = 0;
+    size_t m_maxProbeLength = 0;
+    double m_maxLoadFactor = 0.9;
+
+public:
+    size_t size() const noexcept
+    {
+        return m_size;
+    }
+
+    size_t capacity() const noexcept
+    {
+        return m_slots.size();
+    }
+
+    double load_factor() const noexcept
+    {
+        return static_cast<double>(m_size) / static_cast<double>(m_slots.size());
+    }
+
+    double max_load_factor() const noexcept
+    {
+        return m_maxLoadFactor;
+    }
+
+    void max_load_factor(double value)
+    {
+        if(value <= 0 || value >= 1)
+            throw std::invalid_argument("load factor must be in the interval (0, 1)");
+
+        m_maxLoadFactor = value;
+    }
+
+    ///
+    /// The largest number of slots, which a lookup may need to inspect
+    ///
+    /// The value is exact after a rehash and after each insertion.
+    /// Erasing an element may only shorten probe sequences, so in
+    /// that case the value is an upper bound.
+    ///
+    size_t max_probe_length() const noexcept
+    {
+        return m_maxProbeLength;
+    }
+
+    void swap(RobinHoodHash& other) noexcept
+    {
+        m_slots.swap(other.m_slots);
+        m_distances.swap(other.m_distances);
+        std::swap(m_hash, other.m_hash);
+        std::swap(m_size, other.m_size);
+        std::swap(m_maxProbeLength, other.m_maxProbeLength);
+        std::swap(m_maxLoadFactor, other.m_maxLoadFactor);
+    }
+
+private:
+    size_t homeSlotFor(size_t hash) const noexcept
+    {
+        return mixHashBits(hash) & (m_slots.size() - 1);
+    }
+
+    size_t nextSlot(size_t slot) const noexcept
+    {
+        return (slot + 1) & (m_slots.size() - 1);
+    }
+
+    bool rehashRequired() const
+    {
+        return max_load_factor() < (static_cast<double>(m_size + 1) / static_cast<double>(m_slots.size()));
+    }
+
+    /// Returns the index of the slot which stores value, or capacity() if there is no such slot
+    template <typename K>
+    size_t findSlot(const K& value, size_t hash) const
+    {
+        size_t slot = homeSlotFor(hash);
+
+        // Robin Hood invariant: if the element in the slot is closer to
+        // its home than we are to ours, the value cannot be further down.
+        for(uint32_t distance = 1; m_distances[slot] >= distance; ++distance) {
+            if(m_slots[slot] == value)
+                return slot;
+
+            slot = nextSlot(slot);
+        }
+
+        return capacity();
+    }
+
+    /// Places a value, which is known not to be in the table, into the table
+    void insertUnique(value_type&& value, size_t hash)
+    {
+        size_t slot = homeSlotFor(hash);
+        uint32_t distance = 1;
+
+        while(m_distances[slot] != EmptySlot) {
+            if(m_distances[slot] < distance) {
+                // The current occupant is richer. Take its place and
+                // continue with finding a new slot for it.
+                std::swap(value, m_slots[slot]);
+                std::swap(distance, m_distances[slot]);
+                m_maxProbeLength = std::max<size_t>(m_maxProbeLength, m_distances[slot]);
+            }
+
+            slot = nextSlot(slot);
+            ++distance;
+        }
+
+        m_slots[slot] = std::move(value);
+        m_distances[slot] = distance;
+        m_maxProbeLength = std::max<size_t>(m_maxProbeLength, distance);
         ++m_size;
     }
 
+    void insertHashed(const value_type& value, size_t hash)
+    {
+        if(contains_hashed(value, hash))
+            return;
+
+        if(rehashRequired())
+            rehash(capacity() * 2);
+
+        value_type copy = value;
+        insertUnique(std::move(copy), hash);
+    }
+
+    void prefetchHomeSlot(size_t hash) const noexcept
+    {
+        size_t slot = homeSlotFor(hash);
+        prefetchForRead(&m_distances[slot]);
+        prefetchForRead(&m_slots[slot]);
+    }
+
+    void rehash(size_t slotsCount)
+    {
+        RobinHoodHash temp(slotsCount, m_hash, get_allocator());
+        temp.m_maxLoadFactor = m_maxLoadFactor;
+
+        for(size_t i = 0; i < m_slots.size(); ++i) {
+            if(m_distances[i] != EmptySlot) {
+                size_t hash = m_hash(m_slots[i]);
+                temp.insertUnique(std::move(m_slots[i]), hash);
+            }
+        }
+
+        swap(temp);
+    }
+
+public:
+    RobinHoodHash()
+        : RobinHoodHash(8)
+    {
+    }
+
+    explicit RobinHoodHash(const allocator_type& allocator)
+        : RobinHoodHash(8, hasher(), allocator)
+    {
+    }
+
+    RobinHoodHash(size_t slotsCount, hasher hash = hasher(), const allocator_type& allocator = allocator_type())
+        : m_slots(std::bit_ceil(std::max<size_t>(slotsCount, 8)), allocator),
+          m_distances(std::bit_ceil(std::max<size_t>(slotsCount, 8)), EmptySlot, allocator),
+          m_hash(hash)
+    {
+        // Nothing to do here
+    }
+
+    hasher hash_function() const
+    {
+        return m_hash;
+    }
+
+    allocator_type get_allocator() const
+    {
+        return m_slots.get_allocator();
+    }
+
+    /// Prepares the table to store elementsCount elements without further rehashing
+    void reserve(size_t elementsCount)
+    {
+        size_t slotsCount = std::bit_ceil(static_cast<size_t>(std::ceil(static_cast<double>(elementsCount + 1) / max_load_factor())));
+
+        if(slotsCount > capacity())
+            rehash(slotsCount);
+    }
+
+    void insert(const value_type& value)
+    {
+        insertHashed(value, m_hash(value));
+    }
+
+    /// @copydoc SeparateChainingHashTable::insert_many
+    size_t insert_many(std::span<const value_type> values)
+    {
+        reserve(m_size + values.size());
+
+        size_t sizeBefore = m_size;
+        size_t hashes[HashBatchSize];
+
+        for(size_t first = 0; first < values.size(); first += HashBatchSize) {
+            size_t count = std::min(HashBatchSize, values.size() - first);
+
+            for(size_t i = 0; i < count; ++i) {
+                hashes[i] = m_hash(values[first + i]);
+                prefetchHomeSlot(hashes[i]);
+            }
+
+            for(size_t i = 0; i < count; ++i)
+                insertHashed(values[first + i], hashes[i]);
+        }
+
+        return m_size - sizeBefore;
+    }
+
+    ///
+    /// Checks which of several values are present in the table
+    ///
+    /// Sets `results[i]` to `contains(values[i])`. The values are
+    /// processed in batches and the home slot of each value
+    /// is prefetched before any of them is looked up.
+    /// @exception std::invalid_argument If results is smaller than values
+    ///
+    void contains_many(std::span<const value_type> values, std::span<bool> results) const
+    {
+        checkBulkLookupSizes(values.size(), results.size());
+
+        size_t hashes[HashBatchSize];
+
+        for(size_t first = 0; first < values.size(); first += HashBatchSize) {
+            size_t count = std::min(HashBatchSize, values.size() - first);
+
+            for(size_t i = 0; i < count; ++i) {
+                hashes[i] = m_hash(values[first + i]);
+                prefetchHomeSlot(hashes[i]);
+            }
+
+            for(size_t i = 0; i < count; ++i)
+                results[first + i] = contains_hashed(values[first + i], hashes[i]);
+        }
+    }
+
     bool contains(const value_type& value) const
     {
-        size_t bucket = calculateHash(value);
-        return std::find(m_buckets[bucket].begin(), m_buckets[bucket].end(), value) != m_buckets[bucket].end();
+        return contains_hashed(value, m_hash(value));
+    }
+
+    /// Heterogeneous lookup. Available only when the hasher is transparent.
+    template <typename K> requires TransparentHash<hasher>
+    bool contains(const K& key) const
+    {
+        return contains_hashed(key, m_hash(key));
     }
-};
 
+    ///
+    /// Checks whether the table contains a value, for which the hash is already known
+    ///
+    /// `hash` must be equal to `hash_function()(value)`.
+    ///
+    template <typename K> requires LookupKeyFor<K, value_type, hasher>
+    bool contains_hashed(const K& value, size_t hash) const
+    {
+        return findSlot(value, hash) != capacity();
+    }
+
+    ///
+    /// Removes a value from the table
+    /// @return The number of elements removed (0 or 1)
+    ///
+    size_t erase(const value_type& value)
+    {
+        size_t slot = findSlot(value, m_hash(value));
+
+        if(slot == capacity())
+            return 0;
+
+        // Shift back the elements that follow, until we reach
+        // an empty slot or an element which is in its home slot
+        for(size_t next = nextSlot(slot); m_distances[next] > 1; next = nextSlot(next)) {
+            m_slots[slot] = std::move(m_slots[next]);
+            m_distances[slot] = m_distances[next] - 1;
+            slot = next;
+        }
+
+        m_slots[slot] = value_type();
+        m_distances[slot] = EmptySlot;
+        --m_size;
+
+        return 1;
+    }
+};
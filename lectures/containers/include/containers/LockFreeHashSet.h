@@ -0,0 +1,408 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <limits>
+
+#include "containers/HashTable.h"
+#include "utils/EpochReclamation.h"
+
+///
+/// Lock-free hash set, based on split-ordered lists
+///
+/// (Shalev and Shavit, "Split-Ordered Lists: Lock-Free Extensible Hash Tables", 2006)
+///
+/// All elements are kept in a single lock-free linked list, sorted by
+/// their bit-reversed hash (split order). In this order the elements of
+/// bucket b are followed by those of bucket b + bucketCount, so doubling
+/// the number of buckets never moves elements. It only splits a bucket's
+/// part of the list in two, by inserting a new dummy node in the middle.
+/// The bucket array holds pointers to these dummy nodes and is filled lazily.
+///
+/// insert() and erase() use compare-and-swap and never block.
+/// contains() only reads the list. It never writes to shared memory and
+/// never restarts, so it cannot be delayed by other threads' failed CASes.
+///
+/// Like SeparateChainingHash, the set mixes the hash (mixHashBits)
+/// before taking the bucket from its lowest bits and before reversing
+/// it, so keys with equal low bits (e.g. multiples of the bucket count
+/// with the identity std::hash) are spread over all buckets.
+///
+/// Erased nodes are first marked as deleted (in the lowest bit of their
+/// next pointer), then unlinked and finally handed over to
+/// EpochReclamation, which deletes them once no thread can be reading them.
+///
+template <typename ElementType, typename Hash = std::hash<ElementType> >
+class LockFreeHashSet {
+public:
+    using value_type = ElementType;
+    using hasher = Hash;
+
+private:
+    struct Node {
+        /// The bit-reversed hash. Regular nodes have the lowest bit set, dummy nodes do not.
+        const size_t orderKey;
+        const value_type value;
+
+        /// Pointer to the next node. The lowest bit is set when this node is deleted.
+        std::atomic<uintptr_t> next = 0;
+
+        Node(size_t orderKey, const value_type& value = value_type())
+            : orderKey(orderKey), value(value)
+        {
+        }
+
+        bool isDummy() const noexcept
+        {
+            return (orderKey & 1) == 0;
+        }
+    };
+
+    static Node* pointerOf(uintptr_t link) noexcept
+    {
+        return reinterpret_cast<Node*>(link & ~uintptr_t(1));
+    }
+
+    static bool isMarked(uintptr_t link) noexcept
+    {
+        return (link & 1) != 0;
+    }
+
+    static uintptr_t linkTo(Node* node) noexcept
+    {
+        return reinterpret_cast<uintptr_t>(node);
+    }
+
+    static size_t regularKey(size_t hash) noexcept
+    {
+        return reverseBits(hash) | 1;
+    }
+
+    static size_t dummyKey(size_t bucket) noexcept
+    {
+        return reverseBits(bucket) & ~size_t(1);
+    }
+
+    static size_t reverseBits(size_t value) noexcept
+    {
+        static_assert(sizeof(size_t) == 8, "expects 64-bit size_t");
+
+        // Swap adjacent bits, then pairs of bits, nibbles, bytes and so on
+        value = ((value >> 1) & 0x5555555555555555) | ((value & 0x5555555555555555) << 1);
+        value = ((value >> 2) & 0x3333333333333333) | ((value & 0x3333333333333333) << 2);
+        value = ((value >> 4) & 0x0F0F0F0F0F0F0F0F) | ((value & 0x0F0F0F0F0F0F0F0F) << 4);
+        value = ((value >> 8) & 0x00FF00FF00FF00FF) | ((value & 0x00FF00FF00FF00FF) << 8);
+        value = ((value >> 16) & 0x0000FFFF0000FFFF) | ((value & 0x0000FFFF0000FFFF) << 16);
+
+        return (value >> 32) | (value << 32);
+    }
+
+    /// The bucket, which is split to create a given bucket: the same index without its highest bit
+    static size_t parentOf(size_t bucket) noexcept
+    {
+        return bucket & ~std::bit_floor(bucket);
+    }
+
+    ///
+    /// The buckets are stored in segments, which are allocated when first needed
+    ///
+    /// Segment 0 holds bucket 0 and segment s > 0 holds buckets [2^(s-1), 2^s).
+    /// Thus the existing buckets never move when more buckets are added.
+    ///
+    static constexpr int SegmentsCount = std::numeric_limits<size_t>::digits;
+
+    using bucket_slot = std::atomic<Node*>;
+
+    std::atomic<bucket_slot*> m_segments[SegmentsCount] = {};
+    std::atomic<size_t> m_bucketCount = 2;
+    std::atomic<size_t> m_size = 0;
+    hasher m_hash = hasher();
+
+    /// The table doubles its buckets when there are more than MaxLoadFactor elements per bucket
+    static constexpr size_t MaxLoadFactor = 2;
+
+    static int segmentOf(size_t bucket) noexcept
+    {
+        return std::bit_width(bucket);
+    }
+
+    static size_t segmentSize(int segment) noexcept
+    {
+        return segment == 0 ? 1 : size_t(1) << (segment - 1);
+    }
+
+    static size_t offsetInSegment(size_t bucket) noexcept
+    {
+        return bucket == 0 ? 0 : bucket - std::bit_floor(bucket);
+    }
+
+    /// Returns the slot for a bucket, or nullptr if its segment has not been allocated yet
+    bucket_slot* findSlot(size_t bucket) const noexcept
+    {
+        bucket_slot* segment = m_segments[segmentOf(bucket)].load(std::memory_order_acquire);
+        return segment ? &segment[offsetInSegment(bucket)] : nullptr;
+    }
+
+    /// Returns the slot for a bucket, allocating its segment if necessary
+    bucket_slot& slotFor(size_t bucket)
+    {
+        int index = segmentOf(bucket);
+        bucket_slot* segment = m_segments[index].load(std::memory_order_acquire);
+
+        if( ! segment ) {
+            bucket_slot* allocated = new bucket_slot[segmentSize(index)]();
+
+            if(m_segments[index].compare_exchange_strong(segment, allocated, std::memory_order_acq_rel))
+                segment = allocated;
+            else
+                delete[] allocated; // Another thread was faster. segment now holds its array.
+        }
+
+        return segment[offsetInSegment(bucket)];
+    }
+
+    /// Returns the dummy node of a bucket, creating it (and its parents) if necessary
+    Node* dummyOf(size_t bucket)
+    {
+        bucket_slot& slot = slotFor(bucket);
+        Node* dummy = slot.load(std::memory_order_acquire);
+
+        if(dummy)
+            return dummy;
+
+        Node* created = new Node(dummyKey(bucket));
+        Node* existing = insertNode(dummyOf(parentOf(bucket)), created);
+
+        if(existing != created)
+            delete created; // Another thread has already inserted the dummy node
+
+        slot.store(existing, std::memory_order_release);
+        return existing;
+    }
+
+    ///
+    /// Searches the list for a node, starting from a dummy node
+    ///
+    /// Looks for the first node with orderKey greater than key, or an equal
+    /// node (the dummy node with that key, or a regular node with that key
+    /// and value). On return, `prev` points to the link leading to
+    /// `current`, which is either the equal node, or the position where
+    /// such a node should be inserted.
+    ///
+    /// Nodes marked as deleted are unlinked and retired on the way.
+    /// @return true if an equal node was found
+    ///
+    bool find(Node* start, size_t key, const value_type* value, std::atomic<uintptr_t>*& prev, Node*& current)
+    {
+    retry:
+        prev = &start->next;
+        current = pointerOf(prev->load(std::memory_order_acquire));
+
+        while(current) {
+            uintptr_t next = current->next.load(std::memory_order_acquire);
+
+            // Make sure `current` is still linked after `prev`
+            if(prev->load(std::memory_order_acquire) != linkTo(current))
+                goto retry;
+
+            if(isMarked(next)) {
+                uintptr_t expected = linkTo(current);
+
+                if( ! prev->compare_exchange_strong(expected, linkTo(pointerOf(next)), std::memory_order_acq_rel))
+                    goto retry;
+
+                EpochReclamation::instance().retire(current);
+                current = pointerOf(next);
+                continue;
+            }
+
+            if(current->orderKey > key)
+                return false;
+
+            if(current->orderKey == key && (value == nullptr || current->value == *value))
+                return true;
+
+            prev = &current->next;
+            current = pointerOf(next);
+        }
+
+        return false;
+    }
+
+    ///
+    /// Inserts a node in the list, unless an equal node is already there
+    /// @return The node, which is in the list after the operation: either `node` or the equal one
+    ///
+    Node* insertNode(Node* start, Node* node)
+    {
+        const value_type* value = node->isDummy() ? nullptr : &node->value;
+        std::atomic<uintptr_t>* prev;
+        Node* current;
+
+        while(true) {
+            if(find(start, node->orderKey, value, prev, current))
+                return current;
+
+            node->next.store(linkTo(current), std::memory_order_relaxed);
+            uintptr_t expected = linkTo(current);
+
+            if(prev->compare_exchange_strong(expected, linkTo(node), std::memory_order_release, std::memory_order_relaxed))
+                return node;
+        }
+    }
+
+    size_t calculateHash(const value_type& value) const
+    {
+        return mixHashBits(m_hash(value));
+    }
+
+    /// `hash` is the result of calculateHash(), so its low bits are well mixed
+    size_t bucketFor(size_t hash) const noexcept
+    {
+        return hash & (m_bucketCount.load(std::memory_order_acquire) - 1);
+    }
+
+public:
+    LockFreeHashSet()
+    {
+        // Bucket 0 is the head of the list and always exists
+        slotFor(0).store(new Node(dummyKey(0)), std::memory_order_release);
+    }
+
+    LockFreeHashSet(const LockFreeHashSet&) = delete;
+    LockFreeHashSet& operator=(const LockFreeHashSet&) = delete;
+
+    /// Must not be called while other threads are accessing the set
+    ~LockFreeHashSet()
+    {
+        Node* p = slotFor(0).load();
+
+        while(p) {
+            Node* next = pointerOf(p->next.load());
+            delete p;
+            p = next;
+        }
+
+        for(std::atomic<bucket_slot*>& segment : m_segments)
+            delete[] segment.load();
+    }
+
+    /// Number of elements. May be outdated, if other threads modify the set at the same time.
+    size_t size() const noexcept
+    {
+        return m_size.load(std::memory_order_relaxed);
+    }
+
+    size_t bucket_count() const noexcept
+    {
+        return m_bucketCount.load(std::memory_order_relaxed);
+    }
+
+    double load_factor() const noexcept
+    {
+        return static_cast<double>(size()) / static_cast<double>(bucket_count());
+    }
+
+    ///
+    /// Inserts a value, unless it is already present
+    /// @return true if the value was inserted
+    ///
+    bool insert(const value_type& value)
+    {
+        EpochReclamation::Guard guard;
+
+        size_t hash = calculateHash(value);
+        Node* node = new Node(regularKey(hash), value);
+
+        if(insertNode(dummyOf(bucketFor(hash)), node) != node) {
+            delete node;
+            return false;
+        }
+
+        size_t buckets = m_bucketCount.load(std::memory_order_relaxed);
+
+        if(m_size.fetch_add(1, std::memory_order_relaxed) + 1 > buckets * MaxLoadFactor && buckets < (size_t(1) << (SegmentsCount - 1)))
+            m_bucketCount.compare_exchange_strong(buckets, buckets * 2, std::memory_order_acq_rel);
+
+        return true;
+    }
+
+    ///
+    /// Checks whether a value is present
+    ///
+    /// The function never writes to shared memory. If the bucket of the
+    /// value has not been initialized yet, the search starts from the
+    /// closest initialized parent bucket instead.
+    ///
+    bool contains(const value_type& value) const
+    {
+        EpochReclamation::Guard guard;
+
+        size_t hash = calculateHash(value);
+        size_t key = regularKey(hash);
+        size_t bucket = bucketFor(hash);
+
+        Node* start = nullptr;
+
+        for(;; bucket = parentOf(bucket)) {
+            bucket_slot* slot = findSlot(bucket);
+            if(slot && (start = slot->load(std::memory_order_acquire)))
+                break;
+        }
+
+        for(Node* p = pointerOf(start->next.load(std::memory_order_acquire)); p && p->orderKey <= key; ) {
+            uintptr_t next = p->next.load(std::memory_order_acquire);
+
+            if(p->orderKey == key && ! isMarked(next) && p->value == value)
+                return true;
+
+            p = pointerOf(next);
+        }
+
+        return false;
+    }
+
+    ///
+    /// Removes a value from the set
+    /// @return The number of elements removed (0 or 1)
+    ///
+    size_t erase(const value_type& value)
+    {
+        EpochReclamation::Guard guard;
+
+        size_t hash = calculateHash(value);
+        size_t key = regularKey(hash);
+        Node* start = dummyOf(bucketFor(hash));
+
+        std::atomic<uintptr_t>* prev;
+        Node* current;
+
+        while(true) {
+            if( ! find(start, key, &value, prev, current) )
+                return 0;
+
+            uintptr_t next = current->next.load(std::memory_order_acquire);
+
+            if(isMarked(next))
+                continue; // Another thread is erasing the node. find() will help unlink it.
+
+            // Logical deletion: mark the node. From now on no node can be linked after it.
+            if( ! current->next.compare_exchange_strong(next, next | 1, std::memory_order_acq_rel))
+                continue;
+
+            m_size.fetch_sub(1, std::memory_order_relaxed);
+
+            // Physical deletion. If it fails, the next find() will unlink the node.
+            uintptr_t expected = linkTo(current);
+
+            if(prev->compare_exchange_strong(expected, next, std::memory_order_acq_rel))
+                EpochReclamation::instance().retire(current);
+            else
+                find(start, key, &value, prev, current);
+
+            return 1;
+        }
+    }
+};
@@ -0,0 +1,372 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "containers/HashTable.h"   // prefetchForRead, HASHTABLE_USE_SSE2
+
+///
+/// A fixed-size array of trivially copyable values, which starts at a cache line boundary
+///
+/// The static search trees compute which values share a cache line
+/// from their indices, which is only correct if the array is aligned.
+///
+template <typename T>
+class CacheAlignedArray {
+    static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_default_constructible_v<T>,
+        "CacheAlignedArray stores only trivially copyable values");
+
+public:
+    static constexpr size_t Alignment = std::max<size_t>(64, alignof(T));
+
+private:
+    struct Delete {
+        void operator()(T* ptr) const noexcept
+        {
+            ::operator delete(ptr, std::align_val_t(Alignment));
+        }
+    };
+
+    std::unique_ptr<T[], Delete> m_data;
+    size_t m_size = 0;
+
+public:
+    CacheAlignedArray() = default;
+
+    explicit CacheAlignedArray(size_t size)
+        : m_data(size ? static_cast<T*>(::operator new(size * sizeof(T), std::align_val_t(Alignment))) : nullptr),
+          m_size(size)
+    {
+    }
+
+    CacheAlignedArray(const CacheAlignedArray& other)
+        : CacheAlignedArray(other.m_size)
+    {
+        if(m_size)
+            std::memcpy(m_data.get(), other.m_data.get(), m_size * sizeof(T));
+    }
+
+    CacheAlignedArray(CacheAlignedArray&& other) noexcept
+        : m_data(std::move(other.m_data)), m_size(std::exchange(other.m_size, 0))
+    {
+    }
+
+    CacheAlignedArray& operator=(CacheAlignedArray other) noexcept
+    {
+        std::swap(m_data, other.m_data);
+        std::swap(m_size, other.m_size);
+        return *this;
+    }
+
+    T* data() noexcept
+    {
+        return m_data.get();
+    }
+
+    const T* data() const noexcept
+    {
+        return m_data.get();
+    }
+
+    size_t size() const noexcept
+    {
+        return m_size;
+    }
+
+    T& operator[](size_t index) noexcept
+    {
+        return m_data[index];
+    }
+
+    const T& operator[](size_t index) const noexcept
+    {
+        return m_data[index];
+    }
+};
+
+///
+/// A read-only sorted set, stored in Eytzinger (breadth-first) order
+///
+/// The keys form an implicit complete binary search tree: the
+/// successors of the key at index k (counting from 1) are at 2k and
+/// 2k + 1. There are no pointers, so the whole tree is n keys, and the
+/// first levels, which every lookup visits, share a few cache lines.
+///
+/// The lookup is branchless: each step computes the next index from
+/// the result of a comparison, so there are no mispredicted branches.
+/// The descendants of k a few levels below it are adjacent in memory
+/// and start at a cache line boundary, so a lookup prefetches the line
+/// it will need four levels later (for 4-byte keys) while it works on
+/// the current one. Together, this makes the lookups several times
+/// faster than std::lower_bound on a sorted array, where the first
+/// steps jump across the whole array and each branch is a coin flip.
+///
+/// The tree is built in O(n) time from the keys in ascending order,
+/// e.g. from a sorted array or from the in-order walk of a
+/// BinarySearchTree. It cannot be modified afterwards.
+///
+template <typename Key>
+class EytzingerTree {
+public:
+    using value_type = Key;
+
+private:
+    static constexpr size_t KeysPerLine = std::max<size_t>(1, 64 / sizeof(Key));
+
+    CacheAlignedArray<Key> m_keys;   // m_keys[0] is unused
+    size_t m_size = 0;
+
+    template <typename InputIterator>
+    void fill(size_t k, InputIterator& it, const Key*& previous)
+    {
+        if(k > m_size)
+            return;
+
+        fill(2 * k, it, previous);
+
+        m_keys[k] = *it;
+        ++it;
+
+        if(previous && m_keys[k] < *previous)
+            throw std::invalid_argument("EytzingerTree requires the keys in ascending order");
+
+        previous = &m_keys[k];
+
+        fill(2 * k + 1, it, previous);
+    }
+
+    /// Index of the first key, which is not less than `key`, or 0 if there is none
+    size_t lowerBoundIndex(const Key& key) const noexcept
+    {
+        const Key* keys = m_keys.data();
+        size_t k = 1;
+
+        while(k <= m_size) {
+            // The start of the descendants of k, log2(KeysPerLine) levels below. Prefetching
+            // past the end of the array is harmless, so the address is not checked.
+            prefetchForRead(reinterpret_cast<const void*>(reinterpret_cast<uintptr_t>(keys) + k * KeysPerLine * sizeof(Key)));
+            k = 2 * k + (keys[k] < key);
+        }
+
+        // The last step, which went left, was the answer. Undo the right steps after it.
+        return k >> (std::countr_one(k) + 1);
+    }
+
+public:
+    EytzingerTree()
+        : m_keys(1)
+    {
+    }
+
+    ///
+    /// Builds the tree from `count` keys in ascending order, starting at `first`
+    ///
+    /// `first` only needs * and prefix ++, so this also accepts
+    /// BinarySearchTree::Iterator. Throws std::invalid_argument if
+    /// the keys are not sorted.
+    ///
+    template <typename InputIterator>
+    EytzingerTree(InputIterator first, size_t count)
+        : m_keys(count + 1), m_size(count)
+    {
+        const Key* previous = nullptr;
+        fill(1, first, previous);
+    }
+
+    /// Builds the tree from a sorted array
+    explicit EytzingerTree(std::span<const Key> sorted)
+        : EytzingerTree(sorted.begin(), sorted.size())
+    {
+    }
+
+    /// Returns a pointer to the first key, which is not less than `key`, or nullptr if there is none
+    const Key* lowerBound(const Key& key) const noexcept
+    {
+        size_t k = lowerBoundIndex(key);
+        return k ? &m_keys[k] : nullptr;
+    }
+
+    bool contains(const Key& key) const noexcept
+    {
+        size_t k = lowerBoundIndex(key);
+        return k && !(key < m_keys[k]);
+    }
+
+    size_t size() const noexcept
+    {
+        return m_size;
+    }
+
+    bool empty() const noexcept
+    {
+        return m_size == 0;
+    }
+};
+
+///
+/// A read-only sorted set, stored as an implicit B-tree with one cache line per node (an S-tree)
+///
+/// Each node holds B sorted keys (16 for 4-byte keys) and has B + 1
+/// successors, which are computed from its index like in EytzingerTree:
+/// the successors of node k are k(B + 1) + 1 ... k(B + 1) + B + 1.
+/// A lookup reads one cache line per level and the tree is only
+/// log_(B+1)(n) levels deep, so there are about four times fewer
+/// cache misses than in a binary tree.
+///
+/// Within a node, the number of keys less than the searched one
+/// selects the successor. It is counted without branches; for 32-bit
+/// integers with SSE2, a whole node is compared with four instructions.
+/// Other keys use a plain loop, which the compiler can vectorize.
+///
+/// The slots after the last key are padded with std::numeric_limits<Key>::max(),
+/// so Key must be a type for which numeric_limits is specialized.
+///
+template <typename Key>
+class StaticBTree {
+    static_assert(std::numeric_limits<Key>::is_specialized, "StaticBTree pads its nodes with std::numeric_limits<Key>::max()");
+
+public:
+    using value_type = Key;
+
+    /// Number of keys in a node
+    static constexpr size_t B = std::max<size_t>(2, 64 / sizeof(Key));
+
+private:
+    CacheAlignedArray<Key> m_keys;
+    size_t m_size = 0;
+    size_t m_nodesCount = 0;
+    Key m_largest{};
+
+    static constexpr size_t successor(size_t node, size_t index) noexcept
+    {
+        return node * (B + 1) + index + 1;
+    }
+
+    template <typename InputIterator>
+    void fill(size_t node, InputIterator& it, size_t& filled, const Key*& previous)
+    {
+        if(node >= m_nodesCount)
+            return;
+
+        for(size_t i = 0; i < B; ++i) {
+            fill(successor(node, i), it, filled, previous);
+
+            Key& slot = m_keys[node * B + i];
+
+            if(filled < m_size) {
+                slot = *it;
+                ++it;
+                ++filled;
+
+                if(previous && slot < *previous)
+                    throw std::invalid_argument("StaticBTree requires the keys in ascending order");
+
+                previous = &slot;
+            }
+            else {
+                slot = std::numeric_limits<Key>::max();
+            }
+        }
+
+        fill(successor(node, B), it, filled, previous);
+    }
+
+    /// Number of keys in a node, which are less than `key`
+    static size_t rank(const Key* node, const Key& key) noexcept
+    {
+#if defined(HASHTABLE_USE_SSE2)
+        if constexpr (std::is_same_v<Key, int32_t> && B == 16) {
+            __m128i x = _mm_set1_epi32(key);
+            const __m128i* keys = reinterpret_cast<const __m128i*>(node);
+
+            __m128i less0 = _mm_cmpgt_epi32(x, _mm_load_si128(keys + 0));
+            __m128i less1 = _mm_cmpgt_epi32(x, _mm_load_si128(keys + 1));
+            __m128i less2 = _mm_cmpgt_epi32(x, _mm_load_si128(keys + 2));
+            __m128i less3 = _mm_cmpgt_epi32(x, _mm_load_si128(keys + 3));
+
+            // Pack the 32-bit masks to bytes, one bit per key
+            __m128i packed = _mm_packs_epi16(_mm_packs_epi32(less0, less1), _mm_packs_epi32(less2, less3));
+            return static_cast<size_t>(std::popcount(static_cast<unsigned>(_mm_movemask_epi8(packed))));
+        }
+#endif
+
+        size_t result = 0;
+
+        for(size_t i = 0; i < B; ++i)
+            result += node[i] < key;
+
+        return result;
+    }
+
+public:
+    StaticBTree() = default;
+
+    /// @copydoc EytzingerTree::EytzingerTree(InputIterator, size_t)
+    template <typename InputIterator>
+    StaticBTree(InputIterator first, size_t count)
+        : m_size(count), m_nodesCount((count + B - 1) / B)
+    {
+        m_keys = CacheAlignedArray<Key>(m_nodesCount * B);
+
+        size_t filled = 0;
+        const Key* previous = nullptr;
+        fill(0, first, filled, previous);
+
+        if(previous)
+            m_largest = *previous;
+    }
+
+    /// Builds the tree from a sorted array
+    explicit StaticBTree(std::span<const Key> sorted)
+        : StaticBTree(sorted.begin(), sorted.size())
+    {
+    }
+
+    /// Returns a pointer to the first key, which is not less than `key`, or nullptr if there is none
+    const Key* lowerBound(const Key& key) const noexcept
+    {
+        // Keys larger than the largest one would find the padding
+        if(m_size == 0 || m_largest < key)
+            return nullptr;
+
+        const Key* result = nullptr;
+
+        for(size_t node = 0; node < m_nodesCount; ) {
+            const Key* keys = m_keys.data() + node * B;
+            size_t i = rank(keys, key);
+
+            if(i < B)
+                result = keys + i;
+
+            node = successor(node, i);
+        }
+
+        return result;
+    }
+
+    bool contains(const Key& key) const noexcept
+    {
+        const Key* result = lowerBound(key);
+        return result && !(key < *result);
+    }
+
+    size_t size() const noexcept
+    {
+        return m_size;
+    }
+
+    bool empty() const noexcept
+    {
+        return m_size == 0;
+    }
+};
@@ -1,15 +1,40 @@
 #pragma once
 
 #include "utils/Allocator.h"
+#include "utils/Arena.h"
+#include "utils/TrackingAllocator.h"
+#include "containers/BalancedTreeNodeOperations.h"
 #include "containers/TreeNodeIterator.h"
 #include "containers/TreeNodeOperations.h"
 
+#include <ranges>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
 template <typename T>
 using SimpleNodeAllocator = SimpleAllocator<TreeNode<T>>;
 
 template <typename T>
 using DebugNodeAllocator = DebugAllocator<TreeNode<T>>;
 
+template <typename T>
+using TrackingNodeAllocator = TrackingAllocator<TreeNode<T>>;
+
+template <typename T>
+using PoolNodeAllocator = PoolAllocator<TreeNode<T>>;
+
+template <typename T>
+using ArenaNodeAllocator = ArenaAllocator<TreeNode<T>>;
+
+/// Allocator for trees with parent pointers, e.g. BinarySearchTree<T, ParentNodeAllocator<T>, RecursiveNodeOperations<T, ParentTreeNode<T>>>
+template <typename T>
+using ParentNodeAllocator = SimpleAllocator<ParentTreeNode<T>>;
+
+/// Allocator for trees with subtree sizes, which support BinarySearchTree::rank and BinarySearchTree::select
+template <typename T>
+using SizedNodeAllocator = SimpleAllocator<SizedTreeNode<T>>;
+
 template <
     typename ElementType,
     typename AllocatorType = SimpleNodeAllocator<ElementType>,
@@ -17,18 +42,27 @@ template <
     >
 class BinarySearchTree {
 public:
-    using node_type = TreeNode<ElementType>;
+    using node_type = typename NodeOperations::node_type;
     using value_type = ElementType;
     using allocator_type = AllocatorType;
 
+    static_assert(std::is_same_v<decltype(std::declval<allocator_type&>().buy()), node_type*>,
+        "The allocator must create the node type of the NodeOperations (e.g. ParentNodeAllocator for ParentTreeNode)");
+
 private:
+    // Trees with parent pointers iterate without a stack and in both directions
+    using node_iterator = std::conditional_t<
+        node_type::HasParent,
+        ParentTreeNodeIterator<value_type, node_type>,
+        TreeNodeIterator<value_type, node_type>>;
+
     node_type* m_rootptr = nullptr;
     size_t m_size = 0;
     allocator_type m_allocator;
 
 public:
     class Iterator {
-        TreeNodeIterator<value_type> it;
+        node_iterator it;
 
     public:
         Iterator(node_type* startFrom)
@@ -36,6 +70,11 @@ public:
         {            
         }
 
+        Iterator(node_iterator it)
+            : it(it)
+        {
+        }
+
         value_type& operator*()
         {
             return it->data;
@@ -51,12 +90,18 @@ public:
             ++it;
         }
 
-        bool operator==(const Iterator& other)
+        /// Moves to the previous element; decrementing endIterator() gives the last one
+        void operator--() requires node_type::HasParent
+        {
+            --it;
+        }
+
+        bool operator==(const Iterator& other) const
         {
             return it == other.it;
         }
 
-        bool operator!=(const Iterator& other)
+        bool operator!=(const Iterator& other) const
         {
             return it != other.it;
         }
@@ -86,9 +131,79 @@ public:
         return *this;
     }
 
+    BinarySearchTree(BinarySearchTree&& other) noexcept(std::is_nothrow_move_constructible_v<allocator_type>)
+        : m_allocator(std::move(other.m_allocator))
+    {
+        // The nodes are taken only after the allocator, whose move may throw
+        m_rootptr = std::exchange(other.m_rootptr, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+    }
+
+    BinarySearchTree& operator=(BinarySearchTree&& other)
+    {
+        if(this != &other) {
+            clear();
+            m_rootptr = std::exchange(other.m_rootptr, nullptr);
+            m_size = std::exchange(other.m_size, 0);
+            m_allocator = std::move(other.m_allocator);
+        }
+        return *this;
+    }
+
+    ///
+    /// Creates a perfectly balanced tree of the values in `sorted`
+    ///
+    /// Takes O(n) time, while inserting the values one by one takes
+    /// O(n log n) time, or O(n^2) with the unbalanced NodeOperations.
+    ///
+    /// @exception std::invalid_argument if the values are not in ascending order
+    ///
+    template <std::ranges::input_range Range>
+    static BinarySearchTree fromSorted(Range&& sorted)
+    {
+        BinarySearchTree result;
+        node_type* list = nullptr;
+        node_type** tail = &list;
+        const node_type* last = nullptr;
+        size_t count = 0;
+
+        try {
+            for(const auto& value : sorted) {
+                if(last && value < last->data)
+                    throw std::invalid_argument("BinarySearchTree::fromSorted() requires the values in ascending order");
+
+                node_type* node = result.m_allocator.buy();
+                node->data = value;
+                *tail = node;
+                tail = &node->right;
+                last = node;
+                ++count;
+            }
+        }
+        catch(...) {
+            releaseList(list, result.m_allocator);
+            throw;
+        }
+
+        result.m_rootptr = NodeOperations::buildBalanced(list, count);
+        result.m_size = count;
+        return result;
+    }
+
+    ///
+    /// Removes all elements from the tree
+    ///
+    /// When the allocator can release all of its nodes at once (e.g.
+    /// PoolAllocator or ArenaAllocator) and they need no destruction,
+    /// the tree is not walked.
+    ///
     void clear()
     {
-        NodeOperations::release(m_rootptr, m_allocator);
+        if constexpr (std::is_trivially_destructible_v<node_type> && requires(allocator_type& a) { a.clear(); })
+            m_allocator.clear();
+        else
+            NodeOperations::release(m_rootptr, m_allocator);
+
         m_rootptr = nullptr;
         m_size = 0;
     }
@@ -149,6 +264,349 @@ public:
 
     Iterator endIterator()
     {
-        return Iterator(nullptr);
+        if constexpr (node_type::HasParent)
+            return Iterator(node_iterator::endIterator(m_rootptr));
+        else
+            return Iterator(nullptr);
+    }
+
+    /// Returns an iterator to the first element, which is not less than `value`
+    Iterator lowerBound(const value_type& value)
+    {
+        return Iterator(node_iterator::lowerBound(m_rootptr, value));
+    }
+
+    /// Returns an iterator to the first element, which is greater than `value`
+    Iterator upperBound(const value_type& value)
+    {
+        return Iterator(node_iterator::upperBound(m_rootptr, value));
+    }
+
+    ///
+    /// Calls visit(element) for each element in [lo, hi], in ascending order
+    ///
+    /// Only the subtrees, which can contain such elements, are entered,
+    /// so visiting k elements takes O(height + k) time.
+    ///
+    template <typename Visitor>
+    void range(const value_type& lo, const value_type& hi, Visitor visit) const
+    {
+        visitRange(m_rootptr, lo, hi, visit);
+    }
+
+    ///
+    /// Returns the number of elements, which are less than `value`
+    ///
+    /// Needs nodes, which store the sizes of their subtrees (e.g.
+    /// SizedTreeNode), and takes O(height) time.
+    ///
+    size_t rank(const value_type& value) const requires node_type::HasSubtreeSize
+    {
+        size_t result = 0;
+
+        for(const node_type* node = m_rootptr; node; ) {
+            if(node->data < value) {
+                result += subtreeSizeOf(node->left) + 1;
+                node = node->right;
+            }
+            else {
+                node = node->left;
+            }
+        }
+
+        return result;
+    }
+
+    ///
+    /// Returns the k-th smallest element, counting from 0
+    ///
+    /// E.g. select(size() / 2) is the median. Needs nodes, which store
+    /// the sizes of their subtrees, and takes O(height) time.
+    ///
+    /// @exception std::out_of_range if k >= size()
+    ///
+    const value_type& select(size_t k) const requires node_type::HasSubtreeSize
+    {
+        if(k >= m_size)
+            throw std::out_of_range("BinarySearchTree::select() called with k >= size()");
+
+        const node_type* node = m_rootptr;
+
+        while(true) {
+            size_t leftSize = subtreeSizeOf(node->left);
+
+            if(k < leftSize) {
+                node = node->left;
+            }
+            else if(k == leftSize) {
+                return node->data;
+            }
+            else {
+                k -= leftSize + 1;
+                node = node->right;
+            }
+        }
+    }
+
+    ///
+    /// Adds the elements of `other`, which are not in this tree (like std::set_union)
+    ///
+    /// Like the other set operations, walks both trees in order, so it
+    /// takes O(n + m) time instead of O(m log(n + m)) for inserting the
+    /// elements one by one. The nodes of this tree are reused, and the
+    /// result is rebuilt perfectly balanced. An element, which occurs
+    /// k times here and l times in `other`, occurs max(k, l) times in
+    /// the result.
+    ///
+    /// If allocating a node fails, the elements added until then stay
+    /// in the tree and the exception is rethrown.
+    ///
+    void unite(const BinarySearchTree& other)
+    {
+        mergeWith(other, true, true, true);
+    }
+
+    /// Keeps only the elements, which are also in `other` (like std::set_intersection)
+    void intersect(const BinarySearchTree& other)
+    {
+        mergeWith(other, false, true, false);
+    }
+
+    /// Removes the elements, which are in `other` (like std::set_difference)
+    void subtract(const BinarySearchTree& other)
+    {
+        mergeWith(other, true, false, false);
+    }
+
+    ///
+    /// Moves the elements, which are not less than `value`, to a new tree and returns it
+    ///
+    /// Both trees are rebuilt perfectly balanced in O(n) time. The
+    /// nodes are moved when the allocator is stateless (e.g.
+    /// SimpleAllocator), otherwise they are copied to the allocator of
+    /// the new tree. If that fails, this tree is rebuilt unchanged.
+    ///
+    BinarySearchTree split(const value_type& value)
+    {
+        BinarySearchTree result;
+
+        node_type* list = flattenTree(m_rootptr);
+        m_rootptr = nullptr;
+
+        size_t lowerCount = 0;
+        node_type** cut = &list;
+
+        for(; *cut && (*cut)->data < value; cut = &(*cut)->right)
+            ++lowerCount;
+
+        node_type* upper = *cut;
+        *cut = nullptr;
+
+        try {
+            upper = transferList(upper, m_allocator, result.m_allocator);
+        }
+        catch(...) {
+            *cut = upper;
+            m_rootptr = NodeOperations::buildBalanced(list, m_size);
+            throw;
+        }
+
+        result.m_rootptr = NodeOperations::buildBalanced(upper, m_size - lowerCount);
+        result.m_size = m_size - lowerCount;
+        m_rootptr = NodeOperations::buildBalanced(list, lowerCount);
+        m_size = lowerCount;
+
+        return result;
+    }
+
+    ///
+    /// Moves all elements of `other` to the end of this tree, e.g. to undo split()
+    ///
+    /// The result is rebuilt perfectly balanced in O(n + m) time.
+    /// `other` becomes empty. Like in split(), its nodes are moved or
+    /// copied, depending on the allocator.
+    ///
+    /// @exception std::invalid_argument if `other` has an element, which is less than one in this tree
+    ///
+    void join(BinarySearchTree&& other)
+    {
+        if(&other == this || other.empty())
+            return;
+
+        if( ! empty() ) {
+            const node_type* smallest = other.m_rootptr;
+            while(smallest->left)
+                smallest = smallest->left;
+
+            if(smallest->data < NodeOperations::findPointerToLargest(m_rootptr)->data)
+                throw std::invalid_argument("BinarySearchTree::join() requires the elements of the other tree not to be less");
+        }
+
+        node_type* appended = flattenTree(other.m_rootptr);
+        other.m_rootptr = nullptr;
+
+        try {
+            appended = transferList(appended, other.m_allocator, m_allocator);
+        }
+        catch(...) {
+            other.m_rootptr = NodeOperations::buildBalanced(appended, other.m_size);
+            throw;
+        }
+
+        node_type* list = flattenTree(m_rootptr);
+        node_type** tail = &list;
+        while(*tail)
+            tail = &(*tail)->right;
+        *tail = appended;
+
+        m_size += std::exchange(other.m_size, 0);
+        m_rootptr = NodeOperations::buildBalanced(list, m_size);
+    }
+
+private:
+    static void releaseList(node_type* list, allocator_type& allocator)
+    {
+        while(list) {
+            node_type* next = list->right;
+            allocator.release(list);
+            list = next;
+        }
+    }
+
+    ///
+    /// Hands a list of nodes, linked by `right`, over from the allocator `from` to `to`
+    ///
+    /// Stateless allocators can release each other's nodes, so the
+    /// list is returned as it is. Otherwise the values are copied to new
+    /// nodes from `to`. If that fails, `list` is left as it was.
+    ///
+    static node_type* transferList(node_type* list, allocator_type& from, allocator_type& to)
+    {
+        if constexpr (std::is_empty_v<allocator_type>) {
+            return list;
+        }
+        else {
+            node_type* copy = nullptr;
+            node_type** tail = &copy;
+
+            try {
+                for(const node_type* node = list; node; node = node->right) {
+                    *tail = to.buy();
+                    (*tail)->data = node->data;
+                    tail = &(*tail)->right;
+                }
+            }
+            catch(...) {
+                releaseList(copy, to);
+                throw;
+            }
+
+            releaseList(list, from);
+            return copy;
+        }
+    }
+
+    ///
+    /// Merges the elements of this tree and `other` in order, like the std::set_... algorithms
+    ///
+    /// The flags select which elements are kept: those only in this
+    /// tree, those in both trees (this tree's copy is kept) and those
+    /// only in `other`.
+    ///
+    void mergeWith(const BinarySearchTree& other, bool keepOnlyMine, bool keepCommon, bool addOnlyTheirs)
+    {
+        if(&other == this) {
+            if( ! keepCommon )
+                clear();
+            return;
+        }
+
+        node_type* mine = flattenTree(m_rootptr);
+        m_rootptr = nullptr;
+
+        node_type* merged = nullptr;
+        node_type** tail = &merged;
+        size_t count = 0;
+
+        auto append = [&](node_type* node) {
+            *tail = node;
+            tail = &node->right;
+            ++count;
+        };
+
+        auto takeMine = [&](bool keep) {
+            node_type* node = mine;
+            mine = mine->right;
+
+            if(keep)
+                append(node);
+            else
+                m_allocator.release(node);
+        };
+
+        auto addCopy = [&](const value_type& value) {
+            node_type* node = m_allocator.buy();
+            node->data = value;
+            append(node);
+        };
+
+        try {
+            node_iterator theirs(other.m_rootptr);
+
+            while(mine && ! theirs.atEnd()) {
+                if(mine->data < theirs->data) {
+                    takeMine(keepOnlyMine);
+                }
+                else if(theirs->data < mine->data) {
+                    if(addOnlyTheirs)
+                        addCopy(theirs->data);
+                    ++theirs;
+                }
+                else {
+                    takeMine(keepCommon);
+                    ++theirs;
+                }
+            }
+
+            while(mine)
+                takeMine(keepOnlyMine);
+
+            if(addOnlyTheirs)
+                for(; ! theirs.atEnd(); ++theirs)
+                    addCopy(theirs->data);
+        }
+        catch(...) {
+            // Only allocations can fail. The rest of this tree is not less than the merged nodes.
+            for(*tail = mine; mine; mine = mine->right)
+                ++count;
+
+            m_rootptr = NodeOperations::buildBalanced(merged, count);
+            m_size = count;
+            throw;
+        }
+
+        *tail = nullptr;
+        m_rootptr = NodeOperations::buildBalanced(merged, count);
+        m_size = count;
+    }
+
+    template <typename Visitor>
+    static void visitRange(const node_type* node, const value_type& lo, const value_type& hi, Visitor& visit)
+    {
+        if( ! node )
+            return;
+
+        // The left subtree is not greater and the right one not less than the node
+        bool notBelow = !(node->data < lo);
+        bool notAbove = !(hi < node->data);
+
+        if(notBelow)
+            visitRange(node->left, lo, hi, visit);
+
+        if(notBelow && notAbove)
+            visit(node->data);
+
+        if(notAbove)
+            visitRange(node->right, lo, hi, visit);
     }
 };
\ No newline at end of file
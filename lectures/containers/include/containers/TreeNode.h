@@ -1,9 +1,66 @@
 #pragma once
 
-template <typename T>
-class TreeNode {
+#include <cstddef>
+
+///
+/// The parent pointer of a TreeNode, which is only present when HasParent is true
+///
+/// Without it the base is empty and takes no space in the node.
+///
+template <typename Node, bool HasParent>
+struct TreeNodeParentLink {
+};
+
+template <typename Node>
+struct TreeNodeParentLink<Node, true> {
+    /// The node, whose `left` or `right` refers to this one, or nullptr for the root
+    Node* parent = nullptr;
+};
+
+///
+/// The size of the subtree of a TreeNode, which is only present when HasSubtreeSize is true
+///
+/// Allows BinarySearchTree to compute the rank of a value and to
+/// select the k-th value in O(height) time.
+///
+template <bool HasSubtreeSize>
+struct TreeNodeSubtreeSize {
+};
+
+template <>
+struct TreeNodeSubtreeSize<true> {
+    /// Number of nodes in the subtree of this node, including itself
+    size_t subtreeSize = 1;
+};
+
+///
+/// A node of a binary search tree
+///
+/// With WithParent = true the node also points to its parent, and with
+/// WithSubtreeSize = true it knows the size of its subtree. All
+/// NodeOperations keep both up to date. ParentTreeNodeIterator walks
+/// a tree with parents in both directions without a stack.
+///
+template <typename T, bool WithParent = false, bool WithSubtreeSize = false>
+class TreeNode
+    : public TreeNodeParentLink<TreeNode<T, WithParent, WithSubtreeSize>, WithParent>,
+      public TreeNodeSubtreeSize<WithSubtreeSize> {
 public:
+    static constexpr bool HasParent = WithParent;
+    static constexpr bool HasSubtreeSize = WithSubtreeSize;
+
     T data = T();
+
+    ///
+    /// Metadata of the self-balancing NodeOperations
+    ///
+    /// The height of the subtree for AvlNodeOperations, the color for
+    /// RedBlackNodeOperations and the priority for TreapNodeOperations.
+    /// The unbalanced NodeOperations ignore it. For small T it fits in
+    /// the padding between `data` and `left`, so it costs no memory.
+    ///
+    unsigned balance = 0;
+
     TreeNode* left = nullptr;
     TreeNode* right = nullptr;
 
@@ -54,4 +111,77 @@ public:
         left = nullptr;
         right = nullptr;
     }
-};
\ No newline at end of file
+};
+
+/// A TreeNode, which points to its parent
+template <typename T>
+using ParentTreeNode = TreeNode<T, true>;
+
+/// A TreeNode, which knows the size of its subtree
+template <typename T>
+using SizedTreeNode = TreeNode<T, false, true>;
+
+///
+/// Makes `parent` the parent of `node`
+///
+/// Does nothing if `node` is null or the nodes have no parent pointers,
+/// so the NodeOperations can call it unconditionally.
+///
+template <typename Node>
+inline void linkParent(Node* node, Node* parent) noexcept
+{
+    if constexpr (Node::HasParent) {
+        if(node)
+            node->parent = parent;
+    }
+}
+
+/// Returns the parent of `node`, or nullptr if it is null, the root, or the nodes have no parent pointers
+template <typename Node>
+inline Node* parentOf(const Node* node) noexcept
+{
+    if constexpr (Node::HasParent)
+        return node ? node->parent : nullptr;
+    else
+        return nullptr;
+}
+
+/// Returns the number of nodes in the subtree of `node` (0 if it is null or the nodes do not store it)
+template <typename Node>
+inline size_t subtreeSizeOf(const Node* node) noexcept
+{
+    if constexpr (Node::HasSubtreeSize)
+        return node ? node->subtreeSize : 0;
+    else
+        return 0;
+}
+
+///
+/// Recomputes the subtree size of `node` from those of its successors
+///
+/// Does nothing if `node` is null or the nodes do not store subtree sizes.
+///
+template <typename Node>
+inline void updateSubtreeSize(Node* node) noexcept
+{
+    if constexpr (Node::HasSubtreeSize) {
+        if(node)
+            node->subtreeSize = 1 + subtreeSizeOf(node->left) + subtreeSizeOf(node->right);
+    }
+}
+
+///
+/// Decrements the subtree sizes of the nodes on the path from `root` to `node`, excluding `node`
+///
+/// Called before `node` is extracted by the NodeOperations, which do
+/// not walk back up to `root`. `node` must be the first node with its
+/// value on the search path.
+///
+template <typename Node>
+inline void shrinkSubtreeSizesAbove(Node* root, const Node* node) noexcept
+{
+    if constexpr (Node::HasSubtreeSize) {
+        for(Node* current = root; current != node; current = current->whichSuccessorWouldStore(node->data))
+            --current->subtreeSize;
+    }
+}
@@ -6,13 +6,15 @@
 #include <stack>
 #include <vector>
 
-template <typename T>
+template <typename T, typename NodeType = TreeNode<T>>
 class TreeNodeIterator {
 public:
-    using node_type = TreeNode<T>;
+    using node_type = NodeType;
 
 private:
-    std::stack<node_type*> backtrack;
+    // A vector, unlike the default std::deque, allocates nothing until
+    // the first push, so end iterators are free to create and copy
+    std::stack<node_type*, std::vector<node_type*>> backtrack;
 
 private:
     void pushAllTheWayToTheLeft(node_type* startFrom)
@@ -21,18 +23,55 @@ private:
             backtrack.push(startFrom);
     }
 
+    ///
+    /// Returns an iterator to the first node, for which goesRight(node) is false
+    ///
+    /// The stack gets the nodes on the path from `root`, at which the
+    /// search went left, i.e. exactly the nodes, which follow the
+    /// found one in order.
+    ///
+    template <typename GoesRight>
+    static TreeNodeIterator firstNotGoingRight(node_type* root, GoesRight goesRight)
+    {
+        TreeNodeIterator result(nullptr);
+
+        while(root) {
+            if(goesRight(root)) {
+                root = root->right;
+            }
+            else {
+                result.backtrack.push(root);
+                root = root->left;
+            }
+        }
+
+        return result;
+    }
+
 public:
     static TreeNodeIterator endIterator()
     {
         return TreeNodeIterator(nullptr);
     }
 
+    /// Returns an iterator to the first node, whose value is not less than `value`
+    static TreeNodeIterator lowerBound(node_type* root, const T& value)
+    {
+        return firstNotGoingRight(root, [&value](const node_type* node) { return node->data < value; });
+    }
+
+    /// Returns an iterator to the first node, whose value is greater than `value`
+    static TreeNodeIterator upperBound(node_type* root, const T& value)
+    {
+        return firstNotGoingRight(root, [&value](const node_type* node) { return !(value < node->data); });
+    }
+
 public:
     TreeNodeIterator(node_type* startFrom)
     {
         pushAllTheWayToTheLeft(startFrom);
     }
-    
+
     bool atEnd() const
     {
         return backtrack.empty();
@@ -49,7 +88,7 @@ public:
         assert( ! atEnd() );
         return backtrack.top();
     }
-    
+
     void operator++()
     {
         assert( ! atEnd() );
@@ -71,3 +110,169 @@ public:
         return ! operator==(other);
     }
 };
+
+///
+/// An in-order iterator over a tree of ParentTreeNode objects, which needs no stack
+///
+/// The iterator is just two pointers: the current node and the root.
+/// The next node is the leftmost one in the right subtree, or else the
+/// first ancestor, which is reached from its left subtree. Walking
+/// the whole tree follows each link twice, so ++ takes O(1) amortized
+/// time. Creating, copying and comparing iterators never allocates.
+///
+/// Unlike TreeNodeIterator, it can also move backwards. Decrementing
+/// the end iterator gives the last node, which is why the iterator
+/// remembers the root.
+///
+template <typename T, typename NodeType = ParentTreeNode<T>>
+class ParentTreeNodeIterator {
+public:
+    using node_type = NodeType;
+
+    static_assert(node_type::HasParent, "ParentTreeNodeIterator needs nodes with parent pointers");
+
+private:
+    node_type* m_node = nullptr;
+    node_type* m_root = nullptr;
+
+    static node_type* leftmost(node_type* node) noexcept
+    {
+        if(node)
+            while(node->left)
+                node = node->left;
+
+        return node;
+    }
+
+    static node_type* rightmost(node_type* node) noexcept
+    {
+        if(node)
+            while(node->right)
+                node = node->right;
+
+        return node;
+    }
+
+    /// Returns an iterator to the first node, for which goesRight(node) is false
+    template <typename GoesRight>
+    static ParentTreeNodeIterator firstNotGoingRight(node_type* root, GoesRight goesRight)
+    {
+        node_type* result = nullptr;
+
+        for(node_type* node = root; node; ) {
+            if(goesRight(node)) {
+                node = node->right;
+            }
+            else {
+                result = node;
+                node = node->left;
+            }
+        }
+
+        return ParentTreeNodeIterator(result, root);
+    }
+
+public:
+    /// Returns an end iterator. Pass the root to be able to decrement it.
+    static ParentTreeNodeIterator endIterator(node_type* root = nullptr)
+    {
+        return ParentTreeNodeIterator(nullptr, root);
+    }
+
+    /// @copydoc TreeNodeIterator::lowerBound
+    static ParentTreeNodeIterator lowerBound(node_type* root, const T& value)
+    {
+        return firstNotGoingRight(root, [&value](const node_type* node) { return node->data < value; });
+    }
+
+    /// @copydoc TreeNodeIterator::upperBound
+    static ParentTreeNodeIterator upperBound(node_type* root, const T& value)
+    {
+        return firstNotGoingRight(root, [&value](const node_type* node) { return !(value < node->data); });
+    }
+
+public:
+    /// Creates an iterator to the first node of the tree with root `root`
+    ParentTreeNodeIterator(node_type* root)
+        : m_node(leftmost(root)), m_root(root)
+    {
+    }
+
+    /// Creates an iterator to `node` (nullptr for the end) in the tree with root `root`
+    ParentTreeNodeIterator(node_type* node, node_type* root)
+        : m_node(node), m_root(root)
+    {
+    }
+
+    bool atEnd() const noexcept
+    {
+        return m_node == nullptr;
+    }
+
+    node_type& operator*()
+    {
+        assert( ! atEnd() );
+        return *m_node;
+    }
+
+    node_type* operator->()
+    {
+        assert( ! atEnd() );
+        return m_node;
+    }
+
+    void operator++()
+    {
+        assert( ! atEnd() );
+
+        if(m_node->right) {
+            m_node = leftmost(m_node->right);
+            return;
+        }
+
+        node_type* child = m_node;
+        m_node = m_node->parent;
+
+        while(m_node && child == m_node->right) {
+            child = m_node;
+            m_node = m_node->parent;
+        }
+    }
+
+    ///
+    /// Moves to the previous node
+    ///
+    /// Decrementing the end iterator gives the last node.
+    /// Decrementing the first node gives the end iterator.
+    ///
+    void operator--()
+    {
+        if(m_node == nullptr) {
+            m_node = rightmost(m_root);
+            return;
+        }
+
+        if(m_node->left) {
+            m_node = rightmost(m_node->left);
+            return;
+        }
+
+        node_type* child = m_node;
+        m_node = m_node->parent;
+
+        while(m_node && child == m_node->left) {
+            child = m_node;
+            m_node = m_node->parent;
+        }
+    }
+
+    bool operator==(const ParentTreeNodeIterator& other) const noexcept
+    {
+        return m_node == other.m_node;
+    }
+
+    bool operator!=(const ParentTreeNodeIterator& other) const noexcept
+    {
+        return ! operator==(other);
+    }
+};
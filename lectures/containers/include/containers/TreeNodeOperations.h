@@ -7,14 +7,88 @@
 //#include "containers/TreeNodeIterator.h"
 #include "utils/Allocator.h"
 
+///
+/// Turns a tree into a list of its nodes in ascending order, linked by `right`
+///
+/// The `left` pointers are set to null, while the parent pointers and
+/// subtree sizes (if the nodes have them) are left as they were. Takes
+/// O(n) time and no extra memory: the right successor of the root is
+/// rotated up until the root is the largest node, which then moves to
+/// the front of the list. Each rotation puts one more node on the left
+/// spine and only nodes from the left spine go to the list.
+///
+template <typename Node>
+Node* flattenTree(Node* root) noexcept
+{
+    Node* list = nullptr;
+
+    while(root) {
+        if(root->right) {
+            Node* promoted = root->right;
+            root->right = promoted->left;
+            promoted->left = root;
+            root = promoted;
+        }
+        else {
+            Node* next = root->left;
+            root->left = nullptr;
+            root->right = list;
+            list = root;
+            root = next;
+        }
+    }
+
+    return list;
+}
+
+///
+/// Builds a perfectly balanced tree from the first `count` nodes of a list made by flattenTree
+///
+/// `list` is advanced past the used nodes. The left subtree of each
+/// node gets half of its nodes, rounded down, and the right subtree the
+/// rest. Parent pointers and subtree sizes are set, and then
+/// finish(node, leftCount, rightCount) is called for each node, after
+/// its successors, so that the NodeOperations can set `balance`. The
+/// parent of the returned root is not set. Takes O(count) time and the
+/// recursion is only log2(count) deep.
+///
+template <typename Node, typename Finish>
+Node* buildBalancedTree(Node*& list, size_t count, const Finish& finish)
+{
+    if(count == 0)
+        return nullptr;
+
+    size_t leftCount = count / 2;
+    size_t rightCount = count - leftCount - 1;
+
+    Node* left = buildBalancedTree(list, leftCount, finish);
+    Node* root = list;
+    list = list->right;
+
+    root->left = left;
+    root->right = buildBalancedTree(list, rightCount, finish);
+    linkParent(root->left, root);
+    linkParent(root->right, root);
+    updateSubtreeSize(root);
+    finish(root, leftCount, rightCount);
+
+    return root;
+}
+
 ///
 /// Recursive implementation of basic BST operations
 ///
-template <typename ElementType>
+/// NodeType is a TreeNode<ElementType, ...>. If it stores parent pointers
+/// or subtree sizes (e.g. ParentTreeNode or SizedTreeNode), the
+/// operations also update them. `rootptr` is then expected to be the
+/// root pointer of the whole tree, or a pointer to a subtree, whose
+/// root knows its parent.
+///
+template <typename ElementType, typename NodeType = TreeNode<ElementType>>
 class RecursiveNodeOperations {
 public:
     using value_type = ElementType;
-    using node_type = TreeNode<value_type>;
+    using node_type = NodeType;
 
     ///
     /// Checks whether two trees have the same structure and node values
@@ -49,6 +123,23 @@ public:
         return findPointerTo(value, startFrom->whichSuccessorWouldStore(value));
     }
 
+private:
+    /// Attaches `node` where findPointerTo would find it. `parent` is the node, which owns `startFrom`.
+    static void insertBelow(node_type*& startFrom, node_type& node, node_type* parent)
+    {
+        if(startFrom == nullptr || startFrom->data == node.data) {
+            linkParent(&node, parent);
+            updateSubtreeSize(&node);
+            startFrom = &node;
+        }
+        else {
+            insertBelow(startFrom->whichSuccessorWouldStore(node.data), node, startFrom);
+            updateSubtreeSize(startFrom);
+        }
+    }
+
+public:
+
     ///
     /// Insert `node` into the tree with root pointed by `rootptr`
     ///
@@ -56,7 +147,7 @@ public:
     ///
     static void insert(node_type*& rootptr, node_type& node)
     {
-        findPointerTo(node.data, rootptr) = &node;
+        insertBelow(rootptr, node, parentOf(rootptr));
     }
 
     ///
@@ -95,6 +186,9 @@ public:
         node_type* result = nullptr;
         node_type*& parentPtr = findPointerTo(data, rootptr);
 
+        if(parentPtr != nullptr)
+            shrinkSubtreeSizesAbove(rootptr, parentPtr);
+
         if(parentPtr == nullptr) {
             // No such node is present in the tree. Nothing to do.
         }
@@ -109,10 +203,16 @@ public:
             // and also (2) has at least one successor on the left
             assert(promoted != nullptr);
 
+            shrinkSubtreeSizesAbove(result->left, promoted);
             ptrToPromoted = promoted->left;
+            linkParent(ptrToPromoted, parentOf(promoted));
             parentPtr = promoted;
             promoted->left = result->left;
             promoted->right = result->right;
+            linkParent(promoted, parentOf(result));
+            linkParent(promoted->left, promoted);
+            linkParent(promoted->right, promoted);
+            updateSubtreeSize(promoted);
 
             result->detachSuccessors();
         }
@@ -121,9 +221,11 @@ public:
             // is a leaf and when it has only a right successor
             result = parentPtr;
             parentPtr = parentPtr->right;
+            linkParent(parentPtr, parentOf(result));
             result->detachSuccessors();
         }
 
+        linkParent<node_type>(result, nullptr);
         return result;
     }
 
@@ -159,6 +261,7 @@ public:
         if(startFrom) {
             result = allocator.buy();
             result->data = startFrom->data;
+            result->balance = startFrom->balance;
 
             node_type* leftTree  = nullptr;
             node_type* rightTree = nullptr;
@@ -176,20 +279,39 @@ public:
 
             result->left  = leftTree;
             result->right = rightTree;
+            linkParent(leftTree, result);
+            linkParent(rightTree, result);
+            updateSubtreeSize(result);
         }
 
         return result;
-    }    
+    }
+
+    ///
+    /// Builds a perfectly balanced tree from `count` nodes in ascending order, linked by `right`
+    ///
+    /// Takes O(count) time, while inserting the nodes one by one takes
+    /// O(count log count) time, or O(count^2) for sorted values and
+    /// unbalanced operations. The nodes can come from flattenTree.
+    /// The self-balancing NodeOperations also set `balance`, so the tree
+    /// can be modified with them afterwards.
+    ///
+    static node_type* buildBalanced(node_type* list, size_t count)
+    {
+        node_type* root = buildBalancedTree(list, count, [](node_type*, size_t, size_t) {});
+        linkParent<node_type>(root, nullptr);
+        return root;
+    }
 };
 
 ///
 /// Iterative implementation of basic BST operations
 ///
-template <typename ElementType>
+template <typename ElementType, typename NodeType = TreeNode<ElementType>>
 class IterativeNodeOperations {
 public:
     using value_type = ElementType;
-    using node_type = TreeNode<value_type>;
+    using node_type = NodeType;
 
     /// @copydoc RecursiveNodeOperations::sameTrees
     static bool sameTrees(const node_type* a, const node_type* b)
@@ -240,7 +362,20 @@ public:
     /// @copydoc RecursiveNodeOperations::insert
     static void insert(node_type*& rootptr, node_type& node)
     {
-        findPointerTo(node.data, rootptr) = &node;
+        node_type** slot = &rootptr;
+        node_type* parent = parentOf(rootptr);
+
+        while(*slot != nullptr && (*slot)->data != node.data) {
+            parent = *slot;
+            slot = &parent->whichSuccessorWouldStore(node.data);
+
+            if constexpr (node_type::HasSubtreeSize)
+                ++parent->subtreeSize;
+        }
+
+        linkParent(&node, parent);
+        updateSubtreeSize(&node);
+        *slot = &node;
     }
 
     /// @copydoc RecursiveNodeOperations::findPointerToLargest
@@ -260,6 +395,9 @@ public:
         node_type* result = nullptr;
         node_type*& parentPtr = findPointerTo(data, rootptr);
 
+        if(parentPtr != nullptr)
+            shrinkSubtreeSizesAbove(rootptr, parentPtr);
+
         if(parentPtr == nullptr) {
             // No such node is present in the tree. Nothing to do.
         }
@@ -274,10 +412,16 @@ public:
             // and also (2) has at least one successor on the left
             assert(promoted != nullptr);
 
+            shrinkSubtreeSizesAbove(result->left, promoted);
             ptrToPromoted = promoted->left;
+            linkParent(ptrToPromoted, parentOf(promoted));
             parentPtr = promoted;
             promoted->left = result->left;
             promoted->right = result->right;
+            linkParent(promoted, parentOf(result));
+            linkParent(promoted->left, promoted);
+            linkParent(promoted->right, promoted);
+            updateSubtreeSize(promoted);
 
             result->detachSuccessors();
         }
@@ -286,9 +430,11 @@ public:
             // is a leaf and when it has only a right successor
             result = parentPtr;
             parentPtr = parentPtr->right;
+            linkParent(parentPtr, parentOf(result));
             result->detachSuccessors();
         }
 
+        linkParent<node_type>(result, nullptr);
         return result;
     }
 
@@ -321,6 +467,15 @@ public:
         //TODO implement iterative cloning
         throw std::exception();
     }
+
+    /// @copydoc RecursiveNodeOperations::buildBalanced
+    static node_type* buildBalanced(node_type* list, size_t count)
+    {
+        // The recursion is only log2(count) deep
+        node_type* root = buildBalancedTree(list, count, [](node_type*, size_t, size_t) {});
+        linkParent<node_type>(root, nullptr);
+        return root;
+    }
 };
 
 
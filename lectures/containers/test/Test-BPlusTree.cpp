@@ -0,0 +1,205 @@
+#include "catch2/catch_all.hpp"
+#include "containers/BPlusTree.h"
+
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+// Small nodes make deep trees, which exercise splitting and merging of inner nodes
+using SmallNodeSet = BPlusTree<int, void, 64>;
+
+template <typename Tree>
+static std::vector<int> contentsOf(const Tree& tree)
+{
+    std::vector<int> result;
+
+    for(auto it = tree.beginIterator(); it != tree.endIterator(); ++it)
+        result.push_back(*it);
+
+    return result;
+}
+
+TEST_CASE("BPlusTree::BPlusTree() constructs an empty tree", "[bplustree]")
+{
+    BPlusTree<int> tree;
+
+    CHECK(tree.empty());
+    CHECK(tree.size() == 0);
+    CHECK(tree.height() == 0);
+    CHECK_FALSE(tree.contains(5));
+    CHECK_FALSE(tree.erase(5));
+    CHECK(tree.beginIterator() == tree.endIterator());
+    CHECK(tree.lowerBound(5) == tree.endIterator());
+}
+
+TEST_CASE("BPlusTree nodes fit in the requested size", "[bplustree]")
+{
+    CHECK(BPlusTree<int>::LeafCapacity >= 32);
+    CHECK(BPlusTree<int>::InnerCapacity >= 16);
+    CHECK(SmallNodeSet::LeafCapacity >= 4);
+    CHECK(SmallNodeSet::InnerCapacity >= 4);
+}
+
+TEMPLATE_TEST_CASE("BPlusTree::insert() adds unique keys in order", "[bplustree]", (BPlusTree<int>), SmallNodeSet)
+{
+    TestType tree;
+    std::set<int> expected;
+    std::mt19937 random(42);
+
+    for(int i = 0; i < 5000; ++i) {
+        int key = static_cast<int>(random() % 10000);
+        CHECK(tree.insert(key) == expected.insert(key).second);
+    }
+
+    CHECK(tree.size() == expected.size());
+    CHECK(contentsOf(tree) == std::vector<int>(expected.begin(), expected.end()));
+
+    for(int key = -1; key <= 10000; ++key)
+        REQUIRE(tree.contains(key) == (expected.count(key) > 0));
+}
+
+TEMPLATE_TEST_CASE("BPlusTree::insert() with sorted keys keeps the tree shallow", "[bplustree]", (BPlusTree<int>), SmallNodeSet)
+{
+    TestType tree;
+    const int count = 100000;
+
+    for(int i = 0; i < count; ++i)
+        tree.insert(i);
+
+    // Every node except the root is at least half full
+    size_t levels = 1;
+    for(size_t capacity = TestType::LeafCapacity / 2; capacity < count; capacity *= TestType::InnerCapacity / 2 + 1)
+        ++levels;
+
+    CHECK(tree.height() <= levels);
+    CHECK(tree.size() == count);
+    CHECK(*tree.beginIterator() == 0);
+}
+
+TEMPLATE_TEST_CASE("BPlusTree::erase() removes keys and keeps the rest", "[bplustree]", (BPlusTree<int>), SmallNodeSet)
+{
+    TestType tree;
+    std::set<int> expected;
+    std::mt19937 random(7);
+
+    for(int i = 0; i < 3000; ++i) {
+        int key = static_cast<int>(random() % 4000);
+        tree.insert(key);
+        expected.insert(key);
+    }
+
+    // Interleave erasures and insertions, so that nodes are merged and split again
+    for(int i = 0; i < 20000; ++i) {
+        int key = static_cast<int>(random() % 4000);
+
+        if(random() % 3 == 0)
+            REQUIRE(tree.insert(key) == expected.insert(key).second);
+        else
+            REQUIRE(tree.erase(key) == (expected.erase(key) > 0));
+
+        REQUIRE(tree.size() == expected.size());
+    }
+
+    CHECK(contentsOf(tree) == std::vector<int>(expected.begin(), expected.end()));
+
+    // Erase everything
+    for(int key : std::vector<int>(expected.begin(), expected.end()))
+        REQUIRE(tree.erase(key));
+
+    CHECK(tree.empty());
+    CHECK(tree.height() == 0);
+    CHECK(tree.beginIterator() == tree.endIterator());
+}
+
+TEST_CASE("BPlusTree::lowerBound() starts range scans", "[bplustree]")
+{
+    SmallNodeSet tree;
+
+    for(int i = 0; i < 1000; i += 2)
+        tree.insert(i);
+
+    SECTION("From a key in the tree") {
+        auto it = tree.lowerBound(100);
+        REQUIRE(it != tree.endIterator());
+        CHECK(*it == 100);
+    }
+    SECTION("From a key between two keys") {
+        auto it = tree.lowerBound(101);
+        REQUIRE(it != tree.endIterator());
+        CHECK(*it == 102);
+    }
+    SECTION("Across leaves") {
+        int expected = 100;
+        for(auto it = tree.lowerBound(99); it != tree.endIterator() && *it < 500; ++it, expected += 2)
+            REQUIRE(*it == expected);
+        CHECK(expected == 500);
+    }
+    SECTION("From a key after the last one") {
+        CHECK(tree.lowerBound(999) == tree.endIterator());
+    }
+    SECTION("From a key before the first one") {
+        CHECK(*tree.lowerBound(-10) == 0);
+    }
+}
+
+TEST_CASE("BPlusTree can be used as a map", "[bplustree]")
+{
+    BPlusTree<int, std::string, 128> tree;
+    std::map<int, std::string> expected;
+
+    for(int i = 0; i < 2000; ++i) {
+        int key = (i * 7919) % 2000;
+        tree.insert(key, std::to_string(key * 2));
+        expected[key] = std::to_string(key * 2);
+    }
+
+    // An existing key keeps its value
+    CHECK_FALSE(tree.insert(5, "other"));
+    CHECK(*tree.find(5) == "10");
+
+    for(int i = 0; i < 2000; i += 3) {
+        tree.erase(i);
+        expected.erase(i);
+    }
+
+    CHECK(tree.find(3) == nullptr);
+    CHECK(*tree.find(4) == "8");
+
+    *tree.find(4) = "changed";
+    expected[4] = "changed";
+
+    auto expectedIt = expected.begin();
+    for(auto it = tree.beginIterator(); it != tree.endIterator(); ++it, ++expectedIt) {
+        REQUIRE(expectedIt != expected.end());
+        CHECK(*it == expectedIt->first);
+        CHECK(it.mapped() == expectedIt->second);
+    }
+
+    CHECK(expectedIt == expected.end());
+}
+
+TEST_CASE("BPlusTree can be copied and moved", "[bplustree]")
+{
+    SmallNodeSet tree;
+
+    for(int i = 0; i < 500; ++i)
+        tree.insert(i * 3);
+
+    SmallNodeSet copy(tree);
+    CHECK(contentsOf(copy) == contentsOf(tree));
+
+    copy.erase(3);
+    CHECK(tree.contains(3));
+
+    SmallNodeSet moved(std::move(copy));
+    CHECK(moved.size() == 499);
+    CHECK(copy.empty());
+
+    tree = moved;
+    CHECK(contentsOf(tree) == contentsOf(moved));
+
+    tree = SmallNodeSet();
+    CHECK(tree.empty());
+}
@@ -0,0 +1,463 @@
+#include "catch2/catch_all.hpp"
+#include "containers/BalancedTreeNodeOperations.h"
+#include "containers/Tree.h"
+
+#include <bit>
+#include <cmath>
+#include <random>
+#include <set>
+#include <vector>
+
+using BalancedOperationTypes = std::tuple<
+	AvlNodeOperations<int>,
+	RedBlackNodeOperations<int>,
+	TreapNodeOperations<int>
+>;
+
+using NodeType = TreeNode<int>;
+
+static size_t height(const NodeType* node)
+{
+	return node ? 1 + std::max(height(node->left), height(node->right)) : 0;
+}
+
+static void collect(const NodeType* node, std::vector<int>& values)
+{
+	if(node) {
+		collect(node->left, values);
+		values.push_back(node->data);
+		collect(node->right, values);
+	}
+}
+
+// Returns the height of the subtree, or -1 if it is not an AVL tree
+static int checkAvl(const NodeType* node)
+{
+	if( ! node )
+		return 0;
+
+	int left = checkAvl(node->left);
+	int right = checkAvl(node->right);
+
+	if(left < 0 || right < 0 || std::abs(left - right) > 1 || node->balance != unsigned(1 + std::max(left, right)))
+		return -1;
+
+	return 1 + std::max(left, right);
+}
+
+// Returns the black height of the subtree, or -1 if it is not a left-leaning red-black tree
+static int checkRedBlack(const NodeType* node)
+{
+	using Operations = RedBlackNodeOperations<int>;
+
+	if( ! node )
+		return 1;
+
+	bool redLeft = node->left && node->left->balance == Operations::Red;
+	bool redRight = node->right && node->right->balance == Operations::Red;
+
+	if(redRight || (node->balance == Operations::Red && redLeft))
+		return -1;
+
+	int left = checkRedBlack(node->left);
+	int right = checkRedBlack(node->right);
+
+	if(left < 0 || left != right)
+		return -1;
+
+	return left + (node->balance == Operations::Black ? 1 : 0);
+}
+
+static bool checkHeap(const NodeType* node)
+{
+	if( ! node )
+		return true;
+
+	return
+		( ! node->left || node->left->balance <= node->balance) &&
+		( ! node->right || node->right->balance <= node->balance) &&
+		checkHeap(node->left) &&
+		checkHeap(node->right);
+}
+
+template <typename Operations>
+static bool checkBalance(const NodeType* root)
+{
+	if constexpr (std::is_same_v<Operations, AvlNodeOperations<int>>)
+		return checkAvl(root) >= 0;
+	else if constexpr (std::is_same_v<Operations, RedBlackNodeOperations<int>>)
+		return checkRedBlack(root) >= 0 && ( ! root || root->balance == Operations::Black);
+	else
+		return checkHeap(root);
+}
+
+TEMPLATE_LIST_TEST_CASE(
+	"Balanced NodeOperations keep the tree shallow for sorted input",
+	"[tree]",
+	BalancedOperationTypes)
+{
+	const int count = 10000;
+	std::vector<NodeType> nodes(count);
+	NodeType* root = nullptr;
+
+	SECTION("Ascending") {
+		for(int i = 0; i < count; ++i) {
+			nodes[i].data = i;
+			TestType::insert(root, nodes[i]);
+		}
+	}
+	SECTION("Descending") {
+		for(int i = 0; i < count; ++i) {
+			nodes[i].data = count - i;
+			TestType::insert(root, nodes[i]);
+		}
+	}
+
+	CHECK(checkBalance<TestType>(root));
+
+	// At most 2 log2(n) for red-black trees. The expected height of a treap
+	// is about 3 log2(n) and it is much higher only with a tiny probability.
+	double maxHeight = (std::is_same_v<TestType, TreapNodeOperations<int>> ? 4 : 2) * std::log2(count + 1);
+	CHECK(height(root) <= maxHeight);
+
+	std::vector<int> values;
+	collect(root, values);
+	CHECK(values.size() == count);
+	CHECK(std::is_sorted(values.begin(), values.end()));
+}
+
+TEMPLATE_LIST_TEST_CASE(
+	"Balanced NodeOperations insert and extract like a multiset",
+	"[tree]",
+	BalancedOperationTypes)
+{
+	const int count = 2000;
+	std::vector<NodeType> nodes(count);
+	NodeType* root = nullptr;
+	std::multiset<int> expected;
+	std::mt19937 random(42);
+
+	// Small values, so that there are many duplicates
+	for(int i = 0; i < count; ++i) {
+		nodes[i].data = static_cast<int>(random() % 500);
+		TestType::insert(root, nodes[i]);
+		expected.insert(nodes[i].data);
+	}
+
+	REQUIRE(checkBalance<TestType>(root));
+
+	for(int i = 0; i < 3000; ++i) {
+		int value = static_cast<int>(random() % 600);
+		NodeType* extracted = TestType::extract(root, value);
+
+		if(expected.count(value)) {
+			REQUIRE(extracted != nullptr);
+			CHECK(extracted->data == value);
+			CHECK(extracted->isLeaf());
+			expected.erase(expected.find(value));
+		}
+		else {
+			CHECK(extracted == nullptr);
+		}
+
+		CHECK((TestType::findPointerTo(value, root) != nullptr) == (expected.count(value) > 0));
+		REQUIRE(checkBalance<TestType>(root));
+	}
+
+	std::vector<int> values;
+	collect(root, values);
+	CHECK(values == std::vector<int>(expected.begin(), expected.end()));
+}
+
+TEMPLATE_LIST_TEST_CASE(
+	"Balanced NodeOperations extract everything from a tree",
+	"[tree]",
+	BalancedOperationTypes)
+{
+	const int count = 1000;
+	std::vector<NodeType> nodes(count);
+	NodeType* root = nullptr;
+
+	for(int i = 0; i < count; ++i) {
+		nodes[i].data = i;
+		TestType::insert(root, nodes[i]);
+	}
+
+	for(int i = 0; i < count; ++i) {
+		int value = (i * 7919) % count; // Every value exactly once, in a scrambled order
+		REQUIRE(TestType::extract(root, value) == &nodes[value]);
+		REQUIRE(checkBalance<TestType>(root));
+	}
+
+	CHECK(root == nullptr);
+	CHECK(TestType::extract(root, 0) == nullptr);
+}
+
+TEMPLATE_LIST_TEST_CASE(
+	"Balanced NodeOperations::clone() preserves the balance information",
+	"[tree]",
+	BalancedOperationTypes)
+{
+	const int count = 100;
+	std::vector<NodeType> nodes(count);
+	NodeType* root = nullptr;
+
+	for(int i = 0; i < count; ++i) {
+		nodes[i].data = i;
+		TestType::insert(root, nodes[i]);
+	}
+
+	DebugAllocator<NodeType> allocator;
+	NodeType* copy = TestType::clone(root, allocator);
+
+	CHECK(TestType::sameTrees(root, copy));
+	CHECK(checkBalance<TestType>(copy));
+
+	// Inserting into the copy keeps it balanced
+	NodeType* node = allocator.buy(count);
+	TestType::insert(copy, *node);
+	CHECK(checkBalance<TestType>(copy));
+
+	TestType::release(copy, allocator);
+	CHECK(allocator.activeAllocationsCount() == 0);
+}
+
+TEMPLATE_LIST_TEST_CASE(
+	"BinarySearchTree works with balanced NodeOperations",
+	"[tree]",
+	BalancedOperationTypes)
+{
+	BinarySearchTree<int, DebugNodeAllocator<int>, TestType> bst;
+
+	for(int i = 0; i < 1000; ++i)
+		bst.insert(i);
+
+	CHECK(bst.size() == 1000);
+
+	int expected = 0;
+	for(auto it = bst.beginIterator(); it != bst.endIterator(); ++it)
+		CHECK(*it == expected++);
+
+	for(int i = 0; i < 1000; i += 2)
+		bst.erase(i);
+
+	CHECK(bst.size() == 500);
+	CHECK(bst.allocator().activeAllocationsCount() == 500);
+	CHECK(bst.contains(1));
+	CHECK_FALSE(bst.contains(2));
+
+	auto copy = bst;
+	CHECK(copy == bst);
+
+	bst.clear();
+	CHECK(bst.allocator().activeAllocationsCount() == 0);
+}
+
+using ParentNodeType = ParentTreeNode<int>;
+
+using ParentOperationTypes = std::tuple<
+	RecursiveNodeOperations<int, ParentNodeType>,
+	IterativeNodeOperations<int, ParentNodeType>,
+	AvlNodeOperations<int, ParentNodeType>,
+	RedBlackNodeOperations<int, ParentNodeType>,
+	TreapNodeOperations<int, ParentNodeType>
+>;
+
+static bool checkParents(const ParentNodeType* node, const ParentNodeType* parent)
+{
+	if( ! node )
+		return true;
+
+	return node->parent == parent && checkParents(node->left, node) && checkParents(node->right, node);
+}
+
+TEMPLATE_LIST_TEST_CASE(
+	"NodeOperations keep the parent pointers of ParentTreeNode up to date",
+	"[tree]",
+	ParentOperationTypes)
+{
+	// One node per value, so that the unbalanced operations never see duplicates
+	const int count = 1000;
+	std::vector<ParentNodeType> nodes(count);
+	std::vector<bool> inTree(count, false);
+	ParentNodeType* root = nullptr;
+	std::mt19937 random(42);
+
+	for(int i = 0; i < count; ++i)
+		nodes[i].data = i;
+
+	for(int i = 0; i < 20000; ++i) {
+		int value = static_cast<int>(random() % count);
+
+		if(inTree[value]) {
+			ParentNodeType* extracted = TestType::extract(root, value);
+			REQUIRE(extracted == &nodes[value]);
+			CHECK(extracted->parent == nullptr);
+		}
+		else {
+			TestType::insert(root, nodes[value]);
+		}
+
+		inTree[value] = ! inTree[value];
+		REQUIRE(checkParents(root, nullptr));
+	}
+
+	if constexpr ( ! std::is_same_v<TestType, IterativeNodeOperations<int, ParentNodeType>> ) {
+		DebugAllocator<ParentNodeType> allocator;
+		ParentNodeType* copy = TestType::clone(root, allocator);
+
+		CHECK(TestType::sameTrees(root, copy));
+		CHECK(checkParents(copy, nullptr));
+
+		TestType::release(copy, allocator);
+	}
+}
+
+TEST_CASE("TreeNode without a parent pointer is not larger", "[tree]")
+{
+	struct PlainNode {
+		int data;
+		unsigned balance;
+		void* left;
+		void* right;
+	};
+
+	CHECK(sizeof(TreeNode<int>) == sizeof(PlainNode));
+	CHECK(sizeof(ParentTreeNode<int>) == sizeof(PlainNode) + sizeof(void*));
+}
+
+using LinkedSizedNodeType = TreeNode<int, true, true>;
+
+using SizedOperationTypes = std::tuple<
+	RecursiveNodeOperations<int, LinkedSizedNodeType>,
+	IterativeNodeOperations<int, LinkedSizedNodeType>,
+	AvlNodeOperations<int, LinkedSizedNodeType>,
+	RedBlackNodeOperations<int, LinkedSizedNodeType>,
+	TreapNodeOperations<int, LinkedSizedNodeType>
+>;
+
+// Returns the size of the subtree, or -1 if a node has a wrong size or parent
+static int checkSizesAndParents(const LinkedSizedNodeType* node, const LinkedSizedNodeType* parent)
+{
+	if( ! node )
+		return 0;
+
+	int left = checkSizesAndParents(node->left, node);
+	int right = checkSizesAndParents(node->right, node);
+
+	if(left < 0 || right < 0 || node->parent != parent || node->subtreeSize != size_t(1 + left + right))
+		return -1;
+
+	return 1 + left + right;
+}
+
+TEMPLATE_LIST_TEST_CASE(
+	"NodeOperations keep the subtree sizes up to date",
+	"[tree]",
+	SizedOperationTypes)
+{
+	const int count = 1000;
+	std::vector<LinkedSizedNodeType> nodes(count);
+	std::vector<bool> inTree(count, false);
+	LinkedSizedNodeType* root = nullptr;
+	int size = 0;
+	std::mt19937 random(7);
+
+	for(int i = 0; i < count; ++i)
+		nodes[i].data = i;
+
+	for(int i = 0; i < 20000; ++i) {
+		int value = static_cast<int>(random() % count);
+
+		if(inTree[value]) {
+			REQUIRE(TestType::extract(root, value) == &nodes[value]);
+			--size;
+		}
+		else {
+			TestType::insert(root, nodes[value]);
+			++size;
+		}
+
+		inTree[value] = ! inTree[value];
+		REQUIRE(checkSizesAndParents(root, nullptr) == size);
+	}
+
+	if constexpr ( ! std::is_same_v<TestType, IterativeNodeOperations<int, LinkedSizedNodeType>> ) {
+		DebugAllocator<LinkedSizedNodeType> allocator;
+		LinkedSizedNodeType* copy = TestType::clone(root, allocator);
+
+		CHECK(checkSizesAndParents(copy, nullptr) == size);
+
+		TestType::release(copy, allocator);
+	}
+}
+
+TEMPLATE_LIST_TEST_CASE(
+	"Balanced NodeOperations::buildBalanced() builds a valid and shallow tree",
+	"[tree]",
+	BalancedOperationTypes)
+{
+	for(int count = 0; count <= 300; ++count) {
+		std::vector<NodeType> nodes(count);
+		NodeType* list = nullptr;
+
+		// Link the nodes in ascending order
+		for(int i = count - 1; i >= 0; --i) {
+			nodes[i].data = i;
+			nodes[i].right = list;
+			list = &nodes[i];
+		}
+
+		NodeType* root = TestType::buildBalanced(list, count);
+
+		REQUIRE(checkBalance<TestType>(root));
+		REQUIRE(height(root) == std::bit_width(unsigned(count)));
+
+		std::vector<int> values;
+		collect(root, values);
+		REQUIRE(values.size() == size_t(count));
+		REQUIRE(std::is_sorted(values.begin(), values.end()));
+
+		// The operations can continue with the tree
+		for(int i = 0; i < count; i += 3) {
+			REQUIRE(TestType::extract(root, i) == &nodes[i]);
+			REQUIRE(checkBalance<TestType>(root));
+		}
+		for(int i = 0; i < count; i += 3) {
+			TestType::insert(root, nodes[i]);
+			REQUIRE(checkBalance<TestType>(root));
+		}
+	}
+}
+
+TEMPLATE_LIST_TEST_CASE(
+	"flattenTree() and buildBalanced() keep the subtree sizes and parent pointers up to date",
+	"[tree]",
+	SizedOperationTypes)
+{
+	const int count = 500;
+	std::vector<LinkedSizedNodeType> nodes(count);
+	LinkedSizedNodeType* root = nullptr;
+
+	for(int i = 0; i < count; ++i) {
+		nodes[i].data = (i * 7919) % count;
+		TestType::insert(root, nodes[i]);
+	}
+
+	LinkedSizedNodeType* list = flattenTree(root);
+
+	size_t length = 0;
+	for(const LinkedSizedNodeType* node = list; node; node = node->right, ++length) {
+		REQUIRE(node->left == nullptr);
+		REQUIRE(node->data == int(length));
+	}
+	REQUIRE(length == count);
+
+	root = TestType::buildBalanced(list, count);
+	CHECK(checkSizesAndParents(root, nullptr) == count);
+
+	for(int i = 0; i < count; i += 2)
+		REQUIRE(TestType::extract(root, i) != nullptr);
+
+	CHECK(checkSizesAndParents(root, nullptr) == count / 2);
+}
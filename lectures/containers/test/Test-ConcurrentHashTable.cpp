@@ -0,0 +1,149 @@
+#include "catch2/catch_all.hpp"
+
+#include "containers/ConcurrentHashTable.h"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("ConcurrentHashSet::ConcurrentHashSet() creates an empty set", "[hash][concurrent]")
+{
+    ConcurrentHashSet<int> set;
+    CHECK(set.size() == 0);
+    CHECK_FALSE(set.contains(0));
+}
+
+TEST_CASE("ConcurrentHashSet supports insert(), contains() and erase()", "[hash][concurrent]")
+{
+    ConcurrentHashSet<int> set;
+
+    for(int i = 0; i < 1'000; ++i)
+        CHECK(set.insert(i));
+
+    CHECK_FALSE(set.insert(0));
+    CHECK(set.size() == 1'000);
+
+    for(int i = 0; i < 1'000; i += 2)
+        CHECK(set.erase(i) == 1);
+
+    CHECK(set.erase(0) == 0);
+    CHECK(set.size() == 500);
+
+    for(int i = 0; i < 1'000; ++i)
+        CHECK(set.contains(i) == (i % 2 != 0));
+
+    set.clear();
+    CHECK(set.size() == 0);
+}
+
+TEST_CASE("ConcurrentHashSet can be filled from several threads at once", "[hash][concurrent]")
+{
+    const int threadsCount = 8;
+    const int perThread = 10'000;
+
+    ConcurrentHashSet<int> set;
+    set.reserve(threadsCount * perThread);
+
+    std::vector<std::thread> threads;
+
+    for(int t = 0; t < threadsCount; ++t) {
+        threads.emplace_back([&set, t]() {
+            for(int i = 0; i < perThread; ++i)
+                set.insert(t * perThread + i);
+        });
+    }
+
+    for(std::thread& thread : threads)
+        thread.join();
+
+    CHECK(set.size() == threadsCount * perThread);
+
+    for(int i = 0; i < threadsCount * perThread; ++i)
+        REQUIRE(set.contains(i));
+}
+
+TEST_CASE("ConcurrentHashSet readers see all elements inserted before they started, while writers are active", "[hash][concurrent]")
+{
+    const int count = 10'000;
+    ConcurrentHashSet<int> set;
+
+    for(int i = 0; i < count; ++i)
+        set.insert(i);
+
+    std::atomic<int> missing = 0;
+    std::vector<std::thread> threads;
+
+    // Writers add and remove other elements
+    for(int t = 0; t < 2; ++t) {
+        threads.emplace_back([&set, t]() {
+            for(int i = 0; i < count; ++i) {
+                int value = count * (t + 1) + i;
+                set.insert(value);
+                set.erase(value);
+            }
+        });
+    }
+
+    // Readers look up the initial elements
+    for(int t = 0; t < 4; ++t) {
+        threads.emplace_back([&set, &missing]() {
+            for(int i = 0; i < count; ++i) {
+                if( ! set.contains(i) )
+                    ++missing;
+            }
+        });
+    }
+
+    for(std::thread& thread : threads)
+        thread.join();
+
+    CHECK(missing == 0);
+    CHECK(set.size() == count);
+}
+
+TEST_CASE("ConcurrentHashMap associates keys with values", "[hash][concurrent]")
+{
+    ConcurrentHashMap<std::string, int> map;
+
+    CHECK(map.insert({"one", 1}));
+    CHECK_FALSE(map.insert({"one", 100}));
+    CHECK(map.get("one") == 1);
+
+    map.insert_or_assign("one", 10);
+    map.insert_or_assign("two", 2);
+    CHECK(map.get("one") == 10);
+    CHECK(map.get("two") == 2);
+    CHECK_FALSE(map.get("three").has_value());
+
+    CHECK(map.visit("two", [](int& value) { value *= 5; }));
+    CHECK_FALSE(map.visit("three", [](int&) {}));
+    CHECK(map.get("two") == 10);
+
+    CHECK(map.erase("one") == 1);
+    CHECK_FALSE(map.contains("one"));
+    CHECK(map.size() == 1);
+}
+
+TEST_CASE("ConcurrentHashMap::visit() updates are not lost when called from several threads", "[hash][concurrent]")
+{
+    const int threadsCount = 8;
+    const int increments = 10'000;
+
+    ConcurrentHashMap<int, int> map;
+    map.insert({0, 0});
+
+    std::vector<std::thread> threads;
+
+    for(int t = 0; t < threadsCount; ++t) {
+        threads.emplace_back([&map]() {
+            for(int i = 0; i < increments; ++i)
+                map.visit(0, [](int& value) { ++value; });
+        });
+    }
+
+    for(std::thread& thread : threads)
+        thread.join();
+
+    CHECK(map.get(0) == threadsCount * increments);
+}
@@ -0,0 +1,144 @@
+#include "catch2/catch_all.hpp"
+
+#include "containers/HashFunctions.h"
+#include "containers/HashTable.h"
+
+#include <algorithm>
+#include <bit>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace {
+
+/// Number of distinct buckets, which the keys occupy in a table with bucketsCount buckets
+template <typename HashFunction>
+size_t usedBuckets(const std::vector<uint64_t>& keys, size_t bucketsCount, HashFunction hash)
+{
+    std::vector<bool> used(bucketsCount);
+
+    for(uint64_t key : keys)
+        used[hash(key) & (bucketsCount - 1)] = true;
+
+    return std::count(used.begin(), used.end(), true);
+}
+
+} // namespace
+
+TEST_CASE("multiply128() calculates the full product", "[hash][functions]")
+{
+    uint64_t low, high;
+
+    multiply128(0xFFFFFFFFFFFFFFFFULL, 0xFFFFFFFFFFFFFFFFULL, low, high);
+    CHECK(low == 1);
+    CHECK(high == 0xFFFFFFFFFFFFFFFEULL);
+
+    multiply128(1ULL << 63, 4, low, high);
+    CHECK(low == 0);
+    CHECK(high == 2);
+}
+
+TEST_CASE("reduceToRange() returns values in [0, range)", "[hash][functions]")
+{
+    CHECK(reduceToRange(0, 10) == 0);
+    CHECK(reduceToRange(~uint64_t(0), 10) == 9);
+    CHECK(reduceToRange(uint64_t(1) << 63, 10) == 5);
+}
+
+TEST_CASE("FibonacciHash and SeededHash spread strided keys over all buckets", "[hash][functions]")
+{
+    const size_t bucketsCount = 1024;
+    std::vector<uint64_t> keys;
+
+    for(uint64_t i = 0; i < bucketsCount; ++i)
+        keys.push_back(i * 1024);
+
+    // The identity puts all keys in bucket 0
+    CHECK(usedBuckets(keys, bucketsCount, std::hash<uint64_t>()) < 2);
+
+    // A random function would leave about 1/e of the buckets empty
+    CHECK(usedBuckets(keys, bucketsCount, FibonacciHash()) > bucketsCount / 2);
+    CHECK(usedBuckets(keys, bucketsCount, SeededHash()) > bucketsCount / 2);
+}
+
+TEST_CASE("hashBytes() depends on every byte and on the length", "[hash][functions]")
+{
+    std::string data(200, 'x');
+    std::set<uint64_t> hashes;
+    size_t expected = 0;
+
+    // All prefixes, which covers the paths for short, medium and long inputs
+    for(size_t length = 0; length <= data.size(); ++length, ++expected)
+        hashes.insert(hashBytes(data.data(), length));
+
+    // Changing a single byte of a long string
+    for(size_t i = 0; i < data.size(); ++i, ++expected) {
+        std::string changed = data;
+        changed[i] = 'y';
+        hashes.insert(hashBytes(changed.data(), changed.size()));
+    }
+
+    CHECK(hashes.size() == expected);
+}
+
+TEST_CASE("hashBytes() gives different functions for different seeds", "[hash][functions]")
+{
+    std::string_view str = "The quick brown fox";
+
+    CHECK(hashBytes(str.data(), str.size(), 1) == hashBytes(str.data(), str.size(), 1));
+    CHECK(hashBytes(str.data(), str.size(), 1) != hashBytes(str.data(), str.size(), 2));
+}
+
+TEST_CASE("SeededHash uses the process seed by default", "[hash][functions]")
+{
+    SeededHash first, second;
+    SeededHash other(first.seed() + 1);
+
+    CHECK(first.seed() == processHashSeed());
+    CHECK(first(12345) == second(12345));
+    CHECK(first(12345) != other(12345));
+    CHECK(first("abc") == second(std::string("abc")));
+}
+
+TEST_CASE("WyHash is transparent", "[hash][functions]")
+{
+    WyHash hash;
+    std::string str = "abc";
+
+    CHECK(hash(str) == hash(std::string_view("abc")));
+    CHECK(hash(str) == hash("abc"));
+}
+
+using HashFunctionTables = std::tuple<
+    SeparateChainingHash<int, FibonacciHash>,
+    SeparateChainingHash<int, SeededHash>,
+    SwissTableHash<int, FibonacciHash>,
+    RobinHoodHash<int, SeededHash>
+>;
+
+TEMPLATE_LIST_TEST_CASE("The hash tables work with the hash functions from HashFunctions.h", "[hash][functions]", HashFunctionTables)
+{
+    TestType table;
+
+    for(int i = 0; i < 10'000; ++i)
+        table.insert(i * 1024);
+
+    CHECK(table.size() == 10'000);
+
+    for(int i = 0; i < 10'000; ++i) {
+        REQUIRE(table.contains(i * 1024));
+        REQUIRE_FALSE(table.contains(i * 1024 + 1));
+    }
+}
+
+TEST_CASE("SeparateChainingHash of strings can be searched by string_view with WyHash", "[hash][functions]")
+{
+    SeparateChainingHash<std::string, WyHash> table;
+
+    table.insert("alpha");
+    table.insert("beta");
+
+    CHECK(table.contains(std::string_view("alpha")));
+    CHECK(table.contains("beta"));
+    CHECK_FALSE(table.contains("gamma"));
+}
@@ -1,11 +1,22 @@
 #include "catch2/catch_all.hpp"
 
 #include "containers/HashTable.h"
+#include "utils/CountingAllocator.h"
+
+#include <algorithm>
+#include <bit>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
 
 using HashTypes = std::tuple<
 	VectorOfUnorderedElements<int>,
 	VectorWithBinarySearch<int>,
-    SeparateChainingHash<int>
+    SeparateChainingHash<int>,
+    SwissTableHash<int>,
+    RobinHoodHash<int>
 >;
 
 
@@ -61,4 +72,569 @@ TEMPLATE_LIST_TEST_CASE(
         hash.insert(i);
         CHECK(hash.size() == i);
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE("SeparateChainingHash::insert() does not store duplicate values", "[hash]")
+{
+    SeparateChainingHash<int> hash;
+
+    CHECK(hash.insert(42).second);
+    CHECK_FALSE(hash.insert(42).second);
+    CHECK(hash.size() == 1);
+    CHECK(*hash.insert(42).first == 42);
+}
+
+TEST_CASE("SeparateChainingHash::find() returns an iterator to the element or end()", "[hash]")
+{
+    SeparateChainingHash<int> hash;
+
+    for(int i = 0; i < 100; ++i)
+        hash.insert(i);
+
+    for(int i = 0; i < 100; ++i) {
+        auto it = hash.find(i);
+        REQUIRE(it != hash.end());
+        CHECK(*it == i);
+    }
+
+    CHECK(hash.find(100) == hash.end());
+    CHECK(hash.find(-1) == hash.end());
+}
+
+TEST_CASE("SeparateChainingHash iterators visit each element exactly once", "[hash]")
+{
+    const int count = 1'000;
+    SeparateChainingHash<int> hash;
+
+    SECTION("An empty hash has begin() == end()") {
+        CHECK(hash.begin() == hash.end());
+    }
+    SECTION("A non-empty hash") {
+        for(int i = 0; i < count; ++i)
+            hash.insert(i);
+
+        std::vector<int> visited(hash.begin(), hash.end());
+        std::sort(visited.begin(), visited.end());
+
+        REQUIRE(visited.size() == count);
+
+        for(int i = 0; i < count; ++i)
+            CHECK(visited[i] == i);
+    }
+}
+
+TEST_CASE("SeparateChainingHash::erase() removes only the requested element", "[hash]")
+{
+    const int count = 1'000;
+    SeparateChainingHash<int> hash;
+
+    for(int i = 0; i < count; ++i)
+        hash.insert(i);
+
+    SECTION("Erasing a missing element has no effect") {
+        CHECK(hash.erase(count) == 0);
+        CHECK(hash.size() == count);
+    }
+    SECTION("Erasing by key") {
+        for(int i = 0; i < count; i += 2)
+            CHECK(hash.erase(i) == 1);
+
+        CHECK(hash.size() == count / 2);
+
+        for(int i = 0; i < count; ++i)
+            CHECK(hash.contains(i) == (i % 2 != 0));
+    }
+    SECTION("Erasing by iterator while iterating") {
+        for(auto it = hash.begin(); it != hash.end(); ) {
+            if(*it % 2 == 0)
+                it = hash.erase(it);
+            else
+                ++it;
+        }
+
+        CHECK(hash.size() == count / 2);
+
+        for(int i = 0; i < count; ++i)
+            CHECK(hash.contains(i) == (i % 2 != 0));
+    }
+    SECTION("Clearing the hash") {
+        hash.clear();
+
+        CHECK(hash.empty());
+        CHECK(hash.begin() == hash.end());
+        CHECK_FALSE(hash.contains(0));
+    }
+}
+
+TEST_CASE("SeparateChainingHash::reserve() allocates enough buckets up front", "[hash]")
+{
+    const int count = 10'000;
+    SeparateChainingHash<int> hash;
+
+    hash.reserve(count);
+    size_t buckets = hash.bucket_count();
+
+    CHECK(buckets * hash.max_load_factor() >= count);
+
+    for(int i = 0; i < count; ++i)
+        hash.insert(i);
+
+    CHECK(hash.bucket_count() == buckets); // No rehashing happened during the insertions
+    CHECK(hash.load_factor() <= hash.max_load_factor());
+}
+
+TEST_CASE("SeparateChainingHash::rehash() keeps all elements and does not copy them", "[hash]")
+{
+    const int count = 1'000;
+    SeparateChainingHash<int> hash;
+
+    for(int i = 0; i < count; ++i)
+        hash.insert(i);
+
+    std::vector<const int*> addresses;
+
+    for(int i = 0; i < count; ++i)
+        addresses.push_back(&*hash.find(i));
+
+    SECTION("Explicit rehash") {
+        hash.rehash(hash.bucket_count() * 4);
+    }
+    SECTION("Rehash caused by lowering the maximum load factor") {
+        hash.max_load_factor(0.25);
+        CHECK(hash.load_factor() <= 0.25);
+    }
+    SECTION("Rehash caused by insertions") {
+        for(int i = count; i < 10 * count; ++i)
+            hash.insert(i);
+    }
+
+    for(int i = 0; i < count; ++i) {
+        REQUIRE(hash.contains(i));
+        CHECK(&*hash.find(i) == addresses[i]);
+    }
+}
+
+TEST_CASE("SeparateChainingHash::rehash() never reduces the number of buckets", "[hash]")
+{
+    SeparateChainingHash<int> hash(100);
+    size_t buckets = hash.bucket_count();
+
+    CHECK(buckets >= 100);
+
+    hash.rehash(10);
+    CHECK(hash.bucket_count() == buckets);
+}
+
+TEST_CASE("SeparateChainingHash uses a power of two number of buckets", "[hash]")
+{
+    SeparateChainingHash<int> hash(100);
+    CHECK(std::has_single_bit(hash.bucket_count()));
+
+    hash.reserve(1'000);
+    CHECK(std::has_single_bit(hash.bucket_count()));
+
+    hash.rehash(5'000);
+    CHECK(std::has_single_bit(hash.bucket_count()));
+    CHECK(hash.bucket_count() >= 5'000);
+}
+
+template <typename Hash>
+static size_t longestBucket(const Hash& hash)
+{
+    size_t result = 0;
+
+    for(size_t i = 0; i < hash.bucket_count(); ++i)
+        result = std::max(result, hash.bucket_size(i));
+
+    return result;
+}
+
+template <typename Hash>
+static size_t usedBuckets(const Hash& hash)
+{
+    size_t result = 0;
+
+    for(size_t i = 0; i < hash.bucket_count(); ++i)
+        result += hash.bucket_size(i) > 0;
+
+    return result;
+}
+
+TEST_CASE("SeparateChainingHash::rehash() with a count, which is not a power of two, uses all buckets", "[hash]")
+{
+    SeparateChainingHash<int> hash;
+    hash.max_load_factor(100);
+    hash.rehash(1'000);
+
+    REQUIRE(std::has_single_bit(hash.bucket_count()));
+    size_t buckets = hash.bucket_count();
+
+    // Far more keys than buckets, so each bucket gets some, unless the index misses some of them
+    for(int i = 0; i < 50'000; ++i)
+        hash.insert(i);
+
+    REQUIRE(hash.bucket_count() == buckets);
+    CHECK(usedBuckets(hash) == buckets);
+}
+
+TEST_CASE("SeparateChainingHash spreads strided integer keys over the buckets", "[hash]")
+{
+    for(int stride : { 1024, 4096, 65536 }) {
+        SeparateChainingHash<long long> hash;
+
+        for(long long i = 0; i < 10'000; ++i)
+            hash.insert(i * stride);
+
+        REQUIRE(hash.size() == 10'000);
+
+        // With the identity std::hash and a plain mask, all keys would share a few buckets
+        CHECK(usedBuckets(hash) > hash.size() / 2);
+        CHECK(longestBucket(hash) < 16);
+    }
+}
+
+TEST_CASE("SeparateChainingHashMap associates keys with values", "[hash]")
+{
+    SeparateChainingHashMap<std::string, int> map;
+
+    map["one"] = 1;
+    map["two"] = 2;
+    map.insert({"three", 3});
+
+    CHECK(map.size() == 3);
+    CHECK(map.at("one") == 1);
+    CHECK(map.at("two") == 2);
+    CHECK(map["three"] == 3);
+    CHECK(map.size() == 3);
+
+    SECTION("operator[] inserts a default value for a missing key") {
+        CHECK(map["four"] == 0);
+        CHECK(map.size() == 4);
+    }
+    SECTION("at() throws for a missing key") {
+        CHECK_THROWS_AS(map.at("four"), std::out_of_range);
+    }
+    SECTION("insert() does not overwrite an existing value") {
+        CHECK_FALSE(map.insert({"one", 100}).second);
+        CHECK(map.at("one") == 1);
+    }
+    SECTION("Values can be modified through iterators") {
+        for(auto& item : map)
+            item.second *= 10;
+
+        CHECK(map.at("one") == 10);
+        CHECK(map.at("two") == 20);
+        CHECK(map.at("three") == 30);
+    }
+    SECTION("erase() removes a key and its value") {
+        CHECK(map.erase("two") == 1);
+        CHECK_FALSE(map.contains("two"));
+        CHECK(map.find("two") == map.end());
+        CHECK(map.size() == 2);
+    }
+}
+
+TEST_CASE("SwissTableHash::insert() does not store duplicate values", "[hash]")
+{
+    SwissTableHash<int> hash;
+
+    for(int i = 0; i < 3; ++i) {
+        hash.insert(42);
+        CHECK(hash.size() == 1);
+    }
+
+    CHECK(hash.contains(42));
+}
+
+TEST_CASE("SwissTableHash grows and keeps all elements when many values are inserted", "[hash]")
+{
+    const int count = 10'000;
+    SwissTableHash<int> hash;
+
+    for(int i = 0; i < count; ++i)
+        hash.insert(i * 16); // values which share their lower bits
+
+    CHECK(hash.size() == count);
+    CHECK(hash.load_factor() <= hash.max_load_factor());
+
+    for(int i = 0; i < count; ++i) {
+        CHECK(hash.contains(i * 16));
+        CHECK_FALSE(hash.contains(i * 16 + 1));
+    }
+}
+
+TEST_CASE("SwissTableHash works with non-trivial element types", "[hash]")
+{
+    SwissTableHash<std::string> hash;
+    std::vector<std::string> values{"", "a", "hash", "table", "a much longer string, which is not stored inline"};
+
+    for(const std::string& value : values)
+        hash.insert(value);
+
+    CHECK(hash.size() == values.size());
+
+    for(const std::string& value : values)
+        CHECK(hash.contains(value));
+
+    CHECK_FALSE(hash.contains("missing"));
+}
+
+TEST_CASE("RobinHoodHash::insert() does not store duplicate values", "[hash]")
+{
+    RobinHoodHash<int> hash;
+
+    for(int i = 0; i < 3; ++i) {
+        hash.insert(42);
+        CHECK(hash.size() == 1);
+    }
+
+    CHECK(hash.contains(42));
+}
+
+TEST_CASE("RobinHoodHash stores negative values and grows when needed", "[hash]")
+{
+    const int count = 10'000;
+    RobinHoodHash<int> hash;
+
+    for(int i = -count; i < count; ++i)
+        hash.insert(i);
+
+    CHECK(hash.size() == 2 * count);
+    CHECK(hash.load_factor() <= hash.max_load_factor());
+
+    for(int i = -count; i < count; ++i)
+        CHECK(hash.contains(i));
+
+    CHECK_FALSE(hash.contains(count));
+    CHECK_FALSE(hash.contains(-count - 1));
+}
+
+TEST_CASE("RobinHoodHash::erase() removes only the requested element", "[hash]")
+{
+    const int count = 1'000;
+    RobinHoodHash<int> hash;
+
+    for(int i = 0; i < count; ++i)
+        hash.insert(i);
+
+    SECTION("Erasing a missing element has no effect") {
+        CHECK(hash.erase(count) == 0);
+        CHECK(hash.size() == count);
+    }
+    SECTION("Erasing every other element keeps the rest reachable") {
+        for(int i = 0; i < count; i += 2)
+            CHECK(hash.erase(i) == 1);
+
+        CHECK(hash.size() == count / 2);
+
+        for(int i = 0; i < count; ++i)
+            CHECK(hash.contains(i) == (i % 2 != 0));
+    }
+    SECTION("Erased elements can be inserted again") {
+        for(int i = 0; i < count; ++i)
+            hash.erase(i);
+
+        CHECK(hash.size() == 0);
+
+        for(int i = 0; i < count; ++i)
+            hash.insert(i);
+
+        CHECK(hash.size() == count);
+
+        for(int i = 0; i < count; ++i)
+            CHECK(hash.contains(i));
+    }
+}
+
+TEST_CASE("RobinHoodHash::max_probe_length() stays small for clustered keys", "[hash]")
+{
+    const int count = 100'000;
+    RobinHoodHash<int> hash;
+
+    for(int i = 0; i < count; ++i)
+        hash.insert(i * 1024); // all keys share their lower bits
+
+    CHECK(hash.max_probe_length() >= 1);
+    CHECK(hash.max_probe_length() < 64);
+}
+
+TEST_CASE("RobinHoodHash works with non-trivial element types", "[hash]")
+{
+    RobinHoodHash<std::string> hash;
+    std::vector<std::string> values{"", "a", "hash", "table", "a much longer string, which is not stored inline"};
+
+    for(const std::string& value : values)
+        hash.insert(value);
+
+    CHECK(hash.size() == values.size());
+    CHECK(hash.erase("hash") == 1);
+    CHECK_FALSE(hash.contains("hash"));
+
+    for(const std::string& value : values) {
+        if(value != "hash")
+            CHECK(hash.contains(value));
+    }
+}
+
+using HashedLookupTypes = std::tuple<
+    SeparateChainingHash<int>,
+    SwissTableHash<int>,
+    RobinHoodHash<int>
+>;
+
+TEMPLATE_LIST_TEST_CASE(
+	"Hash::contains_hashed() returns the same results as contains()",
+	"[hash]",
+	HashedLookupTypes)
+{
+    TestType hash;
+    auto hashFunction = hash.hash_function();
+
+    for(int i = 0; i < 1'000; i += 2)
+        hash.insert(i);
+
+    for(int i = 0; i < 1'000; ++i)
+        CHECK(hash.contains_hashed(i, hashFunction(i)) == hash.contains(i));
+}
+
+TEMPLATE_LIST_TEST_CASE(
+	"Hash::contains_many() returns the same results as contains()",
+	"[hash]",
+	HashedLookupTypes)
+{
+    TestType hash;
+
+    for(int i = 0; i < 1'000; i += 2)
+        hash.insert(i);
+
+    // Not a multiple of the batch size, so that the last batch is incomplete
+    std::vector<int> keys;
+    for(int i = -5; i < 1'000; ++i)
+        keys.push_back(i);
+
+    std::unique_ptr<bool[]> results(new bool[keys.size()]);
+    hash.contains_many(keys, std::span<bool>(results.get(), keys.size()));
+
+    for(size_t i = 0; i < keys.size(); ++i)
+        CHECK(results[i] == hash.contains(keys[i]));
+}
+
+TEMPLATE_LIST_TEST_CASE(
+	"Hash::contains_many() throws when there is not enough space for the results",
+	"[hash]",
+	HashedLookupTypes)
+{
+    TestType hash;
+    std::vector<int> keys{1, 2, 3};
+    bool results[2];
+
+    CHECK_THROWS_AS(hash.contains_many(keys, results), std::invalid_argument);
+}
+
+TEMPLATE_LIST_TEST_CASE(
+	"Hash::insert_many() inserts all values and skips duplicates",
+	"[hash]",
+	HashedLookupTypes)
+{
+    TestType hash;
+    hash.insert(0);
+
+    std::vector<int> values;
+    for(int i = 0; i < 1'000; ++i)
+        values.push_back(i / 2); // every value appears twice
+
+    CHECK(hash.insert_many(values) == 499);
+    CHECK(hash.size() == 500);
+
+    for(int i = 0; i < 500; ++i)
+        CHECK(hash.contains(i));
+
+    CHECK_FALSE(hash.contains(500));
+}
+
+using HeterogeneousLookupTypes = std::tuple<
+    SeparateChainingHash<std::string, StringHash>,
+    SwissTableHash<std::string, StringHash>,
+    RobinHoodHash<std::string, StringHash>
+>;
+
+TEMPLATE_LIST_TEST_CASE(
+	"Hash::contains() supports heterogeneous lookup with a transparent hasher",
+	"[hash]",
+	HeterogeneousLookupTypes)
+{
+    TestType hash;
+    hash.insert("alpha");
+    hash.insert("beta");
+
+    std::string_view wire = "alpha beta gamma";
+
+    CHECK(hash.contains(wire.substr(0, 5)));
+    CHECK(hash.contains(wire.substr(6, 4)));
+    CHECK_FALSE(hash.contains(wire.substr(11)));
+    CHECK(hash.contains("alpha"));
+    CHECK(hash.contains_hashed(wire.substr(0, 5), StringHash()(wire.substr(0, 5))));
+}
+
+TEST_CASE("SeparateChainingHashMap::find() supports heterogeneous lookup with a transparent hasher", "[hash]")
+{
+    SeparateChainingHashMap<std::string, int, StringHash> map;
+    map["alpha"] = 1;
+
+    std::string_view key = "alpha";
+    auto it = map.find(key);
+
+    REQUIRE(it != map.end());
+    CHECK(it->second == 1);
+    CHECK(map.find(std::string_view("beta")) == map.end());
+}
+
+using CountingHashTypes = std::tuple<
+    SeparateChainingHash<int, std::hash<int>, CountingAllocator<int>>,
+    SwissTableHash<int, std::hash<int>, CountingAllocator<int>>,
+    RobinHoodHash<int, std::hash<int>, CountingAllocator<int>>
+>;
+
+TEMPLATE_LIST_TEST_CASE(
+	"Hash tables allocate all their memory through their allocator",
+	"[hash][allocator]",
+	CountingHashTypes)
+{
+    CountingAllocator<int> allocator;
+    const AllocationCounter& counter = allocator.counter();
+
+    {
+        TestType hash(allocator);
+        size_t initialBytes = counter.liveBytes;
+        CHECK(initialBytes > 0);
+
+        for(int i = 0; i < 10'000; ++i)
+            hash.insert(i);
+
+        // The elements themselves take at least this much
+        CHECK(counter.liveBytes >= initialBytes + 10'000 * sizeof(int));
+        CHECK(counter.peakBytes >= counter.liveBytes);
+        CHECK(hash.get_allocator() == allocator);
+    }
+
+    CHECK(counter.liveBytes == 0);
+    CHECK(counter.liveBlocks == 0);
+    CHECK(counter.allocations > 0);
+}
+
+TEST_CASE("SeparateChainingHash counts one node per element", "[hash][allocator]")
+{
+    SeparateChainingHash<int, std::hash<int>, CountingAllocator<int>> hash;
+    hash.reserve(1'000);
+
+    const AllocationCounter& counter = hash.get_allocator().counter();
+    size_t blocksBefore = counter.liveBlocks;
+
+    for(int i = 0; i < 1'000; ++i)
+        hash.insert(i);
+
+    CHECK(counter.liveBlocks == blocksBefore + 1'000);
+
+    hash.clear();
+    CHECK(counter.liveBlocks == blocksBefore);
+}
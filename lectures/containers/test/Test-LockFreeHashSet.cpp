@@ -0,0 +1,191 @@
+#include "catch2/catch_all.hpp"
+
+#include "containers/LockFreeHashSet.h"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("LockFreeHashSet::LockFreeHashSet() creates an empty set", "[hash][lockfree]")
+{
+    LockFreeHashSet<int> set;
+    CHECK(set.size() == 0);
+    CHECK_FALSE(set.contains(0));
+}
+
+TEST_CASE("LockFreeHashSet supports insert(), contains() and erase()", "[hash][lockfree]")
+{
+    LockFreeHashSet<int> set;
+
+    for(int i = 0; i < 1'000; ++i)
+        CHECK(set.insert(i));
+
+    CHECK_FALSE(set.insert(0));
+    CHECK(set.size() == 1'000);
+
+    for(int i = 0; i < 1'000; i += 2)
+        CHECK(set.erase(i) == 1);
+
+    CHECK(set.erase(0) == 0);
+    CHECK(set.size() == 500);
+
+    for(int i = 0; i < 1'000; ++i)
+        CHECK(set.contains(i) == (i % 2 != 0));
+}
+
+TEST_CASE("LockFreeHashSet adds buckets as it grows", "[hash][lockfree]")
+{
+    LockFreeHashSet<int> set;
+    size_t initialBuckets = set.bucket_count();
+
+    for(int i = 0; i < 100'000; ++i)
+        set.insert(i);
+
+    CHECK(set.bucket_count() > initialBuckets);
+    CHECK(set.load_factor() <= 2.0);
+
+    for(int i = 0; i < 100'000; ++i)
+        REQUIRE(set.contains(i));
+
+    CHECK_FALSE(set.contains(100'000));
+}
+
+TEST_CASE("LockFreeHashSet spreads keys with equal low bits over the buckets", "[hash][lockfree]")
+{
+    // With the identity std::hash and no mixing, all of these keys would
+    // fall into bucket 0, so each insert would walk the whole list
+    LockFreeHashSet<uint64_t> set;
+    const uint64_t stride = uint64_t(1) << 20;
+
+    for(uint64_t i = 0; i < 50'000; ++i)
+        REQUIRE(set.insert(i * stride));
+
+    CHECK(set.size() == 50'000);
+
+    for(uint64_t i = 0; i < 50'000; ++i)
+        REQUIRE(set.contains(i * stride));
+
+    CHECK_FALSE(set.contains(stride + 1));
+}
+
+TEST_CASE("LockFreeHashSet accepts an element again after it is erased", "[hash][lockfree]")
+{
+    LockFreeHashSet<std::string> set;
+
+    CHECK(set.insert("abc"));
+    CHECK(set.erase("abc") == 1);
+    CHECK_FALSE(set.contains("abc"));
+
+    CHECK(set.insert("abc"));
+    CHECK(set.contains("abc"));
+    CHECK(set.size() == 1);
+}
+
+TEST_CASE("LockFreeHashSet handles elements with equal hashes", "[hash][lockfree]")
+{
+    struct ConstantHash {
+        size_t operator()(int) const noexcept { return 42; }
+    };
+
+    LockFreeHashSet<int, ConstantHash> set;
+
+    for(int i = 0; i < 100; ++i)
+        CHECK(set.insert(i));
+
+    CHECK_FALSE(set.insert(50));
+    CHECK(set.erase(50) == 1);
+
+    for(int i = 0; i < 100; ++i)
+        CHECK(set.contains(i) == (i != 50));
+}
+
+TEST_CASE("LockFreeHashSet can be filled from several threads at once", "[hash][lockfree]")
+{
+    const int threadsCount = 8;
+    const int perThread = 10'000;
+
+    LockFreeHashSet<int> set;
+    std::atomic<int> inserted = 0;
+    std::vector<std::thread> threads;
+
+    // The ranges overlap, so each value is inserted by two threads
+    for(int t = 0; t < threadsCount; ++t) {
+        threads.emplace_back([&set, &inserted, t]() {
+            for(int i = 0; i < 2 * perThread; ++i)
+                if(set.insert((t * perThread + i) % (threadsCount * perThread)))
+                    ++inserted;
+        });
+    }
+
+    for(std::thread& thread : threads)
+        thread.join();
+
+    CHECK(inserted == threadsCount * perThread);
+    CHECK(set.size() == threadsCount * perThread);
+
+    for(int i = 0; i < threadsCount * perThread; ++i)
+        REQUIRE(set.contains(i));
+}
+
+TEST_CASE("LockFreeHashSet stays consistent under concurrent inserts, erases and lookups", "[hash][lockfree]")
+{
+    const int writersCount = 4;
+    const int readersCount = 4;
+    const int stableCount = 1'000;
+    const int rounds = 20;
+
+    // Values in [0, stableCount) are never erased.
+    // Each writer repeatedly inserts and erases its own range above them.
+    LockFreeHashSet<int> set;
+
+    for(int i = 0; i < stableCount; ++i)
+        set.insert(i);
+
+    std::atomic<bool> done = false;
+    std::atomic<int> misses = 0;
+    std::atomic<int> wrongResults = 0;
+    std::vector<std::thread> threads;
+
+    for(int r = 0; r < readersCount; ++r) {
+        threads.emplace_back([&]() {
+            while( ! done ) {
+                for(int i = 0; i < stableCount; ++i)
+                    if( ! set.contains(i) )
+                        ++misses;
+            }
+        });
+    }
+
+    for(int w = 0; w < writersCount; ++w) {
+        threads.emplace_back([&, w]() {
+            const int first = stableCount + w * stableCount;
+
+            for(int round = 0; round < rounds; ++round) {
+                for(int i = first; i < first + stableCount; ++i)
+                    if( ! set.insert(i) )
+                        ++wrongResults;
+
+                for(int i = first; i < first + stableCount; ++i)
+                    if(set.erase(i) != 1)
+                        ++wrongResults;
+            }
+        });
+    }
+
+    for(int w = 0; w < writersCount; ++w)
+        threads[readersCount + w].join();
+
+    done = true;
+
+    for(int r = 0; r < readersCount; ++r)
+        threads[r].join();
+
+    CHECK(misses == 0);
+    CHECK(wrongResults == 0);
+    CHECK(set.size() == stableCount);
+
+    for(int i = stableCount; i < stableCount * (writersCount + 1); ++i)
+        REQUIRE_FALSE(set.contains(i));
+}
@@ -0,0 +1,151 @@
+#include "catch2/catch_all.hpp"
+#include "containers/StaticSearchTree.h"
+#include "containers/Tree.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+using StaticTreeTypes = std::tuple<
+    EytzingerTree<int>,
+    EytzingerTree<uint64_t>,
+    StaticBTree<int>,
+    StaticBTree<uint64_t>
+>;
+
+template <typename Tree>
+static void checkAgainstLowerBound(const Tree& tree, const std::vector<typename Tree::value_type>& sorted, typename Tree::value_type key)
+{
+    auto expected = std::lower_bound(sorted.begin(), sorted.end(), key);
+    const auto* found = tree.lowerBound(key);
+
+    if(expected == sorted.end()) {
+        REQUIRE(found == nullptr);
+    }
+    else {
+        REQUIRE(found != nullptr);
+        REQUIRE(*found == *expected);
+    }
+
+    REQUIRE(tree.contains(key) == std::binary_search(sorted.begin(), sorted.end(), key));
+}
+
+TEMPLATE_LIST_TEST_CASE("Static search trees find the same keys as std::lower_bound", "[statictree]", StaticTreeTypes)
+{
+    using Key = typename TestType::value_type;
+    std::mt19937 random(42);
+
+    // Every shape of the last level and of the last node
+    for(size_t size = 0; size <= 300; ++size) {
+        std::vector<Key> sorted;
+        for(size_t i = 0; i < size; ++i)
+            sorted.push_back(static_cast<Key>(3 * i + 5));
+
+        TestType tree(sorted);
+        REQUIRE(tree.size() == size);
+
+        for(Key key = 0; key <= static_cast<Key>(3 * size + 7); ++key)
+            checkAgainstLowerBound(tree, sorted, key);
+    }
+}
+
+TEMPLATE_LIST_TEST_CASE("Static search trees work with large random sets", "[statictree]", StaticTreeTypes)
+{
+    using Key = typename TestType::value_type;
+    std::mt19937_64 random(7);
+    std::vector<Key> sorted;
+
+    for(int i = 0; i < 100000; ++i)
+        sorted.push_back(static_cast<Key>(random()));
+
+    // Duplicates are allowed and lowerBound finds one of them
+    sorted.push_back(sorted[10]);
+    std::sort(sorted.begin(), sorted.end());
+
+    TestType tree(sorted);
+
+    for(int i = 0; i < 100000; ++i) {
+        checkAgainstLowerBound(tree, sorted, sorted[random() % sorted.size()]);
+        checkAgainstLowerBound(tree, sorted, static_cast<Key>(random()));
+    }
+
+    checkAgainstLowerBound(tree, sorted, std::numeric_limits<Key>::min());
+    checkAgainstLowerBound(tree, sorted, std::numeric_limits<Key>::max());
+}
+
+TEMPLATE_LIST_TEST_CASE("Static search trees handle the extreme values of the key type", "[statictree]", StaticTreeTypes)
+{
+    using Key = typename TestType::value_type;
+    const Key min = std::numeric_limits<Key>::min();
+    const Key max = std::numeric_limits<Key>::max();
+
+    SECTION("Without the maximum") {
+        std::vector<Key> sorted = { min, static_cast<Key>(min + 1), 0, 100 };
+        std::sort(sorted.begin(), sorted.end());
+        sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+
+        TestType tree(sorted);
+
+        // The padding must not be found
+        CHECK_FALSE(tree.contains(max));
+        CHECK(tree.lowerBound(max) == nullptr);
+        CHECK(tree.contains(min));
+        CHECK(*tree.lowerBound(2) == 100);
+    }
+    SECTION("With the maximum") {
+        std::vector<Key> sorted = { 1, 2, 3, max };
+
+        TestType tree(sorted);
+
+        CHECK(tree.contains(max));
+        CHECK(*tree.lowerBound(4) == max);
+        CHECK_FALSE(tree.contains(static_cast<Key>(max - 1)));
+    }
+}
+
+TEMPLATE_LIST_TEST_CASE("Static search trees can be built from a BinarySearchTree", "[statictree]", StaticTreeTypes)
+{
+    using Key = typename TestType::value_type;
+    BinarySearchTree<Key> bst;
+    std::vector<Key> sorted;
+
+    for(int i = 0; i < 1000; ++i) {
+        Key key = static_cast<Key>((i * 7919) % 1000 * 2);
+        bst.insert(key);
+        sorted.push_back(key);
+    }
+
+    std::sort(sorted.begin(), sorted.end());
+
+    TestType tree(bst.beginIterator(), bst.size());
+
+    for(Key key = 0; key < 2002; ++key)
+        checkAgainstLowerBound(tree, sorted, key);
+}
+
+TEMPLATE_LIST_TEST_CASE("Static search trees reject unsorted keys", "[statictree]", StaticTreeTypes)
+{
+    using Key = typename TestType::value_type;
+    std::vector<Key> keys = { 1, 2, 3, 5, 4, 6 };
+
+    CHECK_THROWS_AS(TestType(keys), std::invalid_argument);
+}
+
+TEMPLATE_LIST_TEST_CASE("Static search trees can be copied", "[statictree]", StaticTreeTypes)
+{
+    using Key = typename TestType::value_type;
+    std::vector<Key> sorted = { 1, 4, 9, 16, 25 };
+
+    TestType tree(sorted);
+    TestType copy(tree);
+
+    tree = TestType();
+
+    CHECK(tree.empty());
+    CHECK_FALSE(tree.contains(4));
+    CHECK(copy.size() == 5);
+    CHECK(copy.contains(4));
+    CHECK(*copy.lowerBound(10) == 16);
+}
@@ -1,6 +1,12 @@
 #include "catch2/catch_all.hpp"
 #include "containers/Tree.h"
 
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <set>
+#include <vector>
+
 using DebugBst = BinarySearchTree<int, DebugNodeAllocator<int>>;
 
 TEST_CASE("BinarySearchTree::BinarySearchTree() constructs an empty tree", "[tree]")
@@ -183,4 +189,520 @@ TEST_CASE("BinarySearchTree::Iterator can be used to iterate all values stored i
     }
 
     CHECK(vit == sample.values.end()); // Ensure there are no more values in the tree
-}
\ No newline at end of file
+}
+
+TEST_CASE("BinarySearchTree works with a PoolNodeAllocator", "[tree]")
+{
+    using PoolBst = BinarySearchTree<int, PoolNodeAllocator<int>>;
+
+    PoolBst bst;
+    SampleBst sample;
+
+    for(int value : sample.values)
+        bst.insert(value);
+
+    CHECK(bst.allocator().activeAllocationsCount() == sample.values.size());
+    CHECK(bst.allocator().chunksCount() == 1);
+
+    for(int value : sample.values)
+        CHECK(bst.contains(value));
+
+    bst.erase(sample.values[0]);
+    CHECK_FALSE(bst.contains(sample.values[0]));
+    CHECK(bst.allocator().activeAllocationsCount() == sample.values.size() - 1);
+
+    PoolBst copy(bst);
+    CHECK(copy.size() == bst.size());
+    CHECK(copy.allocator().activeAllocationsCount() == bst.size());
+
+    SECTION("clear() releases the whole pool") {
+        bst.clear();
+
+        CHECK(bst.empty());
+        CHECK(bst.allocator().activeAllocationsCount() == 0);
+        CHECK(bst.allocator().chunksCount() == 0);
+
+        // The copy is not affected
+        for(size_t i = 1; i < sample.values.size(); ++i)
+            CHECK(copy.contains(sample.values[i]));
+
+        bst.insert(7);
+        CHECK(bst.contains(7));
+    }
+
+    SECTION("move assignment takes over the nodes with their pool") {
+        PoolBst target;
+        target.insert(100);
+        target.insert(200);
+
+        target = std::move(copy);
+
+        CHECK(target.size() == sample.values.size() - 1);
+        CHECK(target.allocator().activeAllocationsCount() == target.size());
+        CHECK_FALSE(target.contains(100));
+
+        for(size_t i = 1; i < sample.values.size(); ++i)
+            CHECK(target.contains(sample.values[i]));
+
+        CHECK(copy.empty());
+        CHECK(copy.allocator().activeAllocationsCount() == 0);
+
+        copy.insert(7);
+        CHECK(copy.contains(7));
+    }
+}
+
+TEST_CASE("BinarySearchTree works with an ArenaNodeAllocator", "[tree]")
+{
+    using ArenaBst = BinarySearchTree<int, ArenaNodeAllocator<int>>;
+
+    ArenaBst bst;
+    SampleBst sample;
+
+    for(int value : sample.values)
+        bst.insert(value);
+
+    for(int value : sample.values)
+        CHECK(bst.contains(value));
+
+    CHECK(bst.allocator().arena().bytesAllocated() == sample.values.size() * sizeof(TreeNode<int>));
+
+    bst.erase(sample.values[0]);
+    CHECK_FALSE(bst.contains(sample.values[0]));
+
+    bst.clear();
+    CHECK(bst.empty());
+    CHECK(bst.allocator().arena().bytesAllocated() == 0);
+
+    SECTION("a moved-from tree is still usable") {
+        bst.insert(1);
+        bst.insert(2);
+
+        ArenaBst moved(std::move(bst));
+        CHECK(moved.contains(1));
+        CHECK(bst.empty());
+
+        bst.insert(3);
+        CHECK(bst.contains(3));
+
+        ArenaBst target;
+        target.insert(100);
+        target = std::move(moved);
+
+        CHECK(target.size() == 2);
+        CHECK(target.contains(2));
+        CHECK_FALSE(target.contains(100));
+        CHECK(moved.empty());
+
+        moved.insert(4);
+        CHECK(moved.contains(4));
+    }
+}
+
+TEST_CASE("BinarySearchTree does NOT leak memory when copying fails with a TrackingNodeAllocator", "[tree]")
+{
+    using TrackingBst = BinarySearchTree<int, TrackingNodeAllocator<int>>;
+
+    TrackingBst bst;
+    SampleBst sample;
+
+    for(int value : sample.values)
+        bst.insert(value);
+
+    TrackingBst copy;
+    size_t failAfter = sample.values.size() - 1;
+    copy.allocator().failAfter(failAfter);
+
+    CHECK_THROWS_AS(copy = bst, std::bad_alloc);
+    CHECK(copy.allocator().activeAllocationsCount() == 0);
+    CHECK(copy.allocator().totalAllocationsCount() == failAfter);
+
+    bst.clear();
+    CHECK(bst.allocator().activeAllocationsCount() == 0);
+    CHECK(bst.allocator().sampledLeaks().empty());
+}
+
+TEST_CASE("BinarySearchTree with ParentTreeNode iterates in both directions and from a lower bound", "[tree]")
+{
+    using ParentBst = BinarySearchTree<int, ParentNodeAllocator<int>, AvlNodeOperations<int, ParentTreeNode<int>>>;
+    ParentBst bst;
+
+    for(int i = 0; i < 1000; ++i)
+        bst.insert((i * 7919) % 1000 * 2); // The even numbers 0 ... 1998 in a scrambled order
+
+    SECTION("Forwards") {
+        int expected = 0;
+        for(auto it = bst.beginIterator(); it != bst.endIterator(); ++it, expected += 2)
+            REQUIRE(*it == expected);
+        CHECK(expected == 2000);
+    }
+    SECTION("Backwards") {
+        auto it = bst.endIterator();
+        for(int expected = 1998; expected >= 0; expected -= 2) {
+            --it;
+            REQUIRE(*it == expected);
+        }
+        CHECK(it == bst.beginIterator());
+    }
+    SECTION("A range from a lower bound") {
+        int expected = 500;
+        for(auto it = bst.lowerBound(499); it != bst.endIterator() && *it < 600; ++it, expected += 2)
+            REQUIRE(*it == expected);
+        CHECK(expected == 600);
+    }
+    SECTION("After erasing") {
+        for(int i = 0; i < 2000; i += 4)
+            bst.erase(i);
+
+        int expected = 2;
+        for(auto it = bst.beginIterator(); it != bst.endIterator(); ++it, expected += 4)
+            REQUIRE(*it == expected);
+        CHECK(expected == 2002);
+    }
+}
+
+TEST_CASE("BinarySearchTree::lowerBound() works without parent pointers", "[tree]")
+{
+    DebugBst bst;
+
+    for(int i = 0; i < 100; ++i)
+        bst.insert((i * 37) % 100 * 3);
+
+    auto it = bst.lowerBound(100);
+    REQUIRE(it != bst.endIterator());
+    CHECK(*it == 102);
+    ++it;
+    CHECK(*it == 105);
+
+    CHECK(bst.lowerBound(1000) == bst.endIterator());
+}
+
+using SizedBstTypes = std::tuple<
+    BinarySearchTree<int, SizedNodeAllocator<int>, RecursiveNodeOperations<int, SizedTreeNode<int>>>,
+    BinarySearchTree<int, SizedNodeAllocator<int>, AvlNodeOperations<int, SizedTreeNode<int>>>,
+    BinarySearchTree<int, SimpleAllocator<TreeNode<int, true, true>>, RedBlackNodeOperations<int, TreeNode<int, true, true>>>
+>;
+
+TEMPLATE_LIST_TEST_CASE("BinarySearchTree::rank() and select() agree with a sorted sequence", "[tree]", SizedBstTypes)
+{
+    TestType bst;
+    std::set<int> expected;
+    std::mt19937 random(42);
+
+    // Distinct values, because the unbalanced NodeOperations do not support duplicates
+    for(int i = 0; i < 2000; ++i) {
+        int value = static_cast<int>(random() % 10000);
+
+        if(expected.insert(value).second)
+            bst.insert(value);
+    }
+
+    for(int i = 0; i < 500; ++i) {
+        int value = static_cast<int>(random() % 10000);
+
+        if(expected.erase(value))
+            bst.erase(value);
+    }
+
+    std::vector<int> sorted(expected.begin(), expected.end());
+    REQUIRE(bst.size() == sorted.size());
+
+    for(size_t k = 0; k < sorted.size(); ++k)
+        REQUIRE(bst.select(k) == sorted[k]);
+
+    for(int value = -1; value <= 10000; ++value) {
+        size_t expectedRank = static_cast<size_t>(std::lower_bound(sorted.begin(), sorted.end(), value) - sorted.begin());
+        REQUIRE(bst.rank(value) == expectedRank);
+    }
+
+    CHECK_THROWS_AS(bst.select(sorted.size()), std::out_of_range);
+}
+
+TEST_CASE("BinarySearchTree::rank() and select() handle duplicates", "[tree]")
+{
+    BinarySearchTree<int, SizedNodeAllocator<int>, AvlNodeOperations<int, SizedTreeNode<int>>> bst;
+    std::multiset<int> expected;
+
+    for(int i = 0; i < 1000; ++i) {
+        bst.insert(i % 10);
+        expected.insert(i % 10);
+    }
+
+    for(int value = 0; value < 10; ++value) {
+        CHECK(bst.rank(value) == size_t(100 * value));
+        CHECK(bst.select(100 * value) == value);
+        CHECK(bst.select(100 * value + 99) == value);
+    }
+
+    // The median
+    CHECK(bst.select(bst.size() / 2) == *std::next(expected.begin(), expected.size() / 2));
+}
+
+TEST_CASE("BinarySearchTree::range() visits the elements between two values in order", "[tree]")
+{
+    DebugBst bst;
+    std::set<int> expected;
+    std::mt19937 random(3);
+
+    for(int i = 0; i < 1000; ++i) {
+        int value = static_cast<int>(random() % 5000);
+
+        if(expected.insert(value).second)
+            bst.insert(value);
+    }
+
+    for(int i = 0; i < 200; ++i) {
+        int lo = static_cast<int>(random() % 5200) - 100;
+        int hi = lo + static_cast<int>(random() % 300);
+
+        std::vector<int> visited;
+        bst.range(lo, hi, [&visited](int value) { visited.push_back(value); });
+
+        REQUIRE(visited == std::vector<int>(expected.lower_bound(lo), expected.upper_bound(hi)));
+    }
+
+    SECTION("An empty range") {
+        size_t count = 0;
+        bst.range(10, 5, [&count](int) { ++count; });
+        CHECK(count == 0);
+    }
+}
+
+TEST_CASE("BinarySearchTree::upperBound() starts after the equal elements", "[tree]")
+{
+    BinarySearchTree<int, ParentNodeAllocator<int>, RedBlackNodeOperations<int, ParentTreeNode<int>>> bst;
+
+    for(int i = 0; i < 100; ++i)
+        bst.insert(i / 2 * 2); // 0, 0, 2, 2, 4, 4, ...
+
+    auto it = bst.upperBound(10);
+    REQUIRE(it != bst.endIterator());
+    CHECK(*it == 12);
+
+    it = bst.upperBound(11);
+    REQUIRE(it != bst.endIterator());
+    CHECK(*it == 12);
+
+    // Between lowerBound and upperBound are all copies of a value
+    size_t copies = 0;
+    for(auto it = bst.lowerBound(20); it != bst.upperBound(20); ++it)
+        ++copies;
+    CHECK(copies == 2);
+
+    CHECK(bst.upperBound(98) == bst.endIterator());
+
+    DebugBst plain;
+    for(int i = 0; i < 10; ++i)
+        plain.insert(i * 10);
+
+    CHECK(*plain.upperBound(50) == 60);
+    CHECK(*plain.upperBound(-1) == 0);
+    CHECK(plain.upperBound(90) == plain.endIterator());
+}
+
+template <typename Tree>
+static std::vector<int> contentsOf(Tree& tree)
+{
+    std::vector<int> result;
+
+    for(auto it = tree.beginIterator(); it != tree.endIterator(); ++it)
+        result.push_back(*it);
+
+    return result;
+}
+
+TEST_CASE("BinarySearchTree::fromSorted() builds a tree from sorted values", "[tree]")
+{
+    std::vector<int> values;
+    for(int i = 0; i < 1000; ++i)
+        values.push_back(i / 3); // With duplicates
+
+    auto bst = DebugBst::fromSorted(values);
+
+    CHECK(bst.size() == values.size());
+    CHECK(bst.allocator().activeAllocationsCount() == values.size());
+    CHECK(contentsOf(bst) == values);
+    CHECK(bst.contains(0));
+    CHECK(bst.contains(333));
+    CHECK_FALSE(bst.contains(334));
+
+    SECTION("The tree can be modified afterwards") {
+        bst.erase(100);
+        bst.insert(1000);
+        CHECK(bst.size() == values.size());
+        CHECK(bst.contains(1000));
+    }
+    SECTION("An empty range gives an empty tree") {
+        bst = DebugBst::fromSorted(std::vector<int>());
+        CHECK(bst.empty());
+        CHECK(bst.beginIterator() == bst.endIterator());
+    }
+    SECTION("Unsorted values are rejected") {
+        CHECK_THROWS_AS(DebugBst::fromSorted(std::vector<int>{ 1, 3, 2 }), std::invalid_argument);
+    }
+}
+
+using MergeableBstTypes = std::tuple<
+    DebugBst,
+    BinarySearchTree<int, SimpleNodeAllocator<int>, AvlNodeOperations<int>>,
+    BinarySearchTree<int, SimpleAllocator<TreeNode<int, true, true>>, RedBlackNodeOperations<int, TreeNode<int, true, true>>>,
+    BinarySearchTree<int, SimpleNodeAllocator<int>, TreapNodeOperations<int>>
+>;
+
+static std::vector<int> randomSortedValues(std::mt19937& random, size_t count, int limit)
+{
+    std::vector<int> result;
+
+    for(size_t i = 0; i < count; ++i)
+        result.push_back(static_cast<int>(random() % limit));
+
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+TEMPLATE_LIST_TEST_CASE("BinarySearchTree::unite(), intersect() and subtract() agree with the std::set_ algorithms", "[tree]", MergeableBstTypes)
+{
+    std::mt19937 random(11);
+
+    enum Operation { Union, Intersection, Difference };
+
+    for(int round = 0; round < 60; ++round) {
+        // Small values, so that there are duplicates and common elements
+        std::vector<int> a = randomSortedValues(random, random() % 500, 300);
+        std::vector<int> b = randomSortedValues(random, random() % 500, 300);
+        std::vector<int> expected;
+
+        TestType tree = TestType::fromSorted(a);
+        TestType other = TestType::fromSorted(b);
+
+        switch(round % 3) {
+        case Union:
+            std::set_union(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected));
+            tree.unite(other);
+            break;
+        case Intersection:
+            std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected));
+            tree.intersect(other);
+            break;
+        case Difference:
+            std::set_difference(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected));
+            tree.subtract(other);
+            break;
+        }
+
+        REQUIRE(contentsOf(tree) == expected);
+        REQUIRE(tree.size() == expected.size());
+        REQUIRE(contentsOf(other) == b);
+
+        if constexpr (std::is_same_v<TestType, DebugBst>)
+            REQUIRE(tree.allocator().activeAllocationsCount() == expected.size());
+
+        // The rebuilt tree keeps working with the NodeOperations
+        tree.insert(1000);
+        tree.erase(1000);
+        REQUIRE(tree.size() == expected.size());
+
+        if constexpr (requires { tree.select(0); })
+            for(size_t k = 0; k < expected.size(); ++k)
+                REQUIRE(tree.select(k) == expected[k]);
+    }
+}
+
+TEST_CASE("BinarySearchTree set operations with the tree itself", "[tree]")
+{
+    auto bst = DebugBst::fromSorted(std::vector<int>{ 1, 2, 3 });
+
+    bst.unite(bst);
+    bst.intersect(bst);
+    CHECK(contentsOf(bst) == std::vector<int>{ 1, 2, 3 });
+
+    bst.subtract(bst);
+    CHECK(bst.empty());
+    CHECK(bst.allocator().activeAllocationsCount() == 0);
+}
+
+TEST_CASE("BinarySearchTree::unite() keeps a valid tree when allocation fails", "[tree]")
+{
+    std::vector<int> even, odd;
+    for(int i = 0; i < 100; ++i)
+        (i % 2 ? odd : even).push_back(i);
+
+    auto bst = DebugBst::fromSorted(even);
+    auto other = DebugBst::fromSorted(odd);
+    bst.allocator().failAfter(even.size() + 10);
+
+    CHECK_THROWS_AS(bst.unite(other), std::bad_alloc);
+
+    // The first ten odd values were added
+    std::vector<int> expected = even;
+    expected.insert(expected.end(), odd.begin(), odd.begin() + 10);
+    std::sort(expected.begin(), expected.end());
+
+    CHECK(contentsOf(bst) == expected);
+    CHECK(bst.size() == expected.size());
+    CHECK(bst.allocator().activeAllocationsCount() == expected.size());
+}
+
+TEMPLATE_LIST_TEST_CASE("BinarySearchTree::split() and join() divide and reassemble a tree", "[tree]", MergeableBstTypes)
+{
+    std::mt19937 random(5);
+    std::vector<int> values = randomSortedValues(random, 1000, 2000);
+    TestType tree = TestType::fromSorted(values);
+
+    for(int key : { -1, 0, 1, 777, 1000, 1999, 2000 }) {
+        TestType upper = tree.split(key);
+        auto cut = std::lower_bound(values.begin(), values.end(), key);
+
+        REQUIRE(contentsOf(tree) == std::vector<int>(values.begin(), cut));
+        REQUIRE(contentsOf(upper) == std::vector<int>(cut, values.end()));
+        REQUIRE(tree.size() + upper.size() == values.size());
+
+        if constexpr (std::is_same_v<TestType, DebugBst>) {
+            REQUIRE(tree.allocator().activeAllocationsCount() == tree.size());
+            REQUIRE(upper.allocator().activeAllocationsCount() == upper.size());
+        }
+
+        tree.join(std::move(upper));
+
+        REQUIRE(contentsOf(tree) == values);
+        REQUIRE(upper.empty());
+    }
+
+    SECTION("join() rejects overlapping trees") {
+        TestType overlapping = TestType::fromSorted(std::vector<int>{ 1000 });
+
+        CHECK_THROWS_AS(tree.join(std::move(overlapping)), std::invalid_argument);
+        CHECK(contentsOf(tree) == values);
+        CHECK(overlapping.size() == 1);
+    }
+    SECTION("join() with an empty tree") {
+        TestType empty;
+        empty.join(std::move(tree));
+        CHECK(contentsOf(empty) == values);
+        CHECK(tree.empty());
+    }
+}
+
+TEST_CASE("BinarySearchTree::split() keeps the parent pointers", "[tree]")
+{
+    using ParentBst = BinarySearchTree<int, ParentNodeAllocator<int>, AvlNodeOperations<int, ParentTreeNode<int>>>;
+
+    std::vector<int> values(100);
+    for(int i = 0; i < 100; ++i)
+        values[i] = i;
+
+    auto bst = ParentBst::fromSorted(values);
+    auto upper = bst.split(40);
+
+    auto it = bst.endIterator();
+    for(int expected = 39; expected >= 0; --expected) {
+        --it;
+        REQUIRE(*it == expected);
+    }
+    CHECK(it == bst.beginIterator());
+
+    it = upper.endIterator();
+    --it;
+    CHECK(*it == 99);
+    CHECK(*upper.beginIterator() == 40);
+}
@@ -1,7 +1,10 @@
 #include "catch2/catch_all.hpp"
 #include "containers/TreeNodeIterator.h"
+#include "containers/TreeNodeOperations.h"
 #include "SampleTree.h"
 
+#include <vector>
+
 
 TEST_CASE("TreeNodeIterator::NodeIterator(nullptr) creates an iterator that has reached the end", "[tree]")
 {
@@ -81,4 +84,141 @@ TEST_CASE("TreeNodeIterator objects pointing at different nodes are NOT equal",
         TreeNodeIterator<SampleTree::value_type> it2(&tree.d);
         checkIteratorsCompareDifferent(it1, it2);
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE("TreeNodeIterator::lowerBound() starts at the first value, which is not less than a given one", "[tree]")
+{
+    SampleTree tree;
+    TreeNodeIterator<SampleTree::value_type> end = TreeNodeIterator<SampleTree::value_type>::endIterator();
+
+    for(size_t i = 0; i < tree.values.size(); ++i) {
+        int value = tree.values[i];
+
+        // The value itself and a value just before it find the same node
+        for(int searched : { value, value - 1 }) {
+            TreeNodeIterator<SampleTree::value_type> it = TreeNodeIterator<SampleTree::value_type>::lowerBound(tree.rootptr, searched);
+
+            // And the iteration continues from there
+            for(size_t j = i; j < tree.values.size(); ++j, ++it) {
+                REQUIRE(it != end);
+                CHECK(it->data == tree.values[j]);
+            }
+
+            CHECK(it == end);
+        }
+    }
+
+    CHECK(TreeNodeIterator<SampleTree::value_type>::lowerBound(tree.rootptr, tree.valueNotInTheTree) == end);
+    CHECK(TreeNodeIterator<SampleTree::value_type>::lowerBound(nullptr, 0) == end);
+}
+
+//
+// The shape of SampleTree, built from nodes with parent pointers
+//
+class ParentSampleTree {
+public:
+    using value_type = int;
+    using node_type = ParentTreeNode<int>;
+
+    SampleTree sample;
+    std::vector<node_type> nodes;
+    node_type* rootptr = nullptr;
+
+    ParentSampleTree()
+        : nodes(sample.values.size())
+    {
+        const int insertionOrder[] = { 50, -3, 70, 30, 60, 90, 80 };
+
+        for(size_t i = 0; i < nodes.size(); ++i) {
+            nodes[i].data = insertionOrder[i];
+            RecursiveNodeOperations<int, node_type>::insert(rootptr, nodes[i]);
+        }
+    }
+};
+
+TEST_CASE("ParentTreeNodeIterator walks the tree in both directions", "[tree]")
+{
+    ParentSampleTree tree;
+    const auto& values = tree.sample.values;
+    auto end = ParentTreeNodeIterator<int>::endIterator(tree.rootptr);
+
+    SECTION("Forwards") {
+        size_t i = 0;
+
+        for(ParentTreeNodeIterator<int> it(tree.rootptr); it != end; ++it, ++i)
+            CHECK(it->data == values[i]);
+
+        CHECK(i == values.size());
+    }
+    SECTION("Backwards from the end") {
+        ParentTreeNodeIterator<int> it = end;
+
+        for(size_t i = values.size(); i > 0; --i) {
+            --it;
+            REQUIRE_FALSE(it.atEnd());
+            CHECK(it->data == values[i - 1]);
+        }
+
+        // Before the first node is the end again
+        --it;
+        CHECK(it == end);
+    }
+    SECTION("Back and forth") {
+        auto it = ParentTreeNodeIterator<int>::lowerBound(tree.rootptr, 60);
+        ++it;
+        ++it;
+        --it;
+        CHECK(it->data == 70);
+    }
+}
+
+TEST_CASE("ParentTreeNodeIterator::lowerBound() starts at the first value, which is not less than a given one", "[tree]")
+{
+    ParentSampleTree tree;
+    const auto& values = tree.sample.values;
+    auto end = ParentTreeNodeIterator<int>::endIterator();
+
+    for(size_t i = 0; i < values.size(); ++i) {
+        for(int searched : { values[i], values[i] - 1 }) {
+            auto it = ParentTreeNodeIterator<int>::lowerBound(tree.rootptr, searched);
+            REQUIRE(it != end);
+            CHECK(it->data == values[i]);
+        }
+    }
+
+    CHECK(ParentTreeNodeIterator<int>::lowerBound(tree.rootptr, tree.sample.valueNotInTheTree) == end);
+}
+
+TEST_CASE("ParentTreeNodeIterator objects are equal when they point at the same node", "[tree]")
+{
+    ParentSampleTree tree;
+    ParentTreeNodeIterator<int> it1(tree.rootptr);
+    ParentTreeNodeIterator<int> it2(tree.rootptr);
+
+    checkIteratorsCompareTheSame(it1, it2);
+    ++it2;
+    checkIteratorsCompareDifferent(it1, it2);
+    checkIteratorsCompareTheSame(ParentTreeNodeIterator<int>::endIterator(), ParentTreeNodeIterator<int>::endIterator(tree.rootptr));
+}
+
+TEST_CASE("TreeNodeIterator::upperBound() starts at the first value, which is greater than a given one", "[tree]")
+{
+    SampleTree tree;
+    ParentSampleTree parentTree;
+
+    for(size_t i = 0; i < tree.values.size(); ++i) {
+        auto it = TreeNodeIterator<SampleTree::value_type>::upperBound(tree.rootptr, tree.values[i]);
+        auto parentIt = ParentTreeNodeIterator<int>::upperBound(parentTree.rootptr, tree.values[i]);
+
+        if(i + 1 < tree.values.size()) {
+            REQUIRE_FALSE(it.atEnd());
+            REQUIRE_FALSE(parentIt.atEnd());
+            CHECK(it->data == tree.values[i + 1]);
+            CHECK(parentIt->data == tree.values[i + 1]);
+        }
+        else {
+            CHECK(it.atEnd());
+            CHECK(parentIt.atEnd());
+        }
+    }
+}
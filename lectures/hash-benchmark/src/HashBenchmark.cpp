@@ -1,74 +1,540 @@
+#include "containers/ConcurrentHashTable.h"
+#include "containers/HashFunctions.h"
 #include "containers/HashTable.h"
+#include "containers/LockFreeHashSet.h"
+#include "utils/Benchmark.h"
+#include "utils/CountingAllocator.h"
 #include "utils/Stopwatch.h"
+#include "utils/Workloads.h"
 
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
 #include <iostream>
-#include <cassert>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
 #include <unordered_set>
+#include <vector>
 
-template <typename HashType>
-void run(int sampleSize, int hits, int misses)
+///
+/// Throws if a benchmark got a wrong result
+///
+/// The checks are not asserts, so that they are also made in release builds.
+///
+void check(bool condition, const std::string& name, const char* operation)
 {
-	Stopwatch sw;
-	HashType hash;
+	if ( ! condition )
+		throw std::logic_error(name + ": wrong result of " + operation);
+}
 
-	// STEP 1: fill with elements
-	std::cout << "fill...";
-	sw.start();
-	
-	for (int i = 0; i < sampleSize; i++)
-		hash.insert(i);	
-	
-	sw.stop();
-	std::cout << sw;
+///
+/// Measures filling, lookups and (where supported) batched lookups and mixed operations
+///
+/// Each operation is a separate benchmark in the runner. Every
+/// measured run fills a new table (the construction is not measured)
+/// or performs the same lookups in a table, which is filled once.
+/// The lookups count the found values, which are both checked and
+/// passed to doNotOptimize, so the loops cannot be removed.
+///
+/// The shuffled lookups touch unrelated parts of the table one after
+/// another, so each of them is likely to be a cache miss. The batched
+/// version (contains_many) looks up the same keys.
+///
+/// The mixed operations run on a newly filled table each time.
+/// They are skipped for tables, which cannot erase.
+///
+template <typename HashType, typename Key>
+void benchmark(BenchmarkRunner& runner, const std::string& name, const Workload<Key>& workload, const std::vector<Operation<Key>>& operations)
+{
+	const std::vector<Key>& keys = workload.keys;
+	size_t size = keys.size();
 
-	// STEP 2: reverse fill with elements
-	HashType hash2;
-	std::cout << " | reverse fill...";
-	sw.start();
-	
-	for (int i = sampleSize - 1; i >= 0; i--)
-		hash2.insert(i);	
-	
-	sw.stop();
-	std::cout << sw;
+	if (std::ostream* progress = runner.options().progress)
+		*progress << name << ", " << size << " element(s), " << workload.hits.size() << " hit(s), " << workload.misses.size() << " miss(es)\n";
 
-	// STEP 3: search (successful hits)
-	std::cout << " | hits...";
-	sw.start();
+	auto fill = [&keys]() {
+		HashType hash;
+		for (const Key& key : keys)
+			hash.insert(key);
+		return hash;
+	};
 
-	for (int i = 0; i < hits; i++)
-		assert(hash.contains(i % sampleSize));
-	
-	sw.stop();
-	std::cout << sw;
+	runner.run(name, "fill", size, size,
+		[]() { return HashType(); },
+		[&keys](HashType& hash) {
+			for (const Key& key : keys)
+				hash.insert(key);
+			doNotOptimize(hash);
+		});
+
+	runner.run(name, "reverse fill", size, size,
+		[]() { return HashType(); },
+		[&keys](HashType& hash) {
+			for (auto it = keys.rbegin(); it != keys.rend(); ++it)
+				hash.insert(*it);
+			doNotOptimize(hash);
+		});
+
+	HashType hash = fill();
+	size_t found = 0;
+
+	runner.run(name, "hit", size, workload.hits.size(), [&]() {
+		found = 0;
+		for (const Key& key : workload.hits)
+			found += hash.contains(key);
+		doNotOptimize(found);
+	});
+	check(found == workload.hits.size(), name, "hit");
+
+	runner.run(name, "miss", size, workload.misses.size(), [&]() {
+		found = 0;
+		for (const Key& key : workload.misses)
+			found += hash.contains(key);
+		doNotOptimize(found);
+	});
+	check(found == 0, name, "miss");
+
+	std::vector<Key> shuffled = workload.hits;
+	std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(42));
+
+	runner.run(name, "shuffled hit", size, shuffled.size(), [&]() {
+		found = 0;
+		for (const Key& key : shuffled)
+			found += hash.contains(key);
+		doNotOptimize(found);
+	});
+	check(found == shuffled.size(), name, "shuffled hit");
+
+	if constexpr (requires { hash.contains_many(std::span<const Key>(), std::span<bool>()); }) {
+		std::unique_ptr<bool[]> results(new bool[shuffled.size()]);
+
+		runner.run(name, "shuffled hit (batched)", size, shuffled.size(), [&]() {
+			hash.contains_many(shuffled, std::span<bool>(results.get(), shuffled.size()));
+			clobberMemory();
+		});
+		check(std::count(results.get(), results.get() + shuffled.size(), true) == static_cast<std::ptrdiff_t>(shuffled.size()), name, "shuffled hit (batched)");
+	}
+
+	if constexpr (requires { hash.erase(keys[0]); }) {
+		if ( ! operations.empty() ) {
+			runner.run(name, "mixed", size, operations.size(), fill, [&operations](HashType& table) {
+				size_t found = 0;
+
+				for (const Operation<Key>& operation : operations) {
+					switch (operation.type) {
+					case OperationType::Insert: table.insert(operation.key); break;
+					case OperationType::Lookup: found += table.contains(operation.key); break;
+					case OperationType::Erase: table.erase(operation.key); break;
+					}
+				}
+
+				doNotOptimize(found);
+			});
+		}
+	}
+}
+
+///
+/// Runs the benchmark for all tables on workloads of increasing size
+///
+/// makeWorkload(size, lookups) creates the keys. The results are named
+/// "table/workload". Linear search and sorted insertion are quadratic,
+/// so the vectors run only on the smallest sizes.
+///
+template <typename MakeWorkload>
+void benchmarkAll(BenchmarkRunner& runner, const std::string& workloadName, MakeWorkload makeWorkload, OperationMix mix, bool runMixed)
+{
+	for (size_t size : { 10'000, 30'000, 60'000, 90'000, 200'000, 1'000'000 }) {
+		auto workload = makeWorkload(size, size);
+		using Key = typename decltype(workload.keys)::value_type;
+
+		auto operations = runMixed ? generateOperations(workload, mix, size) : std::vector<Operation<Key>>();
+
+		if (size <= 30'000) {
+			benchmark<VectorOfUnorderedElements<Key>>(runner, "std::vector (unordered, linear search)/" + workloadName, workload, operations);
+			benchmark<VectorWithBinarySearch<Key>>(runner, "std::vector (sorted, binary search)/" + workloadName, workload, operations);
+		}
+
+		benchmark<SeparateChainingHash<Key>>(runner, "Separate chaining hash table/" + workloadName, workload, operations);
+		benchmark<SwissTableHash<Key>>(runner, "Open addressing hash table (SwissTable-style)/" + workloadName, workload, operations);
+		benchmark<RobinHoodHash<Key>>(runner, "Linear probing hash table (Robin Hood)/" + workloadName, workload, operations);
+		benchmark<std::unordered_set<Key>>(runner, "std::unordered_set/" + workloadName, workload, operations);
+	}
+}
+
+/// Names of the workloads, which can be selected with --workload
+const char* const workloadNames[] = { "sequential", "negative", "clustered", "random", "zipf", "short-strings", "long-strings" };
 
+///
+/// Runs the benchmark with one of the workloads from utils/Workloads.h
+///
+/// \return
+///    false if there is no workload with this name
+///
+bool benchmarkWorkload(BenchmarkRunner& runner, const std::string& name, OperationMix mix, bool runMixed)
+{
+	if (name == "sequential")
+		benchmarkAll(runner, name, [](size_t size, size_t lookups) { return sequentialWorkload(size, lookups); }, mix, runMixed);
+	else if (name == "negative")
+		benchmarkAll(runner, name, [](size_t size, size_t lookups) { return negativeWorkload(size, lookups); }, mix, runMixed);
+	else if (name == "clustered")
+		benchmarkAll(runner, name, [](size_t size, size_t lookups) { return clusteredWorkload(size, lookups); }, mix, runMixed);
+	else if (name == "random")
+		benchmarkAll(runner, name, [](size_t size, size_t lookups) { return randomWorkload(size, lookups); }, mix, runMixed);
+	else if (name == "zipf")
+		benchmarkAll(runner, name, [](size_t size, size_t lookups) { return zipfWorkload(size, lookups); }, mix, runMixed);
+	else if (name == "short-strings")
+		benchmarkAll(runner, name, [](size_t size, size_t lookups) { return shortStringWorkload(size, lookups); }, mix, runMixed);
+	else if (name == "long-strings")
+		benchmarkAll(runner, name, [](size_t size, size_t lookups) { return longStringWorkload(size, lookups); }, mix, runMixed);
+	else
+		return false;
+
+	return true;
+}
+
+///
+/// A SeparateChainingHash, guarded by a single mutex
+///
+/// Included for comparison with the sharded concurrent tables.
+///
+template <typename ElementType>
+class GloballyLockedHash {
+	mutable std::mutex m_mutex;
+	SeparateChainingHash<ElementType> m_hash;
+
+public:
+	bool insert(const ElementType& value)
+	{
+		std::lock_guard lock(m_mutex);
+		return m_hash.insert(value).second;
+	}
+
+	bool contains(const ElementType& value) const
+	{
+		std::lock_guard lock(m_mutex);
+		return m_hash.contains(value);
+	}
+
+	size_t erase(const ElementType& value)
+	{
+		std::lock_guard lock(m_mutex);
+		return m_hash.erase(value);
+	}
+};
+
+/// Number of operations per second (in millions), given the time they took
+double throughput(size_t operations, Stopwatch::clock::duration time)
+{
+	double microseconds = std::chrono::duration<double, std::micro>(time).count();
+	return microseconds > 0 ? operations / microseconds : 0;
+}
+
+///
+/// Runs the same task in several threads and measures the total time
+///
+/// task(threadIndex) is called once in each thread.
+/// All threads start together after they have been created.
+///
+template <typename Task>
+Stopwatch::clock::duration runInThreads(unsigned threadsCount, Task task)
+{
+	std::atomic<bool> go = false;
+	std::vector<std::thread> threads;
 
-	// STEP 4: search (misses)
-	std::cout << " | misses...";
+	for (unsigned t = 0; t < threadsCount; t++)
+		threads.emplace_back([&go, &task, t]() {
+			while ( ! go )
+				std::this_thread::yield();
+
+			task(t);
+		});
+
+	Stopwatch sw;
 	sw.start();
+	go = true;
+
+	for (std::thread& thread : threads)
+		thread.join();
 
-	int limit = sampleSize + misses;
-	for (int i = sampleSize; i < limit; i++)
-		assert( ! hash.contains(i));
-	
 	sw.stop();
-	std::cout << sw;
+	return sw.elapsed();
+}
+
+///
+/// Multi-threaded insertions and lookups
+///
+/// Each thread inserts its own part of [0, sampleSize) and then
+/// looks up `lookups / threadsCount` values, half of which are misses.
+/// Finally, the threads run a read-mostly mix of the same length:
+/// out of every 100 operations, one inserts a new value, one erases
+/// it again and the rest are lookups.
+/// The results are reported as throughput (millions of operations
+/// per second) for the whole table.
+///
+template <typename HashType>
+void runConcurrent(const std::string& name, unsigned threadsCount, int sampleSize, int lookups)
+{
+	HashType hash;
+	int insertsPerThread = sampleSize / threadsCount;
+	int lookupsPerThread = lookups / threadsCount;
+
+	auto insertTime = runInThreads(threadsCount, [&](unsigned t) {
+		int first = t * insertsPerThread;
+		for (int i = first; i < first + insertsPerThread; i++)
+			hash.insert(i);
+	});
+
+	std::atomic<int> found = 0;
+
+	auto lookupTime = runInThreads(threadsCount, [&](unsigned t) {
+		int hits = 0;
+		for (int i = 0; i < lookupsPerThread; i++)
+			hits += hash.contains((t * lookupsPerThread + i) % (2 * insertsPerThread * threadsCount));
+		found += hits;
+	});
+
+	// The values [0, inserted) are in the table and the lookups cycle through [0, 2 * inserted)
+	int inserted = insertsPerThread * threadsCount;
+	int expectedFound = 0;
+	for (int i = 0; i < lookupsPerThread * static_cast<int>(threadsCount); i++)
+		expectedFound += i % (2 * inserted) < inserted;
+
+	check(found == expectedFound, name, "concurrent lookup");
+
+	auto mixedTime = runInThreads(threadsCount, [&](unsigned t) {
+		// Values above sampleSize, so that the lookups are not affected
+		int extra = sampleSize + t * lookupsPerThread;
 
-	std::cout << " | load factor " << hash.load_factor();
+		for (int i = 0; i < lookupsPerThread; i++) {
+			if (i % 100 == 0)
+				hash.insert(extra + i);
+			else if (i % 100 == 1)
+				hash.erase(extra + i - 1);
+			else
+				hash.contains((t * lookupsPerThread + i) % (2 * insertsPerThread * threadsCount));
+		}
+	});
+
+	std::cout
+		<< "insert " << throughput(insertsPerThread * threadsCount, insertTime) << " Mops/s"
+		<< " | lookup " << throughput(lookupsPerThread * threadsCount, lookupTime) << " Mops/s"
+		<< " | mixed " << throughput(lookupsPerThread * threadsCount, mixedTime) << " Mops/s"
+		<< " | found " << found;
 }
 
+///
+/// Runs the concurrent benchmark with 1, 2, 4, ... threads
+///
+/// By default goes up to the number of hardware threads. A larger
+/// maxThreads oversubscribes the CPU, which shows how each table
+/// behaves when threads are preempted while holding locks.
+///
 template <typename HashType>
-void benchmark(const char* name, size_t runs, int sampleSize, int hits, int misses)
+void benchmarkConcurrent(const char* name, int sampleSize, int lookups, unsigned maxThreads = std::thread::hardware_concurrency())
 {
+	maxThreads = std::max(1u, maxThreads);
+
 	std::cout << name << std::endl;
-	std::cout << "  Filling with " << sampleSize << " element(s), " << hits << " hit(s), " << misses << " miss(es)\n";
+	std::cout << "  Filling with " << sampleSize << " element(s), " << lookups << " lookup(s), using up to " << maxThreads << " thread(s)\n";
 
-	for (size_t i = 0; i < runs; i++)
+	for (unsigned threads = 1; ; threads = std::min(threads * 2, maxThreads))
 	{
-		std::cout << "    " << i << ": ";
-		run<HashType>(sampleSize, hits, misses);
+		std::cout << "    " << threads << " thread(s): ";
+		runConcurrent<HashType>(name, threads, sampleSize, lookups);
 		std::cout << std::endl;
-	}	
+
+		if (threads == maxThreads)
+			break;
+	}
+}
+
+///
+/// Measures the speed of a hash function and the quality of the buckets it produces
+///
+/// The keys are distributed into a power of two number of buckets
+/// by the lowest bits of their hashes, the same way the hash tables
+/// do it. For a good function the number of keys in a bucket follows
+/// the Poisson distribution, so the report compares with it:
+///   - chi2/n: the chi-squared statistic, divided by the number of
+///     buckets. Around 1 for a random function, much larger with clustering.
+///   - empty: percentage of empty buckets (the ideal is e^-load factor).
+///   - longest: the number of keys in the fullest bucket.
+///
+template <typename Key, typename HashFunction>
+void measureHashFunction(const char* name, const std::vector<Key>& keys, HashFunction hash)
+{
+	const int repetitions = 10;
+	Stopwatch sw;
+	size_t checksum = 0;
+
+	sw.start();
+
+	for (int r = 0; r < repetitions; r++)
+		for (const Key& key : keys)
+			checksum += hash(key);
+
+	sw.stop();
+
+	size_t bucketsCount = std::bit_ceil(keys.size());
+	std::vector<uint32_t> buckets(bucketsCount);
+
+	for (const Key& key : keys)
+		++buckets[hash(key) & (bucketsCount - 1)];
+
+	double expected = double(keys.size()) / bucketsCount;
+	double chiSquared = 0;
+	size_t empty = 0;
+	uint32_t longest = 0;
+
+	for (uint32_t count : buckets) {
+		chiSquared += (count - expected) * (count - expected) / expected;
+		empty += (count == 0);
+		longest = std::max(longest, count);
+	}
+
+	std::cout
+		<< "    " << name << ": "
+		<< throughput(keys.size() * repetitions, sw.elapsed()) << " Mhashes/s"
+		<< " | chi2/n " << chiSquared / bucketsCount
+		<< " | empty " << 100.0 * empty / bucketsCount << "% (ideal " << 100.0 * std::exp(-expected) << "%)"
+		<< " | longest " << longest
+		<< (checksum == 1 ? " " : "") // Uses the checksum, so that the hashing is not optimized away
+		<< std::endl;
+}
+
+/// Times filling a SeparateChainingHash with a set of keys
+template <typename Key, typename HashFunction>
+void measureTableFill(const char* name, const std::vector<Key>& keys)
+{
+	Stopwatch sw;
+	SeparateChainingHash<Key, HashFunction> table;
+
+	sw.start();
+
+	for (const Key& key : keys)
+		table.insert(key);
+
+	sw.stop();
+	std::cout << "    SeparateChainingHash with " << name << ": fill " << sw << std::endl;
+}
+
+///
+/// Compares the hash functions from HashFunctions.h with std::hash
+///
+/// Run with `hash-benchmark hashes`. The keys are sequential, strided
+/// (as the IDs of objects, allocated in fixed-size blocks) and random.
+/// std::hash of an integer is the identity, so for strided keys it
+/// uses only a fraction of the buckets of a table, which masks the
+/// hash without mixing it.
+///
+void benchmarkHashFunctions(size_t keysCount)
+{
+	std::mt19937_64 random(42);
+
+	struct IntegerKeys {
+		const char* name;
+		std::vector<uint64_t> keys;
+	};
+
+	IntegerKeys integerSets[] = { {"sequential", {}}, {"strided by 1024", {}}, {"random", {}} };
+
+	for (size_t i = 0; i < keysCount; i++) {
+		integerSets[0].keys.push_back(i);
+		integerSets[1].keys.push_back(i * 1024);
+		integerSets[2].keys.push_back(random());
+	}
+
+	for (IntegerKeys& set : integerSets) {
+		std::cout << keysCount << " " << set.name << " integer keys\n";
+		measureHashFunction("std::hash          ", set.keys, std::hash<uint64_t>());
+		measureHashFunction("mixHashBits        ", set.keys, [](uint64_t key) { return mixHashBits(key); });
+		measureHashFunction("FibonacciHash      ", set.keys, FibonacciHash());
+		measureHashFunction("SeededHash         ", set.keys, SeededHash());
+	}
+
+	// SeparateChainingHash mixes the hash, so even std::hash fills it in linear time
+	const std::vector<uint64_t>& strided = integerSets[1].keys;
+	std::cout << strided.size() << " strided integer keys\n";
+	measureTableFill<uint64_t, std::hash<uint64_t>>("std::hash", strided);
+	measureTableFill<uint64_t, FibonacciHash>("FibonacciHash", strided);
+	measureTableFill<uint64_t, SeededHash>("SeededHash", strided);
+
+	std::vector<std::string> ids, texts;
+
+	for (size_t i = 0; i < keysCount; i++) {
+		ids.push_back("user-" + std::to_string(i));
+
+		std::string text(8 + random() % 120, ' ');
+		for (char& c : text)
+			c = static_cast<char>('a' + random() % 26);
+		texts.push_back(std::move(text));
+	}
+
+	std::cout << keysCount << " string IDs (user-0, user-1, ...)\n";
+	measureHashFunction("std::hash          ", ids, std::hash<std::string>());
+	measureHashFunction("WyHash             ", ids, WyHash());
+	measureHashFunction("SeededHash         ", ids, SeededHash());
+
+	std::cout << keysCount << " random strings of 8 to 127 characters\n";
+	measureHashFunction("std::hash          ", texts, std::hash<std::string>());
+	measureHashFunction("WyHash             ", texts, WyHash());
+	measureHashFunction("SeededHash         ", texts, SeededHash());
+}
+
+///
+/// Reports the memory used by a table with elementsCount integers
+///
+/// The table allocates everything through a CountingAllocator, so the
+/// numbers are exact on every platform and standard library. They show
+/// what fraction of the memory is the data itself and how much is
+/// representation (nodes, pointers, control bytes, empty slots).
+/// The peak includes the old and the new arrays during a rehash.
+///
+template <template <typename, typename, typename> class TableTemplate>
+void measureMemory(const char* name, size_t elementsCount)
+{
+	CountingAllocator<int> allocator;
+	const AllocationCounter& counter = allocator.counter();
+
+	TableTemplate<int, std::hash<int>, CountingAllocator<int>> table(allocator);
+
+	for (size_t i = 0; i < elementsCount; i++)
+		table.insert(static_cast<int>(i));
+
+	size_t dataBytes = elementsCount * sizeof(int);
+
+	std::cout
+		<< "    " << name << ": "
+		<< double(counter.liveBytes) / elementsCount << " bytes per element"
+		<< " | " << 100.0 * dataBytes / counter.liveBytes << "% data"
+		<< " | " << counter.liveBlocks << " blocks"
+		<< " | peak " << counter.peakBytes / 1024 << " KiB"
+		<< std::endl;
+}
+
+template <typename ElementType, typename Hash, typename Allocator>
+using UnorderedSet = std::unordered_set<ElementType, Hash, std::equal_to<ElementType>, Allocator>;
+
+void benchmarkMemory()
+{
+	for (size_t count : { 1'000, 100'000, 1'000'000 }) {
+		std::cout << count << " integers\n";
+		measureMemory<SeparateChainingHash>("Separate chaining hash table      ", count);
+		measureMemory<SwissTableHash>("Open addressing (SwissTable-style)", count);
+		measureMemory<RobinHoodHash>("Linear probing (Robin Hood)       ", count);
+		measureMemory<UnorderedSet>("std::unordered_set                ", count);
+	}
 }
 
 void separator()
@@ -76,39 +542,121 @@ void separator()
 	std::cout << "\n-------------------------------\n\n";
 }
 
-int main()
+///
+/// Usage:
+///   hash-benchmark [options]   compares the hash tables
+///   hash-benchmark hashes      compares the hash functions
+///   hash-benchmark memory      compares the memory used by the hash tables
+///
+/// Options:
+///   --csv, --json      write the results in this format at the end (the default is text)
+///   --repetitions=N    measured runs of each benchmark (default 10)
+///   --warmup=N         unmeasured runs before them (default 1)
+///   --cpu=N            pin the benchmark to CPU N (Linux only)
+///   --counters         count cycles, cache misses, etc. per operation with PerfCounters (Linux only)
+///   --workload=NAME    keys to use: sequential (the default), negative, clustered,
+///                      random, zipf, short-strings, long-strings or all.
+///                      Can be given several times.
+///   --mix=I/L/E        also run a sequence of operations on the filled tables,
+///                      with I% insertions, L% lookups and E% erasures (e.g. 5/90/5)
+///
+/// The concurrent benchmarks, which report throughput, run only with text output.
+///
+int main(int argc, char* argv[])
 {
-	size_t attempts = 3;
+	if (argc > 1 && std::strcmp(argv[1], "hashes") == 0) {
+		benchmarkHashFunctions(1'000'000);
+		return 0;
+	}
 
-	benchmark<VectorOfUnorderedElements<int>>("std::vector (unordered, linear search)", attempts,  10'000,  10'000,  10'000);
-	benchmark<VectorOfUnorderedElements<int>>("std::vector (unordered, linear search)", attempts,  30'000,  30'000,  30'000);
-	benchmark<VectorOfUnorderedElements<int>>("std::vector (unordered, linear search)", attempts,  60'000,  60'000,  60'000);
-	benchmark<VectorOfUnorderedElements<int>>("std::vector (unordered, linear search)", attempts,  90'000,  90'000,  90'000);
-	benchmark<VectorOfUnorderedElements<int>>("std::vector (unordered, linear search)", attempts, 200'000, 100'000, 100'000);
+	if (argc > 1 && std::strcmp(argv[1], "memory") == 0) {
+		benchmarkMemory();
+		return 0;
+	}
 
-	separator();
+	enum class Output { Text, Csv, Json } output = Output::Text;
+	BenchmarkOptions options;
+	std::vector<std::string> workloads;
+	OperationMix mix;
+	bool runMixed = false;
 
-	benchmark<VectorWithBinarySearch<int>>("std::vector (sorted, binary search)", attempts,  10'000,  10'000,  10'000);
-	benchmark<VectorWithBinarySearch<int>>("std::vector (sorted, binary search)", attempts,  30'000,  30'000,  30'000);
-	benchmark<VectorWithBinarySearch<int>>("std::vector (sorted, binary search)", attempts,  60'000,  60'000,  60'000);
-	benchmark<VectorWithBinarySearch<int>>("std::vector (sorted, binary search)", attempts,  90'000,  90'000,  90'000);
-	benchmark<VectorWithBinarySearch<int>>("std::vector (sorted, binary search)", attempts, 200'000, 100'000, 100'000);
+	for (int i = 1; i < argc; i++) {
+		std::string_view arg = argv[i];
+		auto valueOf = [arg](std::string_view option) { return std::stoi(std::string(arg.substr(option.size()))); };
 
-	separator();
+		if (arg == "--csv")
+			output = Output::Csv;
+		else if (arg == "--json")
+			output = Output::Json;
+		else if (arg.starts_with("--repetitions="))
+			options.repetitions = std::max(1, valueOf("--repetitions="));
+		else if (arg.starts_with("--warmup="))
+			options.warmupRuns = std::max(0, valueOf("--warmup="));
+		else if (arg.starts_with("--cpu="))
+			options.cpu = valueOf("--cpu=");
+		else if (arg == "--counters")
+			options.countEvents = true;
+		else if (arg == "--workload=all")
+			workloads.assign(std::begin(workloadNames), std::end(workloadNames));
+		else if (arg.starts_with("--workload=") && std::find(std::begin(workloadNames), std::end(workloadNames), arg.substr(std::strlen("--workload="))) != std::end(workloadNames))
+			workloads.emplace_back(arg.substr(std::strlen("--workload=")));
+		else if (arg.starts_with("--mix=") && std::sscanf(argv[i], "--mix=%u/%u/%u", &mix.insert, &mix.lookup, &mix.erase) == 3)
+			runMixed = true;
+		else {
+			std::cerr << "Unknown option " << arg << "\n";
+			return 1;
+		}
+	}
+
+	if (workloads.empty())
+		workloads.push_back("sequential");
 
-	benchmark<SeparateChainingHash<int>>("Separate chaining hash table", attempts,    10'000,    10'000,    10'000);
-	benchmark<SeparateChainingHash<int>>("Separate chaining hash table", attempts,    30'000,    30'000,    30'000);
-	benchmark<SeparateChainingHash<int>>("Separate chaining hash table", attempts,    60'000,    60'000,    60'000);
-	benchmark<SeparateChainingHash<int>>("Separate chaining hash table", attempts,    90'000,    90'000,    90'000);
-	benchmark<SeparateChainingHash<int>>("Separate chaining hash table", attempts,   200'000,   100'000,   100'000);
-	benchmark<SeparateChainingHash<int>>("Separate chaining hash table", attempts, 1'000'000, 1'000'000, 1'000'000);
+	if (output == Output::Text)
+		options.progress = &std::cout;
+
+	try {
+		BenchmarkRunner runner(options);
+
+		if (options.cpu >= 0 && !runner.pinned())
+			std::cerr << "Could not pin the benchmark to CPU " << options.cpu << "\n";
+
+		if (options.countEvents) {
+			for (int e = 0; e < PerfCounters::EventsCount; e++)
+				if ( ! runner.counters()->available(static_cast<PerfCounters::Event>(e)) )
+					std::cerr << "Cannot count " << PerfCounters::name(static_cast<PerfCounters::Event>(e)) << "\n";
+		}
+
+		for (const std::string& workload : workloads) {
+			if ( ! benchmarkWorkload(runner, workload, mix, runMixed) ) {
+				std::cerr << "Unknown workload " << workload << "\n";
+				return 1;
+			}
+		}
+
+		if (output == Output::Csv)
+			runner.writeCsv(std::cout);
+		else if (output == Output::Json)
+			runner.writeJson(std::cout);
+	}
+	catch (const std::exception& e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+
+	if (output != Output::Text)
+		return 0;
 
 	separator();
 
-	benchmark<std::unordered_set<int>>("std::unordered_set", attempts,    10'000,    10'000,    10'000);
-	benchmark<std::unordered_set<int>>("std::unordered_set", attempts,    30'000,    30'000,    30'000);
-	benchmark<std::unordered_set<int>>("std::unordered_set", attempts,    60'000,    60'000,    60'000);
-	benchmark<std::unordered_set<int>>("std::unordered_set", attempts,    90'000,    90'000,    90'000);
-	benchmark<std::unordered_set<int>>("std::unordered_set", attempts,   200'000,   100'000,   100'000);
-	benchmark<std::unordered_set<int>>("std::unordered_set", attempts, 1'000'000, 1'000'000, 1'000'000);	
+	const unsigned stressThreads = 64;
+
+	try {
+		benchmarkConcurrent<GloballyLockedHash<int>>("Separate chaining hash table with a global mutex", 1'000'000, 4'000'000, stressThreads);
+		benchmarkConcurrent<ConcurrentHashSet<int>>("Sharded concurrent hash set", 1'000'000, 4'000'000, stressThreads);
+		benchmarkConcurrent<LockFreeHashSet<int>>("Lock-free hash set (split-ordered list)", 1'000'000, 4'000'000, stressThreads);
+	}
+	catch (const std::exception& e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
 }
\ No newline at end of file
@@ -0,0 +1,382 @@
+#include "containers/BPlusTree.h"
+#include "containers/BalancedTreeNodeOperations.h"
+#include "containers/HashTable.h"
+#include "containers/StaticSearchTree.h"
+#include "containers/Tree.h"
+#include "utils/Benchmark.h"
+#include "utils/Workloads.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <set>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+
+///
+/// Throws if a benchmark got a wrong result
+///
+/// The checks are not asserts, so that they are also made in release builds.
+///
+void check(bool condition, const std::string& name, const char* operation)
+{
+	if ( ! condition )
+		throw std::logic_error(name + ": wrong result of " + operation);
+}
+
+/// Calls f(value) for every value of the container, in order
+template <typename TreeType, typename Function>
+void forEach(TreeType& tree, Function f)
+{
+	if constexpr (requires { tree.beginIterator(); }) {
+		for (auto it = tree.beginIterator(); it != tree.endIterator(); ++it)
+			f(*it);
+	}
+	else {
+		for (const auto& key : tree)
+			f(key);
+	}
+}
+
+/// Calls f(value) for at most `count` values of the container, starting from the first one not less than `from`
+template <typename TreeType, typename Key, typename Function>
+void forEachInRange(TreeType& tree, const Key& from, size_t count, Function f)
+{
+	if constexpr (requires { tree.lowerBound(from); }) {
+		for (auto it = tree.lowerBound(from); count > 0 && it != tree.endIterator(); ++it, --count)
+			f(*it);
+	}
+	else {
+		for (auto it = tree.lower_bound(from); count > 0 && it != tree.end(); ++it, --count)
+			f(*it);
+	}
+}
+
+///
+/// Measures filling, lookups, short and full in-order scans and erasing of all values
+///
+/// The trees live on the heap, so that they are created by setup() and
+/// not copied. Every measured fill and erase works on a new tree; the
+/// lookups and the scan are made in a tree, which is filled once.
+///
+template <typename TreeType, typename Key>
+void benchmark(BenchmarkRunner& runner, const std::string& name, const Workload<Key>& workload)
+{
+	const std::vector<Key>& keys = workload.keys;
+	size_t size = keys.size();
+
+	if (std::ostream* progress = runner.options().progress)
+		*progress << name << ", " << size << " element(s)\n";
+
+	auto fill = [&keys]() {
+		auto tree = std::make_unique<TreeType>();
+		for (const Key& key : keys)
+			tree->insert(key);
+		return tree;
+	};
+
+	runner.run(name, "fill", size, size,
+		[]() { return std::make_unique<TreeType>(); },
+		[&keys](std::unique_ptr<TreeType>& tree) {
+			for (const Key& key : keys)
+				tree->insert(key);
+			doNotOptimize(*tree);
+		});
+
+	std::unique_ptr<TreeType> tree = fill();
+	size_t found = 0;
+
+	runner.run(name, "hit", size, workload.hits.size(), [&]() {
+		found = 0;
+		for (const Key& key : workload.hits)
+			found += tree->contains(key);
+		doNotOptimize(found);
+	});
+	check(found == workload.hits.size(), name, "hit");
+
+	runner.run(name, "miss", size, workload.misses.size(), [&]() {
+		found = 0;
+		for (const Key& key : workload.misses)
+			found += tree->contains(key);
+		doNotOptimize(found);
+	});
+	check(found == 0, name, "miss");
+
+	Key sum = 0;
+
+	runner.run(name, "scan", size, size, [&]() {
+		found = 0;
+		sum = 0;
+		forEach(*tree, [&](const Key& key) { ++found; sum += key; });
+		doNotOptimize(sum);
+	});
+	check(found == size, name, "scan");
+
+	// Short range scans: an iterator from a lower bound, advanced a few times
+	const size_t rangeLength = 8;
+
+	runner.run(name, "range", size, workload.hits.size(), [&]() {
+		found = 0;
+		sum = 0;
+		for (const Key& key : workload.hits)
+			forEachInRange(*tree, key, rangeLength, [&](const Key& value) { ++found; sum += value; });
+		doNotOptimize(sum);
+	});
+	check(found >= workload.hits.size(), name, "range");
+
+	// Order statistics, for the trees which store subtree sizes
+	if constexpr (requires { tree->rank(keys[0]); tree->select(0); }) {
+		runner.run(name, "rank", size, workload.hits.size(), [&]() {
+			sum = 0;
+			for (const Key& key : workload.hits)
+				sum += tree->rank(key);
+			doNotOptimize(sum);
+		});
+
+		runner.run(name, "select", size, workload.hits.size(), [&]() {
+			sum = 0;
+			for (size_t i = 0; i < workload.hits.size(); ++i)
+				sum += tree->select(workload.hits[i] % size);
+			doNotOptimize(sum);
+		});
+	}
+
+	std::vector<Key> shuffled = keys;
+	std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(42));
+
+	runner.run(name, "erase", size, size, fill, [&shuffled](std::unique_ptr<TreeType>& tree) {
+		for (const Key& key : shuffled)
+			tree->erase(key);
+		doNotOptimize(*tree);
+	});
+}
+
+///
+/// Measures building a read-only set from sorted keys and lookups in it
+///
+/// VectorWithBinarySearch is filled in ascending order, so that each
+/// insertion appends and the build is not quadratic.
+///
+template <typename SetType, typename Key>
+void benchmarkStatic(BenchmarkRunner& runner, const std::string& name, const Workload<Key>& workload, const std::vector<Key>& sorted)
+{
+	size_t size = sorted.size();
+
+	if (std::ostream* progress = runner.options().progress)
+		*progress << name << ", " << size << " element(s)\n";
+
+	auto build = [&sorted]() {
+		if constexpr (std::is_constructible_v<SetType, std::span<const Key>>) {
+			return SetType(std::span<const Key>(sorted));
+		}
+		else {
+			SetType set;
+			for (const Key& key : sorted)
+				set.insert(key);
+			return set;
+		}
+	};
+
+	runner.run(name, "build", size, size, [&]() {
+		SetType set = build();
+		doNotOptimize(set);
+	});
+
+	SetType set = build();
+	size_t found = 0;
+
+	runner.run(name, "hit", size, workload.hits.size(), [&]() {
+		found = 0;
+		for (const Key& key : workload.hits)
+			found += set.contains(key);
+		doNotOptimize(found);
+	});
+	check(found == workload.hits.size(), name, "hit");
+
+	runner.run(name, "miss", size, workload.misses.size(), [&]() {
+		found = 0;
+		for (const Key& key : workload.misses)
+			found += set.contains(key);
+		doNotOptimize(found);
+	});
+	check(found == 0, name, "miss");
+}
+
+/// Compares the read-only sets on the keys of a workload
+template <typename Key>
+void benchmarkAllStatic(BenchmarkRunner& runner, const std::string& workloadName, const Workload<Key>& workload)
+{
+	std::vector<Key> sorted = workload.keys;
+	std::sort(sorted.begin(), sorted.end());
+
+	benchmarkStatic<VectorWithBinarySearch<Key>>(runner, "std::vector (sorted, binary search)/" + workloadName, workload, sorted);
+	benchmarkStatic<EytzingerTree<Key>>(runner, "EytzingerTree/" + workloadName, workload, sorted);
+	benchmarkStatic<StaticBTree<Key>>(runner, "StaticBTree/" + workloadName, workload, sorted);
+}
+
+///
+/// Compares the bulk operations of BinarySearchTree with inserting the values one by one
+///
+/// "build" inserts sorted keys, "fromSorted" builds the same tree in
+/// O(n). "union (insert)" inserts the misses of the workload into a tree
+/// of its keys, "union" merges two such trees with unite(), which walks
+/// both of them in order. "split+join" divides the tree at its median and
+/// joins it back.
+///
+/// The bulk operations pass over lists of nodes, so they are fastest
+/// when the nodes are close in memory. With SimpleAllocator, the nodes
+/// of a new tree reuse the memory of the trees freed by earlier runs in
+/// a scattered order, which costs a cache miss per node and pass.
+///
+template <typename TreeType, typename Key>
+void benchmarkBulk(BenchmarkRunner& runner, const std::string& name, const Workload<Key>& workload)
+{
+	std::vector<Key> sorted = workload.keys;
+	std::sort(sorted.begin(), sorted.end());
+	std::vector<Key> others = workload.misses;
+	std::sort(others.begin(), others.end());
+
+	size_t size = sorted.size();
+
+	if (std::ostream* progress = runner.options().progress)
+		*progress << name << " (bulk), " << size << " element(s)\n";
+
+	runner.run(name, "build", size, size,
+		[]() { return std::make_unique<TreeType>(); },
+		[&sorted](std::unique_ptr<TreeType>& tree) {
+			for (const Key& key : sorted)
+				tree->insert(key);
+			doNotOptimize(*tree);
+		});
+
+	runner.run(name, "fromSorted", size, size, [&]() {
+		TreeType tree = TreeType::fromSorted(sorted);
+		doNotOptimize(tree);
+	});
+
+	auto treeOfKeys = [&sorted]() { return std::make_unique<TreeType>(TreeType::fromSorted(sorted)); };
+	TreeType other = TreeType::fromSorted(others);
+
+	runner.run(name, "union (insert)", size, others.size(), treeOfKeys, [&others](std::unique_ptr<TreeType>& tree) {
+		for (const Key& key : others)
+			tree->insert(key);
+		doNotOptimize(*tree);
+	});
+
+	runner.run(name, "union", size, size + others.size(), treeOfKeys, [&](std::unique_ptr<TreeType>& tree) {
+		tree->unite(other);
+		check(tree->size() == size + others.size(), name, "union");
+	});
+
+	runner.run(name, "split+join", size, size, treeOfKeys, [&](std::unique_ptr<TreeType>& tree) {
+		TreeType upper = tree->split(sorted[size / 2]);
+		tree->join(std::move(upper));
+		check(tree->size() == size, name, "split+join");
+	});
+}
+
+///
+/// Runs the benchmark for all trees on random keys of increasing size
+///
+/// The keys are inserted in random order, so the unbalanced tree is
+/// only about 2.5 times deeper than a balanced one. The read-only sets
+/// are also compared on 32-bit keys, for which StaticBTree uses SIMD.
+///
+void benchmarkAll(BenchmarkRunner& runner, const std::vector<size_t>& sizes)
+{
+	for (size_t size : sizes) {
+		using Key = uint64_t;
+		Workload<Key> workload = randomWorkload(size, size);
+
+		benchmark<BinarySearchTree<Key, PoolNodeAllocator<Key>>>(runner, "BinarySearchTree (unbalanced, pool)", workload);
+		benchmark<BinarySearchTree<Key, PoolNodeAllocator<Key>, AvlNodeOperations<Key>>>(runner, "BinarySearchTree (AVL, pool)", workload);
+		benchmark<BinarySearchTree<Key, PoolNodeAllocator<Key>, RedBlackNodeOperations<Key>>>(runner, "BinarySearchTree (red-black, pool)", workload);
+		benchmark<BinarySearchTree<Key, PoolAllocator<ParentTreeNode<Key>>, RedBlackNodeOperations<Key, ParentTreeNode<Key>>>>(runner, "BinarySearchTree (red-black, parent pointers, pool)", workload);
+		benchmark<BinarySearchTree<Key, PoolAllocator<SizedTreeNode<Key>>, RedBlackNodeOperations<Key, SizedTreeNode<Key>>>>(runner, "BinarySearchTree (red-black, subtree sizes, pool)", workload);
+		benchmark<BPlusTree<Key>>(runner, "BPlusTree (256-byte nodes)", workload);
+		benchmark<BPlusTree<Key, void, 64>>(runner, "BPlusTree (64-byte nodes)", workload);
+		benchmark<std::set<Key>>(runner, "std::set", workload);
+
+		benchmarkBulk<BinarySearchTree<Key, PoolNodeAllocator<Key>, AvlNodeOperations<Key>>>(runner, "BinarySearchTree (AVL, pool)", workload);
+		benchmarkBulk<BinarySearchTree<Key, SimpleNodeAllocator<Key>, RedBlackNodeOperations<Key>>>(runner, "BinarySearchTree (red-black)", workload);
+
+		benchmarkAllStatic(runner, "random", workload);
+		benchmarkAllStatic(runner, "clustered", clusteredWorkload(size, size));
+	}
+}
+
+///
+/// Usage:
+///   tree-benchmark [options]   compares the node-based trees with the B+ tree
+///                              and the read-only sets with binary search
+///
+/// Options:
+///   --csv, --json      write the results in this format at the end (the default is text)
+///   --repetitions=N    measured runs of each benchmark (default 10)
+///   --warmup=N         unmeasured runs before them (default 1)
+///   --cpu=N            pin the benchmark to CPU N (Linux only)
+///   --counters         count cycles, cache misses, etc. per operation with PerfCounters (Linux only)
+///   --size=N           number of keys; can be given several times
+///                      (the default is 10000, 100000 and 1000000)
+///
+int main(int argc, char* argv[])
+{
+	enum class Output { Text, Csv, Json } output = Output::Text;
+	BenchmarkOptions options;
+	std::vector<size_t> sizes;
+
+	for (int i = 1; i < argc; i++) {
+		std::string_view arg = argv[i];
+		auto valueOf = [arg](std::string_view option) { return std::stoi(std::string(arg.substr(option.size()))); };
+
+		if (arg == "--csv")
+			output = Output::Csv;
+		else if (arg == "--json")
+			output = Output::Json;
+		else if (arg.starts_with("--repetitions="))
+			options.repetitions = std::max(1, valueOf("--repetitions="));
+		else if (arg.starts_with("--warmup="))
+			options.warmupRuns = std::max(0, valueOf("--warmup="));
+		else if (arg.starts_with("--cpu="))
+			options.cpu = valueOf("--cpu=");
+		else if (arg == "--counters")
+			options.countEvents = true;
+		else if (arg.starts_with("--size="))
+			sizes.push_back(static_cast<size_t>(std::max(1, valueOf("--size="))));
+		else {
+			std::cerr << "Unknown option " << arg << "\n";
+			return 1;
+		}
+	}
+
+	if (sizes.empty())
+		sizes = { 10'000, 100'000, 1'000'000 };
+
+	if (output == Output::Text)
+		options.progress = &std::cout;
+
+	try {
+		BenchmarkRunner runner(options);
+
+		if (options.cpu >= 0 && !runner.pinned())
+			std::cerr << "Could not pin the benchmark to CPU " << options.cpu << "\n";
+
+		benchmarkAll(runner, sizes);
+
+		if (output == Output::Csv)
+			runner.writeCsv(std::cout);
+		else if (output == Output::Json)
+			runner.writeJson(std::cout);
+	}
+	catch (const std::exception& e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+}
@@ -1,8 +1,13 @@
 #pragma once
 
+#include <limits>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
 #include <unordered_set>
 #include <utility>
-#include <stdexcept>
+#include <vector>
 
 template <typename T>
 class SimpleAllocator {
@@ -71,4 +76,151 @@ public:
     {
         m_failAfter = value;
     }
-};
\ No newline at end of file
+};
+
+///
+/// Allocates objects from large chunks of memory, instead of one by one
+///
+/// Each chunk holds objectsPerChunk objects. A released object goes
+/// to an intrusive free list (the pointer is stored in the memory of
+/// the object itself) and is reused by the next buy(). Thus buy() and
+/// release() are a few instructions, except when a new chunk is needed,
+/// and the objects are close to each other in memory.
+///
+/// clear() releases all chunks at once, without visiting the objects.
+/// It is only available for trivially destructible types, because the
+/// pool does not know which of the objects are alive. For the same
+/// reason, destroying the pool frees the memory of the objects, which
+/// were not released, but does not call their destructors.
+///
+template <typename T>
+class PoolAllocator {
+    union Slot {
+        Slot* next;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    std::vector<std::unique_ptr<Slot[]>> m_chunks;
+    Slot* m_freeList = nullptr;
+    size_t m_usedInLastChunk = 0;
+    size_t m_objectsPerChunk;
+    size_t m_activeAllocations = 0;
+
+    Slot* takeSlot()
+    {
+        if(m_freeList) {
+            Slot* slot = m_freeList;
+            m_freeList = slot->next;
+            return slot;
+        }
+
+        if(m_chunks.empty() || m_usedInLastChunk == m_objectsPerChunk) {
+            m_chunks.push_back(std::make_unique_for_overwrite<Slot[]>(m_objectsPerChunk));
+            m_usedInLastChunk = 0;
+        }
+
+        return &m_chunks.back()[m_usedInLastChunk++];
+    }
+
+    void returnSlot(Slot* slot) noexcept
+    {
+        slot->next = m_freeList;
+        m_freeList = slot;
+    }
+
+public:
+    explicit PoolAllocator(size_t objectsPerChunk = 4096)
+        : m_objectsPerChunk(objectsPerChunk)
+    {
+        if(objectsPerChunk == 0)
+            throw std::invalid_argument("A pool chunk must hold at least one object");
+    }
+
+    PoolAllocator(const PoolAllocator&) = delete;
+    PoolAllocator& operator=(const PoolAllocator&) = delete;
+
+    PoolAllocator(PoolAllocator&& other) noexcept
+        : m_chunks(std::move(other.m_chunks)),
+          m_freeList(std::exchange(other.m_freeList, nullptr)),
+          m_usedInLastChunk(std::exchange(other.m_usedInLastChunk, 0)),
+          m_objectsPerChunk(other.m_objectsPerChunk),
+          m_activeAllocations(std::exchange(other.m_activeAllocations, 0))
+    {
+        // Nothing to do here
+    }
+
+    ///
+    /// Takes over the objects of `other` and hands this pool's objects
+    /// over to it, so they are freed together with `other`
+    ///
+    PoolAllocator& operator=(PoolAllocator&& other) noexcept
+    {
+        std::swap(m_chunks, other.m_chunks);
+        std::swap(m_freeList, other.m_freeList);
+        std::swap(m_usedInLastChunk, other.m_usedInLastChunk);
+        std::swap(m_objectsPerChunk, other.m_objectsPerChunk);
+        std::swap(m_activeAllocations, other.m_activeAllocations);
+        return *this;
+    }
+
+    template<typename...Args>
+    T* buy(Args&&...args)
+    {
+        Slot* slot = takeSlot();
+
+        T* result = nullptr;
+
+        try {
+            result = new (slot->storage) T(std::forward<Args>(args)...);
+        }
+        catch(...) {
+            returnSlot(slot);
+            throw;
+        }
+
+        ++m_activeAllocations;
+        return result;
+    }
+
+    void release(T* ptr)
+    {
+        if( ! ptr ) // do nothing when ptr == nullptr
+            return;
+
+        ptr->~T();
+        returnSlot(reinterpret_cast<Slot*>(ptr));
+        --m_activeAllocations;
+    }
+
+    ///
+    /// Releases all objects allocated by the pool and frees its memory
+    ///
+    /// The destructors of the objects are not called, so all pointers
+    /// returned by buy() become invalid at once. This is much faster than
+    /// releasing the objects one by one, e.g. when destroying a tree.
+    ///
+    void clear() noexcept
+    {
+        static_assert(std::is_trivially_destructible_v<T>, "PoolAllocator::clear() would skip the destructors of the objects");
+
+        m_chunks.clear();
+        m_freeList = nullptr;
+        m_usedInLastChunk = 0;
+        m_activeAllocations = 0;
+    }
+
+    size_t activeAllocationsCount() const noexcept
+    {
+        return m_activeAllocations;
+    }
+
+    size_t chunksCount() const noexcept
+    {
+        return m_chunks.size();
+    }
+
+    size_t objectsPerChunk() const noexcept
+    {
+        return m_objectsPerChunk;
+    }
+};
@@ -0,0 +1,260 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+///
+/// A monotonic (bump-pointer) memory arena
+///
+/// Memory is handed out from large chunks by advancing a pointer, so an
+/// allocation costs a few instructions. Individual blocks cannot be
+/// freed; instead all of them are released at once by reset() or by
+/// destroying the arena. This suits temporary structures (e.g. a tree,
+/// which is built, queried and thrown away), whose nodes would otherwise
+/// be released one by one.
+///
+/// The chunks grow geometrically, starting from initialChunkSize bytes.
+/// The arena is not synchronized.
+///
+class MonotonicArena {
+    struct Chunk {
+        std::unique_ptr<std::byte[]> memory;
+        size_t size;
+    };
+
+    static constexpr size_t MaxChunkSize = 16 * 1024 * 1024;
+
+    std::vector<Chunk> m_chunks;
+    std::byte* m_next = nullptr;
+    size_t m_available = 0;
+    size_t m_nextChunkSize;
+    size_t m_bytesAllocated = 0;
+
+    void addChunk(size_t minimumSize)
+    {
+        size_t size = std::max(m_nextChunkSize, minimumSize);
+        m_chunks.push_back({ std::make_unique_for_overwrite<std::byte[]>(size), size });
+        m_next = m_chunks.back().memory.get();
+        m_available = size;
+        m_nextChunkSize = std::min(m_nextChunkSize * 2, std::max(MaxChunkSize, m_nextChunkSize));
+    }
+
+public:
+    explicit MonotonicArena(size_t initialChunkSize = 4096)
+        : m_nextChunkSize(initialChunkSize)
+    {
+        if(initialChunkSize == 0)
+            throw std::invalid_argument("The arena needs a positive chunk size");
+    }
+
+    MonotonicArena(const MonotonicArena&) = delete;
+    MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+    ///
+    /// Returns `bytes` bytes of uninitialized memory, aligned to `alignment`
+    ///
+    /// @exception std::bad_alloc if a new chunk cannot be allocated
+    ///
+    void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t))
+    {
+        void* ptr = m_next;
+        size_t space = m_available;
+
+        if( ! std::align(alignment, bytes, ptr, space) ) {
+            // The padding for the alignment must fit in the new chunk too
+            addChunk(bytes + alignment);
+            ptr = m_next;
+            space = m_available;
+            std::align(alignment, bytes, ptr, space);
+        }
+
+        m_next = static_cast<std::byte*>(ptr) + bytes;
+        m_available = space - bytes;
+        m_bytesAllocated += bytes;
+
+        return ptr;
+    }
+
+    ///
+    /// Releases all memory allocated from the arena
+    ///
+    /// The largest chunk is kept for reuse, so rebuilding a structure of
+    /// the same size does not allocate again. No destructors are called.
+    ///
+    void reset() noexcept
+    {
+        if( ! m_chunks.empty() ) {
+            // Usually the last chunk is the largest, but an oversized block
+            // may have got a larger chunk of its own earlier
+            auto bySize = [](const Chunk& a, const Chunk& b) { return a.size < b.size; };
+            Chunk largest = std::move(*std::max_element(m_chunks.begin(), m_chunks.end(), bySize));
+            m_chunks.clear();
+            m_chunks.push_back(std::move(largest));
+
+            m_next = m_chunks.back().memory.get();
+            m_available = m_chunks.back().size;
+        }
+
+        m_bytesAllocated = 0;
+    }
+
+    /// Bytes handed out since the last reset (without the alignment padding)
+    size_t bytesAllocated() const noexcept
+    {
+        return m_bytesAllocated;
+    }
+
+    /// Total size of the chunks owned by the arena
+    size_t bytesReserved() const noexcept
+    {
+        size_t result = 0;
+
+        for(const Chunk& chunk : m_chunks)
+            result += chunk.size;
+
+        return result;
+    }
+
+    size_t chunksCount() const noexcept
+    {
+        return m_chunks.size();
+    }
+};
+
+///
+/// Allocates objects in a MonotonicArena
+///
+/// Has the buy/release interface of SimpleAllocator, so it can be
+/// used with BinarySearchTree. release() calls the destructor of the
+/// object, but its memory is reclaimed only when the arena is reset.
+///
+/// Several allocators (e.g. of a tree and of a list, which are used
+/// together) can share an arena. A default-constructed allocator has
+/// an arena of its own.
+///
+template <typename T>
+class ArenaAllocator {
+    std::shared_ptr<MonotonicArena> m_arena;
+
+public:
+    ArenaAllocator()
+        : m_arena(std::make_shared<MonotonicArena>())
+    {
+    }
+
+    explicit ArenaAllocator(std::shared_ptr<MonotonicArena> arena)
+        : m_arena(std::move(arena))
+    {
+    }
+
+    ArenaAllocator(const ArenaAllocator&) = default;
+    ArenaAllocator& operator=(const ArenaAllocator&) = default;
+
+    ///
+    /// Takes over the arena of `other` and gives `other` a new one, so
+    /// it can still allocate
+    ///
+    /// @exception std::bad_alloc if the new arena cannot be allocated;
+    /// `other` is not changed then
+    ///
+    ArenaAllocator(ArenaAllocator&& other)
+        : m_arena(std::exchange(other.m_arena, std::make_shared<MonotonicArena>()))
+    {
+    }
+
+    ///
+    /// Exchanges the arenas of both allocators, so `other` can still
+    /// allocate
+    ///
+    ArenaAllocator& operator=(ArenaAllocator&& other) noexcept
+    {
+        std::swap(m_arena, other.m_arena);
+        return *this;
+    }
+
+    template<typename...Args>
+    T* buy(Args&&...args)
+    {
+        void* memory = m_arena->allocate(sizeof(T), alignof(T));
+        return new (memory) T(std::forward<Args>(args)...);
+    }
+
+    void release(T* ptr)
+    {
+        if(ptr)
+            ptr->~T();
+    }
+
+    ///
+    /// Releases all objects at once, without calling their destructors
+    ///
+    /// Resets the arena only if this allocator is its only user, because
+    /// resetting a shared arena would release the objects of the others.
+    /// A shared arena is reset by its owner.
+    ///
+    void clear() noexcept
+    {
+        if(m_arena.use_count() == 1)
+            m_arena->reset();
+    }
+
+    MonotonicArena& arena() const noexcept
+    {
+        return *m_arena;
+    }
+
+    const std::shared_ptr<MonotonicArena>& shared_arena() const noexcept
+    {
+        return m_arena;
+    }
+};
+
+///
+/// A std::pmr::memory_resource, which allocates from a MonotonicArena
+///
+/// Lets the standard containers share an arena with ArenaAllocator, e.g.
+///
+///     MonotonicArena arena;
+///     ArenaResource resource(arena);
+///     std::pmr::vector<int> values(&resource);
+///
+/// Deallocation does nothing. The arena must outlive the resource and
+/// all containers, which use it.
+///
+class ArenaResource : public std::pmr::memory_resource {
+    MonotonicArena& m_arena;
+
+public:
+    explicit ArenaResource(MonotonicArena& arena) noexcept
+        : m_arena(arena)
+    {
+    }
+
+    MonotonicArena& arena() const noexcept
+    {
+        return m_arena;
+    }
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override
+    {
+        return m_arena.allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void*, size_t, size_t) override
+    {
+        // Nothing to do here
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    {
+        const ArenaResource* otherArena = dynamic_cast<const ArenaResource*>(&other);
+        return otherArena && &otherArena->m_arena == &m_arena;
+    }
+};
@@ -0,0 +1,417 @@
+#pragma once
+
+#include "utils/PerfCounters.h"
+#include "utils/Stopwatch.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+///
+/// Tools for writing micro-benchmarks
+///
+/// BenchmarkRunner repeats a piece of code many times after a few
+/// warm-up runs and reports statistics of the time per operation.
+/// The median and the 99th percentile are less affected by
+/// interruptions (other processes, page faults, frequency changes)
+/// than a single measurement or the mean.
+///
+
+#if defined(_MSC_VER) && !defined(__clang__)
+/// Receives the addresses passed to doNotOptimize under MSVC
+inline const volatile void* benchmarkSink = nullptr;
+#endif
+
+///
+/// Makes the compiler assume that value is read by unknown code
+///
+/// Without it the optimizer may remove the code, which computes a
+/// result that is never used, e.g. a lookup loop whose hits are only
+/// counted. The value must be computed, but no instructions are added.
+///
+template <typename T>
+inline void doNotOptimize(const T& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	asm volatile("" : : "r,m"(value) : "memory");
+#elif defined(_MSC_VER)
+	benchmarkSink = &value;
+	_ReadWriteBarrier();
+#else
+	static_cast<void>(value);
+#endif
+}
+
+///
+/// Makes the compiler assume that all memory may be read and written
+///
+/// Prevents it from moving memory accesses across the call, e.g.
+/// the stores of a loop past the end of a time measurement.
+///
+inline void clobberMemory()
+{
+#if defined(__GNUC__) || defined(__clang__)
+	asm volatile("" : : : "memory");
+#elif defined(_MSC_VER)
+	_ReadWriteBarrier();
+#endif
+}
+
+///
+/// Binds the calling thread to a single CPU
+///
+/// Keeps the scheduler from migrating the benchmark to another core,
+/// where its caches are cold. Implemented on Linux only.
+///
+/// \return
+///    true if the thread was pinned
+///
+inline bool pinThreadToCpu(unsigned cpu)
+{
+#if defined(__linux__)
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+	static_cast<void>(cpu);
+	return false;
+#endif
+}
+
+///
+/// Summary of a set of measurements
+///
+struct BenchmarkStatistics {
+	size_t samples = 0;
+	double min = 0;
+	double median = 0;
+	double p99 = 0;
+	double max = 0;
+	double mean = 0;
+	double stddev = 0; // Sample standard deviation
+};
+
+///
+/// Returns the p-th percentile (p in [0, 1]) of sorted, non-empty data
+///
+/// Interpolates linearly between the closest ranks, so the median of
+/// an even number of values is the mean of the two middle ones.
+///
+inline double percentile(const std::vector<double>& sorted, double p)
+{
+	double rank = p * static_cast<double>(sorted.size() - 1);
+	size_t lower = static_cast<size_t>(rank);
+	size_t upper = std::min(lower + 1, sorted.size() - 1);
+	double fraction = rank - static_cast<double>(lower);
+
+	return sorted[lower] + (sorted[upper] - sorted[lower]) * fraction;
+}
+
+inline BenchmarkStatistics computeStatistics(std::vector<double> samples)
+{
+	BenchmarkStatistics result;
+	result.samples = samples.size();
+
+	if (samples.empty())
+		return result;
+
+	std::sort(samples.begin(), samples.end());
+
+	result.min = samples.front();
+	result.max = samples.back();
+	result.median = percentile(samples, 0.5);
+	result.p99 = percentile(samples, 0.99);
+
+	double sum = 0;
+	for (double sample : samples)
+		sum += sample;
+	result.mean = sum / static_cast<double>(samples.size());
+
+	if (samples.size() > 1) {
+		double squares = 0;
+		for (double sample : samples)
+			squares += (sample - result.mean) * (sample - result.mean);
+		result.stddev = std::sqrt(squares / static_cast<double>(samples.size() - 1));
+	}
+
+	return result;
+}
+
+struct BenchmarkOptions {
+	/// Runs, which are executed before measuring, to warm up the caches and the branch predictors
+	size_t warmupRuns = 1;
+
+	/// Measured runs
+	size_t repetitions = 10;
+
+	/// CPU to pin the benchmark to, or -1 to let the scheduler decide
+	int cpu = -1;
+
+	/// If not null, each result is written here as text, as soon as it is measured
+	std::ostream* progress = nullptr;
+
+	/// Count hardware events (cache misses, etc.) with PerfCounters
+	bool countEvents = false;
+};
+
+struct BenchmarkResult {
+	std::string name;      // Benchmarked structure, e.g. "std::unordered_set"
+	std::string operation; // e.g. "fill", "hit", "miss"
+	size_t size;           // Number of elements in the structure
+	size_t operations;     // Operations per run
+	BenchmarkStatistics nanoseconds; // Time per operation
+
+	/// Average number of events per operation, NaN for events, which were not counted
+	std::array<double, PerfCounters::EventsCount> eventsPerOperation;
+};
+
+///
+/// Runs benchmarks and collects their results
+///
+/// Each benchmark is a body, which performs a known number of
+/// operations. It is executed BenchmarkOptions::warmupRuns times
+/// without measuring and then BenchmarkOptions::repetitions times.
+/// The statistics are of the time per operation in nanoseconds.
+///
+/// With BenchmarkOptions::countEvents, the measured runs are also
+/// observed with PerfCounters. The counters are started before and
+/// read after the time measurement, so they do not affect it.
+///
+/// The results can be written as a human-readable table, as CSV or
+/// as JSON, e.g. to be compared between versions of the code.
+///
+class BenchmarkRunner {
+	BenchmarkOptions m_options;
+	bool m_pinned = false;
+	std::unique_ptr<PerfCounters> m_counters;
+	std::vector<BenchmarkResult> m_results;
+
+	static void writeJsonString(std::ostream& out, const std::string& str)
+	{
+		out << '"';
+
+		for (char c : str) {
+			if (c == '"' || c == '\\')
+				out << '\\';
+			out << c;
+		}
+
+		out << '"';
+	}
+
+	/// Writes a quoted CSV field, in which quotes are doubled (RFC 4180)
+	static void writeCsvString(std::ostream& out, const std::string& str)
+	{
+		out << '"';
+
+		for (char c : str) {
+			if (c == '"')
+				out << '"';
+			out << c;
+		}
+
+		out << '"';
+	}
+
+public:
+	explicit BenchmarkRunner(BenchmarkOptions options = BenchmarkOptions())
+		: m_options(options)
+	{
+		if (m_options.cpu >= 0)
+			m_pinned = pinThreadToCpu(static_cast<unsigned>(m_options.cpu));
+
+		if (m_options.countEvents)
+			m_counters = std::make_unique<PerfCounters>();
+	}
+
+	///
+	/// Measures body(state) after each call to setup()
+	///
+	/// setup() returns a fresh state for each run (e.g. an empty table
+	/// to fill) and is not measured. Neither is the destruction of the
+	/// state.
+	///
+	template <typename Setup, typename Body>
+	const BenchmarkResult& run(std::string name, std::string operation, size_t size, size_t operations, Setup setup, Body body)
+	{
+		std::vector<double> samples;
+		samples.reserve(m_options.repetitions);
+
+		std::array<double, PerfCounters::EventsCount> events;
+		events.fill(m_counters ? 0 : NAN);
+
+		double operationsCount = static_cast<double>(std::max<size_t>(operations, 1));
+
+		for (size_t i = 0; i < m_options.warmupRuns + m_options.repetitions; i++) {
+			auto state = setup();
+			Stopwatch sw;
+			bool measured = i >= m_options.warmupRuns;
+
+			if (m_counters && measured)
+				m_counters->start();
+
+			clobberMemory();
+			sw.start();
+			body(state);
+			clobberMemory();
+			sw.stop();
+
+			if (m_counters && measured) {
+				m_counters->stop();
+
+				// An event, which is not counted in some run, becomes NaN
+				for (int e = 0; e < PerfCounters::EventsCount; e++)
+					events[e] += m_counters->value(static_cast<PerfCounters::Event>(e));
+			}
+
+			if (measured)
+				samples.push_back(std::chrono::duration<double, std::nano>(sw.elapsed()).count() / operationsCount);
+		}
+
+		for (double& count : events)
+			count /= operationsCount * static_cast<double>(std::max<size_t>(samples.size(), 1));
+
+		m_results.push_back({ std::move(name), std::move(operation), size, operations, computeStatistics(std::move(samples)), events });
+
+		if (m_options.progress)
+			writeText(*m_options.progress, m_results.back());
+
+		return m_results.back();
+	}
+
+	/// Measures body(), which needs no preparation between runs
+	template <typename Body>
+	const BenchmarkResult& run(std::string name, std::string operation, size_t size, size_t operations, Body body)
+	{
+		return run(std::move(name), std::move(operation), size, operations, []() { return 0; }, [&body](int) { body(); });
+	}
+
+	const std::vector<BenchmarkResult>& results() const noexcept
+	{
+		return m_results;
+	}
+
+	const BenchmarkOptions& options() const noexcept
+	{
+		return m_options;
+	}
+
+	bool pinned() const noexcept
+	{
+		return m_pinned;
+	}
+
+	/// The counters, which are used if BenchmarkOptions::countEvents is set, or nullptr
+	const PerfCounters* counters() const noexcept
+	{
+		return m_counters.get();
+	}
+
+	/// Writes a single result as a line of text
+	static void writeText(std::ostream& out, const BenchmarkResult& result)
+	{
+		const BenchmarkStatistics& ns = result.nanoseconds;
+
+		out
+			<< "    " << result.operation << ": "
+			<< "median " << ns.median << " ns/op"
+			<< " | p99 " << ns.p99
+			<< " | stddev " << ns.stddev
+			<< " | min " << ns.min
+			<< " | max " << ns.max
+			<< " (" << ns.samples << " x " << result.operations << " operations)";
+
+		const char* separator = "\n      per op: ";
+
+		for (int e = 0; e < PerfCounters::EventsCount; e++) {
+			if ( ! std::isnan(result.eventsPerOperation[e]) ) {
+				out << separator << result.eventsPerOperation[e] << " " << PerfCounters::name(static_cast<PerfCounters::Event>(e));
+				separator = ", ";
+			}
+		}
+
+		out << std::endl;
+	}
+
+	void writeCsv(std::ostream& out) const
+	{
+		out << "name,operation,size,operations,samples,median_ns,p99_ns,mean_ns,stddev_ns,min_ns,max_ns";
+
+		// Events per operation, empty if they were not counted
+		for (int e = 0; e < PerfCounters::EventsCount; e++)
+			out << ',' << PerfCounters::key(static_cast<PerfCounters::Event>(e)) << "_per_op";
+
+		out << '\n';
+
+		for (const BenchmarkResult& result : m_results) {
+			const BenchmarkStatistics& ns = result.nanoseconds;
+
+			// Names may contain commas and quotes (e.g. template arguments)
+			writeCsvString(out, result.name);
+			out << ',' << result.operation << ',' << result.size << ',' << result.operations << ','
+				<< ns.samples << ',' << ns.median << ',' << ns.p99 << ',' << ns.mean << ',' << ns.stddev << ',' << ns.min << ',' << ns.max;
+
+			for (double count : result.eventsPerOperation) {
+				out << ',';
+				if ( ! std::isnan(count) )
+					out << count;
+			}
+
+			out << '\n';
+		}
+	}
+
+	void writeJson(std::ostream& out) const
+	{
+		out
+			<< "{\n"
+			<< "  \"warmup_runs\": " << m_options.warmupRuns << ",\n"
+			<< "  \"repetitions\": " << m_options.repetitions << ",\n"
+			<< "  \"pinned_cpu\": " << (m_pinned ? m_options.cpu : -1) << ",\n"
+			<< "  \"results\": [";
+
+		for (size_t i = 0; i < m_results.size(); i++) {
+			const BenchmarkResult& result = m_results[i];
+			const BenchmarkStatistics& ns = result.nanoseconds;
+
+			out << (i ? ",\n" : "\n") << "    {\"name\": ";
+			writeJsonString(out, result.name);
+			out << ", \"operation\": ";
+			writeJsonString(out, result.operation);
+			out
+				<< ", \"size\": " << result.size
+				<< ", \"operations\": " << result.operations
+				<< ", \"samples\": " << ns.samples
+				<< ", \"median_ns\": " << ns.median
+				<< ", \"p99_ns\": " << ns.p99
+				<< ", \"mean_ns\": " << ns.mean
+				<< ", \"stddev_ns\": " << ns.stddev
+				<< ", \"min_ns\": " << ns.min
+				<< ", \"max_ns\": " << ns.max;
+
+			for (int e = 0; e < PerfCounters::EventsCount; e++)
+				if ( ! std::isnan(result.eventsPerOperation[e]) )
+					out << ", \"" << PerfCounters::key(static_cast<PerfCounters::Event>(e)) << "_per_op\": " << result.eventsPerOperation[e];
+
+			out << "}";
+		}
+
+		out << "\n  ]\n}\n";
+	}
+};
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+///
+/// Statistics, collected by CountingAllocator
+///
+/// The sizes are the bytes requested from the allocator. They do not
+/// include the bookkeeping overhead of the heap (usually 8-16 bytes
+/// per block), which depends on the platform.
+///
+struct AllocationCounter {
+    /// Total number of bytes allocated over the lifetime of the counter
+    size_t requestedBytes = 0;
+
+    /// Total number of allocations over the lifetime of the counter
+    size_t allocations = 0;
+
+    /// Bytes currently allocated and not released yet
+    size_t liveBytes = 0;
+
+    /// Blocks currently allocated and not released yet
+    size_t liveBlocks = 0;
+
+    /// The largest value of liveBytes so far
+    size_t peakBytes = 0;
+};
+
+///
+/// A standard-compatible allocator, which counts the memory it allocates
+///
+/// The memory is obtained from std::allocator. All copies of an
+/// allocator, including the ones rebound to other types (e.g. the
+/// node allocator of a std::list), share the same AllocationCounter.
+/// A default-constructed allocator creates a new counter, so each
+/// container, which is created with a default allocator, has its own
+/// statistics.
+///
+/// Counting is not synchronized, so the allocator must not be shared
+/// by containers, which are used from different threads at the same time.
+///
+template <typename T>
+class CountingAllocator {
+    template <typename U>
+    friend class CountingAllocator;
+
+    std::shared_ptr<AllocationCounter> m_counter;
+
+public:
+    using value_type = T;
+
+    // Containers move the counter along with their contents
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    CountingAllocator()
+        : m_counter(std::make_shared<AllocationCounter>())
+    {
+    }
+
+    explicit CountingAllocator(std::shared_ptr<AllocationCounter> counter)
+        : m_counter(std::move(counter))
+    {
+    }
+
+    // Allocators must remain valid after being moved from,
+    // so moving is the same as copying (the counter is shared)
+    CountingAllocator(const CountingAllocator&) noexcept = default;
+    CountingAllocator& operator=(const CountingAllocator&) noexcept = default;
+
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U>& other) noexcept
+        : m_counter(other.m_counter)
+    {
+    }
+
+    T* allocate(size_t count)
+    {
+        T* result = std::allocator<T>().allocate(count);
+
+        size_t bytes = count * sizeof(T);
+        m_counter->requestedBytes += bytes;
+        m_counter->allocations += 1;
+        m_counter->liveBytes += bytes;
+        m_counter->liveBlocks += 1;
+        m_counter->peakBytes = std::max(m_counter->peakBytes, m_counter->liveBytes);
+
+        return result;
+    }
+
+    void deallocate(T* ptr, size_t count) noexcept
+    {
+        std::allocator<T>().deallocate(ptr, count);
+
+        m_counter->liveBytes -= count * sizeof(T);
+        m_counter->liveBlocks -= 1;
+    }
+
+    const AllocationCounter& counter() const noexcept
+    {
+        return *m_counter;
+    }
+
+    /// Allows other allocators to share the counter
+    const std::shared_ptr<AllocationCounter>& shared_counter() const noexcept
+    {
+        return m_counter;
+    }
+
+    /// Memory allocated by one allocator can be released by another, if they share the counter
+    template <typename U>
+    bool operator==(const CountingAllocator<U>& other) const noexcept
+    {
+        return m_counter == other.m_counter;
+    }
+};
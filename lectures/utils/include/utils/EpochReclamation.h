@@ -0,0 +1,231 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+///
+/// Epoch-based memory reclamation for lock-free data structures
+///
+/// A lock-free structure cannot delete a node right after unlinking it,
+/// because other threads may still be reading it. Instead, the node is
+/// retired and deleted later, when no thread can hold a reference to it.
+///
+/// Each thread, which accesses the structure, does so inside a Guard.
+/// While a guard is alive, the thread is "pinned" to the global epoch
+/// it observed. The global epoch advances only when all pinned threads
+/// have observed its current value. Thus, once the epoch has advanced
+/// twice after a node was retired, every thread which could have seen
+/// the node has left its guard, and the node can be deleted.
+///
+/// There is one reclamation domain per process, shared by all structures.
+///
+class EpochReclamation {
+public:
+    using deleter_type = void (*)(void*);
+
+private:
+    static constexpr uint64_t Inactive = std::numeric_limits<uint64_t>::max();
+
+    /// How many objects a thread retires between attempts to reclaim memory
+    static constexpr size_t CollectEvery = 64;
+
+    struct Retired {
+        void* ptr;
+        deleter_type deleter;
+        uint64_t epoch;
+    };
+
+    /// Per-thread state. Records are never deleted before the domain and are reused when a thread exits.
+    struct alignas(64) ThreadRecord {
+        std::atomic<uint64_t> epoch = Inactive;
+        std::atomic<bool> inUse = true;
+        ThreadRecord* next = nullptr;
+
+        // Accessed only by the thread, which owns the record
+        unsigned nesting = 0;
+        std::vector<Retired> retired;
+    };
+
+    /// Releases the record of a thread when the thread exits
+    class ThreadHandle {
+        ThreadRecord* m_record;
+
+    public:
+        explicit ThreadHandle(ThreadRecord* record)
+            : m_record(record)
+        {
+        }
+
+        ~ThreadHandle()
+        {
+            m_record->inUse.store(false, std::memory_order_release);
+        }
+
+        ThreadRecord* record() const noexcept
+        {
+            return m_record;
+        }
+    };
+
+    std::atomic<uint64_t> m_epoch = 0;
+    std::atomic<ThreadRecord*> m_records = nullptr;
+
+    EpochReclamation() = default;
+
+    ThreadRecord* acquireRecord()
+    {
+        // Try to reuse the record of a thread which has exited
+        for(ThreadRecord* p = m_records.load(std::memory_order_acquire); p; p = p->next) {
+            bool expected = false;
+            if( ! p->inUse.load(std::memory_order_relaxed) && p->inUse.compare_exchange_strong(expected, true))
+                return p;
+        }
+
+        ThreadRecord* record = new ThreadRecord();
+        record->next = m_records.load(std::memory_order_relaxed);
+
+        while( ! m_records.compare_exchange_weak(record->next, record, std::memory_order_release, std::memory_order_relaxed))
+            ; // Nothing to do here, record->next has been updated
+
+        return record;
+    }
+
+    ThreadRecord& localRecord()
+    {
+        thread_local ThreadHandle handle(acquireRecord());
+        return *handle.record();
+    }
+
+    /// Advances the global epoch if all pinned threads have observed its current value
+    void tryAdvance()
+    {
+        uint64_t current = m_epoch.load(std::memory_order_seq_cst);
+
+        for(ThreadRecord* p = m_records.load(std::memory_order_acquire); p; p = p->next) {
+            uint64_t local = p->epoch.load(std::memory_order_seq_cst);
+
+            if(local != Inactive && local != current)
+                return;
+        }
+
+        m_epoch.compare_exchange_strong(current, current + 1, std::memory_order_seq_cst);
+    }
+
+    /// Deletes the objects in a list, which were retired at least two epochs ago
+    void collect(std::vector<Retired>& retired)
+    {
+        uint64_t current = m_epoch.load(std::memory_order_seq_cst);
+        size_t kept = 0;
+
+        for(Retired& item : retired) {
+            if(item.epoch + 2 <= current)
+                item.deleter(item.ptr);
+            else
+                retired[kept++] = item;
+        }
+
+        retired.resize(kept);
+    }
+
+public:
+    EpochReclamation(const EpochReclamation&) = delete;
+    EpochReclamation& operator=(const EpochReclamation&) = delete;
+
+    /// Deletes all retired objects. By this time there are no other threads left.
+    ~EpochReclamation()
+    {
+        ThreadRecord* p = m_records.load();
+
+        while(p) {
+            for(Retired& item : p->retired)
+                item.deleter(item.ptr);
+
+            ThreadRecord* next = p->next;
+            delete p;
+            p = next;
+        }
+    }
+
+    static EpochReclamation& instance()
+    {
+        static EpochReclamation domain;
+        return domain;
+    }
+
+    ///
+    /// Marks the calling thread as accessing shared objects for the lifetime of the guard
+    ///
+    /// Guards can be nested. Objects read inside a guard remain valid
+    /// until the outermost guard is destroyed, even if they are retired.
+    ///
+    class Guard {
+        EpochReclamation& m_domain;
+        ThreadRecord& m_record;
+
+    public:
+        explicit Guard(EpochReclamation& domain = EpochReclamation::instance())
+            : m_domain(domain), m_record(domain.localRecord())
+        {
+            if(m_record.nesting++ == 0) {
+                uint64_t epoch;
+
+                // The epoch may advance between reading and announcing it.
+                // Announcing an outdated epoch could let another thread
+                // free objects we are about to read, so repeat until the
+                // announced value is current.
+                do {
+                    epoch = m_domain.m_epoch.load(std::memory_order_seq_cst);
+                    m_record.epoch.store(epoch, std::memory_order_seq_cst);
+                } while(epoch != m_domain.m_epoch.load(std::memory_order_seq_cst));
+            }
+        }
+
+        ~Guard()
+        {
+            if(--m_record.nesting == 0)
+                m_record.epoch.store(Inactive, std::memory_order_release);
+        }
+
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+    };
+
+    ///
+    /// Schedules an object, which is no longer reachable by new readers, for deletion
+    ///
+    /// `deleter(ptr)` is called once no thread can hold a reference to the object.
+    /// Must be called inside a Guard.
+    ///
+    void retire(void* ptr, deleter_type deleter)
+    {
+        ThreadRecord& record = localRecord();
+        record.retired.push_back(Retired{ptr, deleter, m_epoch.load(std::memory_order_seq_cst)});
+
+        if(record.retired.size() % CollectEvery == 0) {
+            tryAdvance();
+            collect(record.retired);
+        }
+    }
+
+    /// Convenience overload for objects allocated with new
+    template <typename T>
+    void retire(T* ptr)
+    {
+        retire(ptr, [](void* p) { delete static_cast<T*>(p); });
+    }
+
+    /// Tries to advance the epoch and reclaim the objects retired by the calling thread
+    void reclaim()
+    {
+        tryAdvance();
+        collect(localRecord().retired);
+    }
+
+    /// Number of objects retired by the calling thread, which have not been deleted yet
+    size_t pendingCount()
+    {
+        return localRecord().retired.size();
+    }
+};
@@ -0,0 +1,206 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+
+///
+/// A histogram of durations (or any other non-negative integers) with bounded relative error
+///
+/// The buckets are log-linear, as in HdrHistogram: each power of two
+/// range [2^k, 2^(k+1)) is split into SubBucketsCount equal buckets.
+/// Thus a value is known with a relative error of at most
+/// 1 / SubBucketsCount (about 3%) over the whole 64-bit range, with
+/// less than 2000 buckets. Values below 2 * SubBucketsCount are exact.
+///
+/// record() is lock-free and wait-free for the buckets: it increments
+/// a counter with a relaxed atomic operation, so any number of threads
+/// can record into the same histogram. The statistics (percentile(),
+/// count(), ...) can be read at any time, but while other threads are
+/// recording, they may not include the latest values.
+///
+class LatencyHistogram {
+public:
+    static constexpr unsigned SubBucketBits = 5;
+    static constexpr uint64_t SubBucketsCount = uint64_t(1) << SubBucketBits;
+    static constexpr size_t BucketsCount = (64 - SubBucketBits + 1) * SubBucketsCount;
+
+private:
+    std::atomic<uint64_t> m_counts[BucketsCount];
+    std::atomic<uint64_t> m_sum{0};
+    std::atomic<uint64_t> m_min{std::numeric_limits<uint64_t>::max()};
+    std::atomic<uint64_t> m_max{0};
+
+    void updateExtremes(uint64_t min, uint64_t max) noexcept
+    {
+        // Usually the extremes do not change, so these are only loads
+        uint64_t current = m_min.load(std::memory_order_relaxed);
+        while (min < current && !m_min.compare_exchange_weak(current, min, std::memory_order_relaxed))
+            ;
+
+        current = m_max.load(std::memory_order_relaxed);
+        while (max > current && !m_max.compare_exchange_weak(current, max, std::memory_order_relaxed))
+            ;
+    }
+
+public:
+    LatencyHistogram()
+    {
+        for (std::atomic<uint64_t>& count : m_counts)
+            count.store(0, std::memory_order_relaxed);
+    }
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    /// Returns the index of the bucket, which holds value
+    static constexpr size_t bucketFor(uint64_t value) noexcept
+    {
+        if (value < SubBucketsCount)
+            return static_cast<size_t>(value);
+
+        unsigned shift = static_cast<unsigned>(std::bit_width(value)) - 1 - SubBucketBits;
+        return static_cast<size_t>((shift + 1) * SubBucketsCount + ((value >> shift) - SubBucketsCount));
+    }
+
+    /// The smallest value, which falls in a bucket
+    static constexpr uint64_t lowestValueIn(size_t bucket) noexcept
+    {
+        if (bucket < 2 * SubBucketsCount)
+            return bucket;
+
+        unsigned shift = static_cast<unsigned>(bucket / SubBucketsCount) - 1;
+        return (bucket % SubBucketsCount + SubBucketsCount) << shift;
+    }
+
+    /// The largest value, which falls in a bucket
+    static constexpr uint64_t highestValueIn(size_t bucket) noexcept
+    {
+        if (bucket < 2 * SubBucketsCount)
+            return bucket;
+
+        unsigned shift = static_cast<unsigned>(bucket / SubBucketsCount) - 1;
+        return lowestValueIn(bucket) + (uint64_t(1) << shift) - 1;
+    }
+
+    void record(uint64_t value) noexcept
+    {
+        m_counts[bucketFor(value)].fetch_add(1, std::memory_order_relaxed);
+        m_sum.fetch_add(value, std::memory_order_relaxed);
+        updateExtremes(value, value);
+    }
+
+    /// Adds all values from another histogram
+    void merge(const LatencyHistogram& other) noexcept
+    {
+        for (size_t i = 0; i < BucketsCount; ++i)
+            m_counts[i].fetch_add(other.m_counts[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+        m_sum.fetch_add(other.m_sum.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+        if (other.count() > 0)
+            updateExtremes(other.min(), other.max());
+    }
+
+    /// Removes all values. Must not be called while other threads are recording.
+    void reset() noexcept
+    {
+        for (std::atomic<uint64_t>& count : m_counts)
+            count.store(0, std::memory_order_relaxed);
+
+        m_sum.store(0, std::memory_order_relaxed);
+        m_min.store(std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed);
+        m_max.store(0, std::memory_order_relaxed);
+    }
+
+    uint64_t count() const noexcept
+    {
+        uint64_t result = 0;
+
+        for (const std::atomic<uint64_t>& count : m_counts)
+            result += count.load(std::memory_order_relaxed);
+
+        return result;
+    }
+
+    /// The smallest recorded value (exact), or 0 if there are none
+    uint64_t min() const noexcept
+    {
+        uint64_t value = m_min.load(std::memory_order_relaxed);
+        return value == std::numeric_limits<uint64_t>::max() ? 0 : value;
+    }
+
+    /// The largest recorded value (exact)
+    uint64_t max() const noexcept
+    {
+        return m_max.load(std::memory_order_relaxed);
+    }
+
+    double mean() const noexcept
+    {
+        uint64_t n = count();
+        return n ? static_cast<double>(m_sum.load(std::memory_order_relaxed)) / static_cast<double>(n) : 0;
+    }
+
+    ///
+    /// Returns the value, below or at which are `percent` percent of the values
+    ///
+    /// The result is the highest value in the bucket of the percentile
+    /// (but not more than max()), so it is never less than the exact one.
+    ///
+    uint64_t percentile(double percent) const noexcept
+    {
+        uint64_t total = count();
+
+        if (total == 0)
+            return 0;
+
+        if (percent <= 0)
+            return min();
+
+        // The rank of the value, from 1 to total
+        uint64_t rank = static_cast<uint64_t>(std::ceil(percent / 100.0 * static_cast<double>(total)));
+        rank = std::max<uint64_t>(1, std::min(rank, total));
+
+        uint64_t seen = 0;
+
+        for (size_t i = 0; i < BucketsCount; ++i) {
+            seen += m_counts[i].load(std::memory_order_relaxed);
+
+            if (seen >= rank)
+                return std::min(highestValueIn(i), max());
+        }
+
+        return max();
+    }
+
+    /// Prints the number of values and the main percentiles, assuming the values are nanoseconds
+    void printInfo(std::ostream& out) const
+    {
+        if (count() == 0) {
+            out << "[No results to report yet]";
+            return;
+        }
+
+        out
+            << count() << " samples"
+            << " | min " << min() << "ns"
+            << " | p50 " << percentile(50) << "ns"
+            << " | p90 " << percentile(90) << "ns"
+            << " | p99 " << percentile(99) << "ns"
+            << " | p99.9 " << percentile(99.9) << "ns"
+            << " | max " << max() << "ns"
+            << " | mean " << mean() << "ns";
+    }
+
+    friend std::ostream& operator<<(std::ostream& out, const LatencyHistogram& histogram)
+    {
+        histogram.printInfo(out);
+        return out;
+    }
+};
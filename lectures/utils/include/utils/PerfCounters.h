@@ -0,0 +1,208 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+///
+/// Counts hardware events (cycles, cache misses, ...) of the calling thread
+///
+/// Used like Stopwatch: start() and stop() around the measured code,
+/// after which value() returns the number of events in between.
+/// The counters are read through the Linux perf_event_open interface
+/// and count only user-space events of the thread, which created the
+/// object.
+///
+/// A counter may be unavailable: on other systems, in virtual machines
+/// without a PMU, or when /proc/sys/kernel/perf_event_paranoid does not
+/// allow it. Then counted() returns false and value() returns NaN.
+/// The other counters work normally.
+///
+/// When more events are requested than the CPU can count at the same
+/// time, the kernel multiplexes them and the values are estimates,
+/// scaled by the fraction of the time the counter was running.
+///
+class PerfCounters {
+public:
+	enum Event {
+		Cycles,
+		Instructions,
+		CacheMisses,   // Last level cache misses
+		BranchMisses,  // Mispredicted branches
+		DtlbMisses,    // Data TLB read misses
+		PageFaults,    // Counted by the kernel, so available even without a PMU
+		EventsCount
+	};
+
+private:
+	int m_fd[EventsCount];
+	double m_values[EventsCount];
+
+#if defined(__linux__)
+	static int openCounter(Event event)
+	{
+		perf_event_attr attr;
+		std::memset(&attr, 0, sizeof(attr));
+
+		attr.size = sizeof(attr);
+		attr.type = PERF_TYPE_HARDWARE;
+		attr.disabled = 1;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+		switch (event) {
+		case Cycles:       attr.config = PERF_COUNT_HW_CPU_CYCLES; break;
+		case Instructions: attr.config = PERF_COUNT_HW_INSTRUCTIONS; break;
+		case CacheMisses:  attr.config = PERF_COUNT_HW_CACHE_MISSES; break;
+		case BranchMisses: attr.config = PERF_COUNT_HW_BRANCH_MISSES; break;
+		case DtlbMisses:
+			attr.type = PERF_TYPE_HW_CACHE;
+			attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+			break;
+		case PageFaults:
+			attr.type = PERF_TYPE_SOFTWARE;
+			attr.config = PERF_COUNT_SW_PAGE_FAULTS;
+			break;
+		default:
+			return -1;
+		}
+
+		// This thread, any CPU, no group
+		return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+	}
+#endif
+
+public:
+	PerfCounters()
+	{
+		for (int i = 0; i < EventsCount; i++) {
+#if defined(__linux__)
+			m_fd[i] = openCounter(static_cast<Event>(i));
+#else
+			m_fd[i] = -1;
+#endif
+			m_values[i] = NAN;
+		}
+	}
+
+	PerfCounters(const PerfCounters&) = delete;
+	PerfCounters& operator=(const PerfCounters&) = delete;
+
+	~PerfCounters()
+	{
+#if defined(__linux__)
+		for (int fd : m_fd)
+			if (fd >= 0)
+				close(fd);
+#endif
+	}
+
+	/// Checks if at least one of the counters is available
+	bool available() const noexcept
+	{
+		for (int fd : m_fd)
+			if (fd >= 0)
+				return true;
+
+		return false;
+	}
+
+	/// Checks if an event is counted
+	bool available(Event event) const noexcept
+	{
+		return m_fd[event] >= 0;
+	}
+
+	void start()
+	{
+#if defined(__linux__)
+		for (int fd : m_fd) {
+			if (fd >= 0) {
+				ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+				ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+			}
+		}
+#endif
+	}
+
+	void stop()
+	{
+#if defined(__linux__)
+		for (int fd : m_fd)
+			if (fd >= 0)
+				ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+
+		for (int i = 0; i < EventsCount; i++) {
+			// The value, followed by the times the counter was enabled and running
+			uint64_t data[3] = {};
+			m_values[i] = NAN;
+
+			if (m_fd[i] >= 0 && read(m_fd[i], data, sizeof(data)) == sizeof(data) && data[2] > 0)
+				m_values[i] = static_cast<double>(data[0]) * static_cast<double>(data[1]) / static_cast<double>(data[2]);
+		}
+#endif
+	}
+
+	/// Number of events between the last calls to start() and stop(), or NaN if it is unknown
+	double value(Event event) const noexcept
+	{
+		return m_values[event];
+	}
+
+	/// Checks if value(event) is known
+	bool counted(Event event) const noexcept
+	{
+		return ! std::isnan(m_values[event]);
+	}
+
+	static const char* name(Event event) noexcept
+	{
+		static const char* names[EventsCount] = { "cycles", "instructions", "cache misses", "branch misses", "dTLB misses", "page faults" };
+		return event < EventsCount ? names[event] : "?";
+	}
+
+	/// Short name, suitable for a CSV column or a JSON key
+	static const char* key(Event event) noexcept
+	{
+		static const char* keys[EventsCount] = { "cycles", "instructions", "cache_misses", "branch_misses", "dtlb_misses", "page_faults" };
+		return event < EventsCount ? keys[event] : "unknown";
+	}
+
+	void printInfo(std::ostream& out) const
+	{
+		if ( ! available() ) {
+			out << "[No performance counters available]";
+			return;
+		}
+
+		const char* separator = "";
+
+		for (int i = 0; i < EventsCount; i++) {
+			if (counted(static_cast<Event>(i))) {
+				out << separator << static_cast<uint64_t>(m_values[i]) << " " << name(static_cast<Event>(i));
+				separator = ", ";
+			}
+		}
+
+		if ( ! *separator )
+			out << "[No results to report yet]";
+
+		if (counted(Cycles) && counted(Instructions) && m_values[Cycles] > 0)
+			out << " (IPC " << m_values[Instructions] / m_values[Cycles] << ")";
+	}
+
+	friend std::ostream& operator<<(std::ostream& out, const PerfCounters& counters)
+	{
+		counters.printInfo(out);
+		return out;
+	}
+};
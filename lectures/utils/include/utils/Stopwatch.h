@@ -4,9 +4,10 @@
 #include <iostream>
 
 class Stopwatch {
-
+public:
 	using clock = std::chrono::steady_clock;
 
+private:
 	clock::time_point m_start;
 	clock::time_point m_end;
 
@@ -22,6 +23,12 @@ public:
 		m_end = clock::now();
 	}
 
+	/// Time between the last calls to start() and stop()
+	clock::duration elapsed() const
+	{
+		return m_end - m_start;
+	}
+
 	void printInfo(std::ostream& out) const
 	{
 		if(m_end < m_start)
@@ -0,0 +1,331 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if defined(__has_include)
+#if __has_include(<execinfo.h>)
+#include <execinfo.h>
+#define UTILS_HAS_BACKTRACE 1
+#endif
+#endif
+
+#if defined(_MSC_VER) && !defined(UTILS_HAS_BACKTRACE)
+#include <intrin.h>
+#endif
+
+///
+/// Where a sampled allocation was made
+///
+struct AllocationSite {
+    static constexpr size_t MaxFrames = 8;
+
+    /// Return addresses, innermost first. Can be resolved with addr2line or a debugger.
+    std::array<void*, MaxFrames> frames{};
+    size_t framesCount = 0;
+
+    /// Sequential number of the allocation in its allocator
+    uint64_t sequence = 0;
+};
+
+///
+/// Options of TrackingAllocator
+///
+struct TrackingOptions {
+    /// Every sampleEvery-th allocation of each thread records its call site. 0 disables sampling.
+    size_t sampleEvery = 1024;
+
+    /// Allocations after the first failAfter ones throw std::bad_alloc
+    size_t failAfter = std::numeric_limits<size_t>::max();
+
+    /// Probability of an allocation to throw std::bad_alloc (pseudo-random, reproducible)
+    double failureProbability = 0;
+
+    /// Seed for failureProbability
+    uint64_t seed = 42;
+};
+
+///
+/// Returns a small index for the calling thread, used to spread counters over cache lines
+///
+inline size_t currentThreadStripe() noexcept
+{
+    static std::atomic<size_t> nextStripe{0};
+    thread_local size_t stripe = nextStripe.fetch_add(1, std::memory_order_relaxed);
+    return stripe;
+}
+
+///
+/// A thread-safe allocator, which detects leaks and injects faults
+///
+/// Has the interface of DebugAllocator (buy, release, failAfter and
+/// the counters), but is cheap enough to stay enabled under load:
+///
+/// - The counters are striped: each thread increments the counters in
+///   its own cache line, and they are only summed when read.
+///
+/// - Only every TrackingOptions::sampleEvery-th allocation of a thread
+///   is recorded in a table (under a mutex) together with its call
+///   stack. The exact number of leaked objects is known from the
+///   counters; the samples show where the leaks probably come from.
+///
+/// - Each object is preceded by a small header, which tells whether
+///   it was sampled, so release() needs no lookup for most objects.
+///
+/// Unlike DebugAllocator, it does not know all live objects, so it
+/// cannot recognize foreign pointers and double releases. Releasing
+/// such a pointer is undefined behavior, as with delete (AddressSanitizer
+/// reports it). Use DebugAllocator to test for such errors.
+///
+/// Faults are injected after a number of allocations (as with
+/// DebugAllocator::failAfter) or at random with a given probability,
+/// to exercise the out-of-memory paths of the code.
+///
+template <typename T>
+class TrackingAllocator {
+    struct Header {
+        bool sampled;
+    };
+
+    static constexpr size_t Alignment = std::max(alignof(T), alignof(Header));
+    static constexpr size_t HeaderOffset = (sizeof(Header) + Alignment - 1) / Alignment * Alignment;
+
+    struct alignas(64) Stripe {
+        std::atomic<size_t> allocations{0};
+        std::atomic<size_t> releases{0};
+    };
+
+    static constexpr size_t StripesCount = 16;
+
+    Stripe m_stripes[StripesCount];
+    std::atomic<size_t> m_attempts{0};   // Counted only while fault injection is enabled
+    std::atomic<bool> m_injectFaults{false};
+    std::atomic<size_t> m_failAfter;
+    double m_failureProbability;
+    uint64_t m_seed;
+    size_t m_sampleEvery;
+
+    mutable std::mutex m_samplesMutex;
+    std::unordered_map<const void*, AllocationSite> m_samples;
+
+    static void* allocateBlock()
+    {
+        if constexpr (Alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+            return ::operator new(HeaderOffset + sizeof(T), std::align_val_t(Alignment));
+        else
+            return ::operator new(HeaderOffset + sizeof(T));
+    }
+
+    static void deallocateBlock(void* block) noexcept
+    {
+        if constexpr (Alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+            ::operator delete(block, std::align_val_t(Alignment));
+        else
+            ::operator delete(block);
+    }
+
+    static Header* headerOf(T* ptr) noexcept
+    {
+        return reinterpret_cast<Header*>(reinterpret_cast<unsigned char*>(ptr) - HeaderOffset);
+    }
+
+    Stripe& stripe() noexcept
+    {
+        return m_stripes[currentThreadStripe() % StripesCount];
+    }
+
+    void updateFaultInjection() noexcept
+    {
+        m_injectFaults.store(
+            m_failAfter.load(std::memory_order_relaxed) != std::numeric_limits<size_t>::max() || m_failureProbability > 0,
+            std::memory_order_relaxed);
+    }
+
+    bool shouldFail() noexcept
+    {
+        size_t attempt = m_attempts.fetch_add(1, std::memory_order_relaxed);
+
+        if(attempt >= m_failAfter.load(std::memory_order_relaxed))
+            return true;
+
+        if(m_failureProbability > 0) {
+            // A hash of the attempt number, so that the failures do not depend on the threads
+            uint64_t x = (attempt + 1) ^ m_seed;
+            x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+            x ^= x >> 31;
+
+            return static_cast<double>(x >> 11) * 0x1.0p-53 < m_failureProbability;
+        }
+
+        return false;
+    }
+
+    void recordSample(const T* ptr)
+    {
+        AllocationSite site;
+
+#if defined(UTILS_HAS_BACKTRACE)
+        int count = backtrace(site.frames.data(), static_cast<int>(site.frames.size()));
+        site.framesCount = count > 0 ? static_cast<size_t>(count) : 0;
+#elif defined(__GNUC__) || defined(__clang__)
+        site.frames[0] = __builtin_return_address(0);
+        site.framesCount = 1;
+#elif defined(_MSC_VER)
+        site.frames[0] = _ReturnAddress();
+        site.framesCount = 1;
+#endif
+
+        site.sequence = totalAllocationsCount();
+
+        std::lock_guard<std::mutex> lock(m_samplesMutex);
+        m_samples[ptr] = site;
+    }
+
+public:
+    explicit TrackingAllocator(TrackingOptions options = TrackingOptions())
+        : m_failAfter(options.failAfter),
+          m_failureProbability(options.failureProbability),
+          m_seed(options.seed),
+          m_sampleEvery(options.sampleEvery)
+    {
+        updateFaultInjection();
+    }
+
+    /// Same as DebugAllocator(failAfter)
+    explicit TrackingAllocator(size_t failAfter)
+        : TrackingAllocator(TrackingOptions{ 1024, failAfter })
+    {
+    }
+
+    TrackingAllocator(const TrackingAllocator&) = delete;
+    TrackingAllocator& operator=(const TrackingAllocator&) = delete;
+
+    template<typename...Args>
+    T* buy(Args&&...args)
+    {
+        if(m_injectFaults.load(std::memory_order_relaxed) && shouldFail())
+            throw std::bad_alloc();
+
+        void* memory = allocateBlock();
+        T* result = nullptr;
+
+        try {
+            result = new (static_cast<unsigned char*>(memory) + HeaderOffset) T(std::forward<Args>(args)...);
+        }
+        catch(...) {
+            deallocateBlock(memory);
+            throw;
+        }
+
+        thread_local size_t untilSample = 0;
+        bool sampled = m_sampleEvery > 0 && ++untilSample >= m_sampleEvery;
+
+        if(sampled) {
+            untilSample = 0;
+
+            try {
+                recordSample(result);
+            }
+            catch(...) {
+                // Not being able to record a sample is not an error of the caller
+                sampled = false;
+            }
+        }
+
+        headerOf(result)->sampled = sampled;
+
+        stripe().allocations.fetch_add(1, std::memory_order_relaxed);
+        return result;
+    }
+
+    void release(T* ptr)
+    {
+        if( ! ptr ) // do nothing when ptr == nullptr
+            return;
+
+        Header* header = headerOf(ptr);
+
+        if(header->sampled) {
+            std::lock_guard<std::mutex> lock(m_samplesMutex);
+            m_samples.erase(ptr);
+        }
+
+        ptr->~T();
+        deallocateBlock(header);
+
+        stripe().releases.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    size_t activeAllocationsCount() const noexcept
+    {
+        size_t allocations = 0, releases = 0;
+
+        for(const Stripe& s : m_stripes) {
+            allocations += s.allocations.load(std::memory_order_relaxed);
+            releases += s.releases.load(std::memory_order_relaxed);
+        }
+
+        return allocations - releases;
+    }
+
+    size_t totalAllocationsCount() const noexcept
+    {
+        size_t result = 0;
+
+        for(const Stripe& s : m_stripes)
+            result += s.allocations.load(std::memory_order_relaxed);
+
+        return result;
+    }
+
+    ///
+    /// Makes the allocations after the next `value` ones fail
+    ///
+    /// As with DebugAllocator, the count includes the allocations made so far.
+    ///
+    void failAfter(size_t value)
+    {
+        m_attempts.store(totalAllocationsCount(), std::memory_order_relaxed);
+        m_failAfter.store(value, std::memory_order_relaxed);
+        updateFaultInjection();
+    }
+
+    /// The sampled allocations, which were not released yet
+    std::vector<std::pair<const void*, AllocationSite>> sampledLeaks() const
+    {
+        std::lock_guard<std::mutex> lock(m_samplesMutex);
+        std::vector<std::pair<const void*, AllocationSite>> result(m_samples.begin(), m_samples.end());
+
+        std::sort(result.begin(), result.end(), [](const auto& a, const auto& b) { return a.second.sequence < b.second.sequence; });
+        return result;
+    }
+
+    /// Prints the number of live objects and the call stacks of the sampled ones
+    void printLeaks(std::ostream& out) const
+    {
+        std::vector<std::pair<const void*, AllocationSite>> leaks = sampledLeaks();
+
+        out << activeAllocationsCount() << " live objects of " << sizeof(T) << " bytes, "
+            << leaks.size() << " of them sampled (1 in " << m_sampleEvery << ")\n";
+
+        for(const auto& [address, site] : leaks) {
+            out << "  #" << site.sequence << " at " << address << ", allocated from";
+
+            for(size_t i = 0; i < site.framesCount; ++i)
+                out << ' ' << site.frames[i];
+
+            out << '\n';
+        }
+    }
+};
@@ -0,0 +1,317 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+///
+/// Key distributions for benchmarking containers
+///
+/// Sequential integers are the best case for most hash tables (and
+/// std::hash<int> is the identity), but real keys are rarely like
+/// that. The generators below produce the keys, which are inserted
+/// into a container, and the keys, which are looked up afterwards.
+/// All of them are deterministic for a given seed, so that different
+/// containers (and different versions of a container) get the same keys.
+///
+
+///
+/// Keys for a benchmark
+///
+template <typename Key>
+struct Workload {
+    /// Inserted into the container, in this order. All are distinct.
+    std::vector<Key> keys;
+
+    /// Lookups of keys, which are in the container
+    std::vector<Key> hits;
+
+    /// Lookups of keys, which are not in the container
+    std::vector<Key> misses;
+};
+
+///
+/// A bijective mixing function for 64-bit integers (the splitmix64 finalizer)
+///
+/// Different inputs give different outputs, so mixing 0, 1, 2, ...
+/// gives distinct keys, which look random.
+///
+inline uint64_t scrambleKey(uint64_t x) noexcept
+{
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+///
+/// Generates ranks in [0, n) with probability proportional to 1 / (rank + 1)^exponent
+///
+/// In a Zipf distribution a few keys receive most of the lookups
+/// (e.g. with exponent 0.99 and a million keys, the 1% most popular
+/// keys get about 60% of the lookups), as in caches and web traffic.
+/// The distribution is precomputed as a table of cumulative
+/// probabilities, which is searched with binary search.
+///
+class ZipfDistribution {
+    std::vector<double> m_cdf;
+
+public:
+    ZipfDistribution(size_t n, double exponent)
+        : m_cdf(n)
+    {
+        if (n == 0)
+            throw std::invalid_argument("the Zipf distribution needs at least one rank");
+
+        double sum = 0;
+
+        for (size_t i = 0; i < n; ++i) {
+            sum += 1.0 / std::pow(static_cast<double>(i + 1), exponent);
+            m_cdf[i] = sum;
+        }
+
+        for (double& value : m_cdf)
+            value /= sum;
+    }
+
+    template <typename Generator>
+    size_t operator()(Generator& generator) const
+    {
+        double p = std::uniform_real_distribution<double>(0.0, 1.0)(generator);
+        auto it = std::lower_bound(m_cdf.begin(), m_cdf.end(), p);
+        return std::min(static_cast<size_t>(it - m_cdf.begin()), m_cdf.size() - 1);
+    }
+};
+
+///
+/// Keys 0, 1, 2, ... looked up in the same order
+///
+inline Workload<int> sequentialWorkload(size_t size, size_t lookups)
+{
+    Workload<int> result;
+    int n = static_cast<int>(size);
+
+    for (int i = 0; i < n; ++i)
+        result.keys.push_back(i);
+
+    for (size_t i = 0; i < lookups; ++i) {
+        result.hits.push_back(static_cast<int>(i % size));
+        result.misses.push_back(n + static_cast<int>(i));
+    }
+
+    return result;
+}
+
+///
+/// Negative keys -1, -2, -3, ... looked up in random order
+///
+/// Catches tables, which compute bucket indices from a signed hash.
+///
+inline Workload<int> negativeWorkload(size_t size, size_t lookups, uint64_t seed = 42)
+{
+    Workload<int> result;
+    std::mt19937_64 random(seed);
+    int n = static_cast<int>(size);
+
+    for (int i = 0; i < n; ++i)
+        result.keys.push_back(-1 - i);
+
+    for (size_t i = 0; i < lookups; ++i) {
+        result.hits.push_back(result.keys[random() % size]);
+        result.misses.push_back(-1 - n - static_cast<int>(i));
+    }
+
+    return result;
+}
+
+///
+/// Clusters of 32 consecutive keys, 4096 apart, looked up in random order
+///
+/// Resembles IDs, which are allocated in blocks. The low bits of the
+/// keys take only 32 of their possible values, so tables which use
+/// them directly as a bucket index get long chains. The misses are
+/// the gaps between the clusters.
+///
+inline Workload<int> clusteredWorkload(size_t size, size_t lookups, uint64_t seed = 42)
+{
+    const int clusterSize = 32;
+    const int clusterStride = 4096;
+
+    auto key = [=](size_t i) { return static_cast<int>(i / clusterSize) * clusterStride + static_cast<int>(i % clusterSize); };
+
+    Workload<int> result;
+    std::mt19937_64 random(seed);
+
+    for (size_t i = 0; i < size; ++i)
+        result.keys.push_back(key(i));
+
+    for (size_t i = 0; i < lookups; ++i) {
+        result.hits.push_back(result.keys[random() % size]);
+        result.misses.push_back(key(random() % size) + clusterSize);
+    }
+
+    return result;
+}
+
+///
+/// Uniformly distributed 64-bit keys, looked up in random order
+///
+inline Workload<uint64_t> randomWorkload(size_t size, size_t lookups, uint64_t seed = 42)
+{
+    Workload<uint64_t> result;
+    std::mt19937_64 random(seed);
+
+    // Keys are the scrambled values of [0, size), misses of [size, 2 * size)
+    for (size_t i = 0; i < size; ++i)
+        result.keys.push_back(scrambleKey(i ^ seed));
+
+    for (size_t i = 0; i < lookups; ++i) {
+        result.hits.push_back(result.keys[random() % size]);
+        result.misses.push_back(scrambleKey((size + random() % size) ^ seed));
+    }
+
+    return result;
+}
+
+///
+/// The keys of randomWorkload, looked up with a Zipf distribution
+///
+/// The popularity of a key does not depend on its value or on its
+/// position in the container.
+///
+inline Workload<uint64_t> zipfWorkload(size_t size, size_t lookups, double exponent = 0.99, uint64_t seed = 42)
+{
+    Workload<uint64_t> result = randomWorkload(size, 0, seed);
+    std::mt19937_64 random(seed + 1);
+    ZipfDistribution zipf(size, exponent);
+
+    for (size_t i = 0; i < lookups; ++i) {
+        result.hits.push_back(result.keys[zipf(random)]);
+        result.misses.push_back(scrambleKey((size + zipf(random)) ^ seed));
+    }
+
+    return result;
+}
+
+///
+/// Short string IDs ("user-0", "user-1", ...), looked up in random order
+///
+/// They fit in the small string buffer of std::string and share a prefix.
+///
+inline Workload<std::string> shortStringWorkload(size_t size, size_t lookups, uint64_t seed = 42)
+{
+    Workload<std::string> result;
+    std::mt19937_64 random(seed);
+
+    for (size_t i = 0; i < size; ++i)
+        result.keys.push_back("user-" + std::to_string(i));
+
+    for (size_t i = 0; i < lookups; ++i) {
+        result.hits.push_back(result.keys[random() % size]);
+        result.misses.push_back("user-" + std::to_string(size + random() % size));
+    }
+
+    return result;
+}
+
+///
+/// Random strings of 64 to 255 letters, looked up in random order
+///
+/// Hashing and comparing them takes longer than finding their position
+/// in a table. The strings are random, so they are distinct in practice.
+///
+inline Workload<std::string> longStringWorkload(size_t size, size_t lookups, uint64_t seed = 42)
+{
+    Workload<std::string> result;
+    std::mt19937_64 random(seed);
+
+    auto randomString = [&random]() {
+        std::string str(64 + random() % 192, ' ');
+        for (char& c : str)
+            c = static_cast<char>('a' + random() % 26);
+        return str;
+    };
+
+    for (size_t i = 0; i < size; ++i)
+        result.keys.push_back(randomString());
+
+    for (size_t i = 0; i < lookups; ++i) {
+        result.hits.push_back(result.keys[random() % size]);
+        result.misses.push_back(randomString());
+    }
+
+    return result;
+}
+
+///
+/// Percentages of the operations in a mixed workload
+///
+struct OperationMix {
+    unsigned insert = 0;
+    unsigned lookup = 100;
+    unsigned erase = 0;
+};
+
+enum class OperationType { Insert, Lookup, Erase };
+
+template <typename Key>
+struct Operation {
+    OperationType type;
+    Key key;
+};
+
+///
+/// Generates a sequence of operations on a container, which holds workload.keys
+///
+/// Lookups follow the distribution of workload.hits. Insertions add
+/// keys from workload.misses, and erasures remove them again, oldest
+/// first, so that with equal insert and erase percentages the size of
+/// the container stays constant. When there is nothing left to remove,
+/// an erasure removes one of the original keys.
+///
+template <typename Key>
+std::vector<Operation<Key>> generateOperations(const Workload<Key>& workload, OperationMix mix, size_t count, uint64_t seed = 42)
+{
+    unsigned total = mix.insert + mix.lookup + mix.erase;
+
+    if (total == 0)
+        throw std::invalid_argument("the operation mix is empty");
+
+    if (workload.keys.empty() || workload.hits.empty() || workload.misses.empty())
+        throw std::invalid_argument("the workload must have keys, hits and misses");
+
+    std::mt19937_64 random(seed);
+    std::vector<Operation<Key>> result;
+    std::deque<Key> inserted;
+    size_t nextHit = 0, nextMiss = 0, nextOriginal = 0;
+
+    result.reserve(count);
+
+    for (size_t i = 0; i < count; ++i) {
+        unsigned roll = static_cast<unsigned>(random() % total);
+
+        if (roll < mix.insert) {
+            const Key& key = workload.misses[nextMiss++ % workload.misses.size()];
+            result.push_back({ OperationType::Insert, key });
+            inserted.push_back(key);
+        }
+        else if (roll < mix.insert + mix.lookup) {
+            result.push_back({ OperationType::Lookup, workload.hits[nextHit++ % workload.hits.size()] });
+        }
+        else if ( ! inserted.empty() ) {
+            result.push_back({ OperationType::Erase, inserted.front() });
+            inserted.pop_front();
+        }
+        else {
+            result.push_back({ OperationType::Erase, workload.keys[nextOriginal++ % workload.keys.size()] });
+        }
+    }
+
+    return result;
+}
@@ -2,11 +2,16 @@
 #include "utils/Allocator.h"
 #include "utils/MockingObjects.h"
 
+#include <cstdint>
+#include <set>
+#include <vector>
+
 TEMPLATE_TEST_CASE(
     "Allocator::buy correctly forwards its arguments",
     "[allocator]",
     SimpleAllocator<SingleNonCopiableParameterDummy>,
-    DebugAllocator<SingleNonCopiableParameterDummy>)
+    DebugAllocator<SingleNonCopiableParameterDummy>,
+    PoolAllocator<SingleNonCopiableParameterDummy>)
 {
     TestType allocator;
     SingleNonCopiableParameterDummy* result = allocator.buy(NonCopiableDummy());
@@ -98,3 +103,104 @@ TEST_CASE("DebugAllocator::failAfter() can be used to set the failAfter counter"
         REQUIRE_THROWS_AS(allocator.buy(), std::bad_alloc);
     }
 }
+
+TEST_CASE("PoolAllocator reuses released objects and allocates chunks as needed", "[allocator]")
+{
+    PoolAllocator<long long> pool(4);
+    std::vector<long long*> allocations;
+
+    CHECK(pool.chunksCount() == 0);
+
+    for(int i = 0; i < 10; ++i) {
+        allocations.push_back(pool.buy(i));
+        CHECK(*allocations.back() == i);
+        CHECK(pool.activeAllocationsCount() == i + 1);
+    }
+
+    CHECK(pool.chunksCount() == 3);
+
+    // The objects are distinct and correctly aligned
+    std::set<long long*> distinct(allocations.begin(), allocations.end());
+    CHECK(distinct.size() == allocations.size());
+
+    for(long long* ptr : allocations)
+        CHECK(reinterpret_cast<uintptr_t>(ptr) % alignof(long long) == 0);
+
+    long long* released = allocations[5];
+    pool.release(released);
+    CHECK(pool.activeAllocationsCount() == 9);
+
+    // The last released object is the first to be reused
+    CHECK(pool.buy(42) == released);
+    CHECK(pool.chunksCount() == 3);
+
+    CHECK_NOTHROW(pool.release(nullptr));
+    CHECK(pool.activeAllocationsCount() == 10);
+}
+
+TEST_CASE("PoolAllocator::clear() releases all objects at once", "[allocator]")
+{
+    PoolAllocator<int> pool(8);
+
+    for(int i = 0; i < 100; ++i)
+        pool.buy(i);
+
+    REQUIRE(pool.activeAllocationsCount() == 100);
+
+    pool.clear();
+
+    CHECK(pool.activeAllocationsCount() == 0);
+    CHECK(pool.chunksCount() == 0);
+
+    // The pool can be used again
+    int* ptr = pool.buy(5);
+    CHECK(*ptr == 5);
+    CHECK(pool.chunksCount() == 1);
+}
+
+TEST_CASE("PoolAllocator move assignment exchanges the objects of both pools", "[allocator]")
+{
+    PoolAllocator<int> pool(8);
+    PoolAllocator<int> other(4);
+
+    int* ptr = other.buy(5);
+    pool.buy(1);
+    pool.buy(2);
+
+    pool = std::move(other);
+
+    CHECK(pool.activeAllocationsCount() == 1);
+    CHECK(pool.objectsPerChunk() == 4);
+    CHECK(*ptr == 5);
+    pool.release(ptr);
+    CHECK(pool.buy(6) == ptr);
+
+    // The old objects of pool are freed together with other
+    CHECK(other.activeAllocationsCount() == 2);
+    CHECK(other.objectsPerChunk() == 8);
+}
+
+TEST_CASE("PoolAllocator::buy() returns the object to the pool when its constructor throws", "[allocator]")
+{
+    struct Throwing {
+        explicit Throwing(bool fail)
+        {
+            if(fail)
+                throw std::runtime_error("construction failed");
+        }
+    };
+
+    PoolAllocator<Throwing> pool(2);
+    Throwing* first = pool.buy(false);
+    pool.release(first);
+
+    CHECK_THROWS_AS(pool.buy(true), std::runtime_error);
+    CHECK(pool.activeAllocationsCount() == 0);
+    CHECK(pool.buy(false) == first);
+    CHECK(pool.chunksCount() == 1);
+}
+
+TEST_CASE("PoolAllocator requires a positive chunk size", "[allocator]")
+{
+    CHECK_THROWS_AS(PoolAllocator<int>(0), std::invalid_argument);
+}
@@ -0,0 +1,192 @@
+#include "catch2/catch_all.hpp"
+#include "utils/Arena.h"
+#include "utils/MockingObjects.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <list>
+#include <memory_resource>
+#include <set>
+#include <string>
+#include <vector>
+
+TEST_CASE("MonotonicArena returns aligned, non-overlapping blocks", "[arena]")
+{
+    MonotonicArena arena(64);
+    std::vector<std::pair<uintptr_t, size_t>> blocks;
+
+    for(size_t i = 0; i < 200; ++i) {
+        size_t size = 1 + i % 40;
+        size_t alignment = size_t(1) << (i % 7); // 1 to 64
+
+        uintptr_t address = reinterpret_cast<uintptr_t>(arena.allocate(size, alignment));
+        CHECK(address % alignment == 0);
+        blocks.push_back({ address, size });
+    }
+
+    std::sort(blocks.begin(), blocks.end());
+
+    for(size_t i = 1; i < blocks.size(); ++i)
+        CHECK(blocks[i-1].first + blocks[i-1].second <= blocks[i].first);
+
+    CHECK(arena.chunksCount() > 1);
+    CHECK(arena.bytesReserved() >= arena.bytesAllocated());
+}
+
+TEST_CASE("MonotonicArena handles blocks larger than a chunk", "[arena]")
+{
+    MonotonicArena arena(16);
+
+    void* ptr = arena.allocate(1000, 64);
+    CHECK(reinterpret_cast<uintptr_t>(ptr) % 64 == 0);
+    CHECK(arena.bytesAllocated() == 1000);
+    CHECK(arena.bytesReserved() >= 1000);
+}
+
+TEST_CASE("MonotonicArena::reset() keeps the largest chunk for reuse", "[arena]")
+{
+    MonotonicArena arena(64);
+
+    for(int i = 0; i < 100; ++i)
+        arena.allocate(16);
+
+    size_t chunks = arena.chunksCount();
+    REQUIRE(chunks > 1);
+
+    arena.reset();
+
+    CHECK(arena.chunksCount() == 1);
+    CHECK(arena.bytesAllocated() == 0);
+
+    size_t reserved = arena.bytesReserved();
+    arena.allocate(16);
+    CHECK(arena.bytesReserved() == reserved);
+}
+
+TEST_CASE("MonotonicArena::reset() keeps an oversized chunk, which is the largest", "[arena]")
+{
+    MonotonicArena arena(64);
+
+    arena.allocate(10'000);
+    size_t largest = arena.bytesReserved();
+
+    // Fill the oversized chunk, so the next block gets a regular, smaller chunk
+    while(arena.chunksCount() < 2)
+        arena.allocate(16);
+
+    REQUIRE(arena.bytesReserved() < 2 * largest);
+
+    arena.reset();
+
+    CHECK(arena.chunksCount() == 1);
+    CHECK(arena.bytesReserved() == largest);
+
+    arena.allocate(10'000);
+    CHECK(arena.chunksCount() == 1);
+}
+
+TEST_CASE("MonotonicArena requires a positive chunk size", "[arena]")
+{
+    CHECK_THROWS_AS(MonotonicArena(0), std::invalid_argument);
+}
+
+TEST_CASE("ArenaAllocator::buy correctly forwards its arguments", "[arena]")
+{
+    ArenaAllocator<SingleNonCopiableParameterDummy> allocator;
+    SingleNonCopiableParameterDummy* result = allocator.buy(NonCopiableDummy());
+    allocator.release(result);
+}
+
+TEST_CASE("ArenaAllocator allocates from a shared arena", "[arena]")
+{
+    auto arena = std::make_shared<MonotonicArena>();
+    ArenaAllocator<int> ints(arena);
+    ArenaAllocator<std::string> strings(arena);
+
+    int* number = ints.buy(5);
+    std::string* text = strings.buy("arena");
+
+    CHECK(*number == 5);
+    CHECK(*text == "arena");
+    CHECK(arena->bytesAllocated() == sizeof(int) + sizeof(std::string));
+
+    // Releasing destroys the object, but does not reclaim its memory
+    strings.release(text);
+    ints.release(number);
+    CHECK(arena->bytesAllocated() == sizeof(int) + sizeof(std::string));
+
+    // A shared arena is not reset by one of its users
+    ints.clear();
+    CHECK(arena->bytesAllocated() == sizeof(int) + sizeof(std::string));
+
+    arena->reset();
+    CHECK(arena->bytesAllocated() == 0);
+}
+
+TEST_CASE("ArenaAllocator::clear() resets an arena, which it owns", "[arena]")
+{
+    ArenaAllocator<int> allocator;
+
+    for(int i = 0; i < 100; ++i)
+        allocator.buy(i);
+
+    CHECK(allocator.arena().bytesAllocated() == 100 * sizeof(int));
+
+    allocator.clear();
+    CHECK(allocator.arena().bytesAllocated() == 0);
+}
+
+TEST_CASE("A moved-from ArenaAllocator can still allocate", "[arena]")
+{
+    ArenaAllocator<int> source;
+    int* number = source.buy(5);
+
+    SECTION("move construction gives the source a new arena") {
+        ArenaAllocator<int> target(std::move(source));
+
+        CHECK(*number == 5);
+        CHECK(target.arena().bytesAllocated() == sizeof(int));
+        CHECK(source.arena().bytesAllocated() == 0);
+        CHECK(target.shared_arena() != source.shared_arena());
+    }
+
+    SECTION("move assignment exchanges the arenas") {
+        ArenaAllocator<int> target;
+        std::shared_ptr<MonotonicArena> targetArena = target.shared_arena();
+
+        target = std::move(source);
+
+        CHECK(*number == 5);
+        CHECK(target.arena().bytesAllocated() == sizeof(int));
+        CHECK(source.shared_arena() == targetArena);
+    }
+
+    CHECK(*source.buy(6) == 6);
+}
+
+TEST_CASE("ArenaResource lets standard containers use the arena", "[arena]")
+{
+    MonotonicArena arena;
+    ArenaResource resource(arena);
+
+    std::pmr::vector<int> values(&resource);
+    std::pmr::list<int> list(&resource);
+
+    for(int i = 0; i < 100; ++i) {
+        values.push_back(i);
+        list.push_back(i);
+    }
+
+    CHECK(values.size() == 100);
+    CHECK(list.size() == 100);
+    CHECK(values.back() == 99);
+    CHECK(arena.bytesAllocated() >= 200 * sizeof(int));
+
+    ArenaResource sameArena(arena);
+    MonotonicArena otherArena;
+    ArenaResource other(otherArena);
+
+    CHECK(resource.is_equal(sameArena));
+    CHECK_FALSE(resource.is_equal(other));
+    CHECK_FALSE(resource.is_equal(*std::pmr::new_delete_resource()));
+}
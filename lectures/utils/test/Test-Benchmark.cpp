@@ -0,0 +1,82 @@
+#include "catch2/catch_all.hpp"
+#include "utils/Benchmark.h"
+
+#include <sstream>
+
+using Catch::Matchers::WithinRel;
+
+TEST_CASE("computeStatistics summarizes the samples", "[benchmark]")
+{
+    BenchmarkStatistics stats = computeStatistics({ 5, 1, 4, 2, 3 });
+
+    CHECK(stats.samples == 5);
+    CHECK(stats.min == 1);
+    CHECK(stats.max == 5);
+    CHECK(stats.median == 3);
+    CHECK(stats.mean == 3);
+    CHECK_THAT(stats.stddev, WithinRel(std::sqrt(2.5)));
+    CHECK_THAT(stats.p99, WithinRel(4.96));
+}
+
+TEST_CASE("computeStatistics handles small sets of samples", "[benchmark]")
+{
+    CHECK(computeStatistics({}).samples == 0);
+
+    BenchmarkStatistics single = computeStatistics({ 7 });
+    CHECK(single.median == 7);
+    CHECK(single.p99 == 7);
+    CHECK(single.stddev == 0);
+
+    CHECK_THAT(computeStatistics({ 1, 2, 3, 4 }).median, WithinRel(2.5));
+}
+
+TEST_CASE("BenchmarkRunner runs the warm-up and the measured runs", "[benchmark]")
+{
+    BenchmarkOptions options;
+    options.warmupRuns = 2;
+    options.repetitions = 5;
+
+    BenchmarkRunner runner(options);
+    int setups = 0, runs = 0;
+
+    const BenchmarkResult& result = runner.run("name", "operation", 10, 100,
+        [&setups]() { return ++setups; },
+        [&runs](int setup) { ++runs; CHECK(setup == runs); });
+
+    CHECK(setups == 7);
+    CHECK(runs == 7);
+    CHECK(result.nanoseconds.samples == 5);
+    CHECK(result.nanoseconds.min >= 0);
+    CHECK(result.operations == 100);
+    CHECK(runner.results().size() == 1);
+}
+
+TEST_CASE("BenchmarkRunner writes CSV and JSON", "[benchmark]")
+{
+    BenchmarkOptions options;
+    options.warmupRuns = 0;
+    options.repetitions = 1;
+
+    BenchmarkRunner runner(options);
+    runner.run("set<int, \"x\">", "fill", 1, 1, []() {});
+    runner.run("vector", "hit", 2, 2, []() {});
+
+    std::ostringstream csv;
+    runner.writeCsv(csv);
+    std::string text = csv.str();
+
+    CHECK(text.starts_with("name,operation,size,operations,samples,median_ns"));
+    CHECK(text.find(",page_faults_per_op\n") != std::string::npos);
+    CHECK(std::count(text.begin(), text.end(), '\n') == 3);
+    CHECK(text.find("\"vector\",hit,2,2,1,") != std::string::npos);
+    CHECK(text.find("\n\"set<int, \"\"x\"\">\",fill,1,1,1,") != std::string::npos); // Quotes are doubled
+    CHECK(text.find(",,,,,,\n") != std::string::npos); // No events were counted
+
+    std::ostringstream json;
+    runner.writeJson(json);
+    text = json.str();
+
+    CHECK(text.find("\"name\": \"set<int, \\\"x\\\">\"") != std::string::npos);
+    CHECK(text.find("\"operation\": \"hit\"") != std::string::npos);
+    CHECK(text.find("\"repetitions\": 1") != std::string::npos);
+}
@@ -0,0 +1,73 @@
+#include "catch2/catch_all.hpp"
+#include "utils/CountingAllocator.h"
+
+#include <list>
+#include <vector>
+
+TEST_CASE("CountingAllocator counts live and peak memory", "[allocator]")
+{
+    CountingAllocator<int> allocator;
+    const AllocationCounter& counter = allocator.counter();
+
+    int* first = allocator.allocate(10);
+    int* second = allocator.allocate(5);
+
+    CHECK(counter.liveBytes == 15 * sizeof(int));
+    CHECK(counter.liveBlocks == 2);
+
+    allocator.deallocate(first, 10);
+
+    CHECK(counter.liveBytes == 5 * sizeof(int));
+    CHECK(counter.liveBlocks == 1);
+    CHECK(counter.peakBytes == 15 * sizeof(int));
+    CHECK(counter.requestedBytes == 15 * sizeof(int));
+    CHECK(counter.allocations == 2);
+
+    allocator.deallocate(second, 5);
+    CHECK(counter.liveBytes == 0);
+}
+
+TEST_CASE("CountingAllocator copies and rebound copies share the counter", "[allocator]")
+{
+    CountingAllocator<int> allocator;
+    CountingAllocator<double> rebound(allocator);
+    CountingAllocator<int> moved(std::move(allocator));
+
+    CHECK(rebound == allocator);
+    CHECK(moved == allocator); // Moving leaves the source valid and equal
+    CHECK(allocator != CountingAllocator<int>());
+
+    double* p = rebound.allocate(1);
+    CHECK(allocator.counter().liveBytes == sizeof(double));
+    rebound.deallocate(p, 1);
+}
+
+TEST_CASE("CountingAllocator measures the memory of standard containers", "[allocator]")
+{
+    CountingAllocator<int> allocator;
+    const AllocationCounter& counter = allocator.counter();
+
+    // The containers may allocate more than their elements (e.g. a
+    // sentinel node or debug proxies), so only the changes are checked
+    {
+        std::vector<int, CountingAllocator<int>> vector(allocator);
+        size_t bytesBefore = counter.liveBytes;
+
+        vector.reserve(100);
+        CHECK(counter.liveBytes - bytesBefore >= 100 * sizeof(int));
+
+        std::list<int, CountingAllocator<int>> list(allocator);
+        size_t blocksBefore = counter.liveBlocks;
+        bytesBefore = counter.liveBytes;
+
+        for(int i = 0; i < 10; ++i)
+            list.push_back(i);
+
+        // Each node holds the element and two pointers
+        CHECK(counter.liveBlocks - blocksBefore == 10);
+        CHECK(counter.liveBytes - bytesBefore >= 10 * (sizeof(int) + 2 * sizeof(void*)));
+    }
+
+    CHECK(counter.liveBytes == 0);
+    CHECK(counter.liveBlocks == 0);
+}
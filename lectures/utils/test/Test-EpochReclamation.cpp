@@ -0,0 +1,81 @@
+#include "catch2/catch_all.hpp"
+#include "utils/EpochReclamation.h"
+
+namespace {
+
+struct DestructionCounter {
+    int& counter;
+
+    explicit DestructionCounter(int& counter)
+        : counter(counter)
+    {
+    }
+
+    ~DestructionCounter()
+    {
+        ++counter;
+    }
+};
+
+void reclaimSeveralTimes(EpochReclamation& domain)
+{
+    for(int i = 0; i < 4; ++i)
+        domain.reclaim();
+}
+
+} // namespace
+
+TEST_CASE("EpochReclamation does not delete a retired object while a guard is alive", "[epoch]")
+{
+    EpochReclamation& domain = EpochReclamation::instance();
+    int destroyed = 0;
+
+    {
+        EpochReclamation::Guard guard;
+        domain.retire(new DestructionCounter(destroyed));
+
+        reclaimSeveralTimes(domain);
+        CHECK(destroyed == 0);
+    }
+
+    reclaimSeveralTimes(domain);
+    CHECK(destroyed == 1);
+}
+
+TEST_CASE("EpochReclamation::Guard can be nested", "[epoch]")
+{
+    EpochReclamation& domain = EpochReclamation::instance();
+    int destroyed = 0;
+
+    {
+        EpochReclamation::Guard outer;
+
+        {
+            EpochReclamation::Guard inner;
+            domain.retire(new DestructionCounter(destroyed));
+        }
+
+        // The thread is still inside the outer guard
+        reclaimSeveralTimes(domain);
+        CHECK(destroyed == 0);
+    }
+
+    reclaimSeveralTimes(domain);
+    CHECK(destroyed == 1);
+}
+
+TEST_CASE("EpochReclamation eventually deletes all retired objects", "[epoch]")
+{
+    EpochReclamation& domain = EpochReclamation::instance();
+    int destroyed = 0;
+    const int count = 1'000;
+
+    for(int i = 0; i < count; ++i) {
+        EpochReclamation::Guard guard;
+        domain.retire(new DestructionCounter(destroyed));
+    }
+
+    reclaimSeveralTimes(domain);
+    CHECK(destroyed == count);
+    CHECK(domain.pendingCount() == 0);
+}
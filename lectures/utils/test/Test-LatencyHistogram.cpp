@@ -0,0 +1,156 @@
+#include "catch2/catch_all.hpp"
+#include "utils/LatencyHistogram.h"
+#include "utils/ScopedTimer.h"
+
+#include <chrono>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+TEST_CASE("LatencyHistogram buckets cover all values", "[histogram]")
+{
+    // Small values are exact
+    for (uint64_t value = 0; value < 2 * LatencyHistogram::SubBucketsCount; ++value) {
+        CHECK(LatencyHistogram::bucketFor(value) == value);
+        CHECK(LatencyHistogram::lowestValueIn(value) == value);
+        CHECK(LatencyHistogram::highestValueIn(value) == value);
+    }
+
+    // Consecutive buckets have no gaps between them
+    for (size_t bucket = 1; bucket < LatencyHistogram::BucketsCount; ++bucket)
+        CHECK(LatencyHistogram::lowestValueIn(bucket) == LatencyHistogram::highestValueIn(bucket - 1) + 1);
+
+    CHECK(LatencyHistogram::highestValueIn(LatencyHistogram::BucketsCount - 1) == std::numeric_limits<uint64_t>::max());
+
+    std::mt19937_64 random(42);
+
+    for (int i = 0; i < 10000; ++i) {
+        uint64_t value = random() >> (random() % 64);
+        size_t bucket = LatencyHistogram::bucketFor(value);
+
+        REQUIRE(bucket < LatencyHistogram::BucketsCount);
+        CHECK(LatencyHistogram::lowestValueIn(bucket) <= value);
+        CHECK(value <= LatencyHistogram::highestValueIn(bucket));
+
+        // The width of a bucket is at most 1/32 of its values
+        uint64_t width = LatencyHistogram::highestValueIn(bucket) - LatencyHistogram::lowestValueIn(bucket);
+        CHECK(width <= LatencyHistogram::lowestValueIn(bucket) / LatencyHistogram::SubBucketsCount);
+    }
+}
+
+TEST_CASE("LatencyHistogram percentiles have a bounded relative error", "[histogram]")
+{
+    auto histogram = std::make_unique<LatencyHistogram>();
+
+    SECTION("Empty") {
+        CHECK(histogram->count() == 0);
+        CHECK(histogram->percentile(50) == 0);
+        CHECK(histogram->min() == 0);
+        CHECK(histogram->max() == 0);
+        CHECK(histogram->mean() == 0);
+    }
+    SECTION("Values 1 to 100000") {
+        for (uint64_t value = 1; value <= 100000; ++value)
+            histogram->record(value);
+
+        CHECK(histogram->count() == 100000);
+        CHECK(histogram->min() == 1);
+        CHECK(histogram->max() == 100000);
+        CHECK(histogram->mean() == 50000.5);
+        CHECK(histogram->percentile(0) == 1);
+        CHECK(histogram->percentile(100) == 100000);
+
+        for (double percent : { 1.0, 10.0, 50.0, 90.0, 99.0, 99.9 }) {
+            double exact = percent * 1000;
+            double estimate = static_cast<double>(histogram->percentile(percent));
+
+            CHECK(estimate >= exact);
+            CHECK(estimate <= exact * (1 + 1.0 / LatencyHistogram::SubBucketsCount));
+        }
+    }
+    SECTION("A long tail") {
+        for (int i = 0; i < 990; ++i)
+            histogram->record(50);
+        for (int i = 0; i < 10; ++i)
+            histogram->record(1'000'000);
+
+        CHECK(histogram->percentile(50) == 50);
+        CHECK(histogram->percentile(99) == 50);
+        CHECK(histogram->percentile(99.5) == 1'000'000);
+    }
+}
+
+TEST_CASE("LatencyHistogram can be merged and reset", "[histogram]")
+{
+    auto first = std::make_unique<LatencyHistogram>();
+    auto second = std::make_unique<LatencyHistogram>();
+
+    first->record(10);
+    first->record(20);
+    second->record(5);
+    second->record(1000);
+
+    first->merge(*second);
+
+    CHECK(first->count() == 4);
+    CHECK(first->min() == 5);
+    CHECK(first->max() == 1000);
+    CHECK(first->mean() == 258.75);
+    CHECK(second->count() == 2);
+
+    first->reset();
+
+    CHECK(first->count() == 0);
+    CHECK(first->min() == 0);
+    CHECK(first->max() == 0);
+
+    // Merging an empty histogram does not change the extremes
+    second->merge(*first);
+
+    CHECK(second->min() == 5);
+    CHECK(second->max() == 1000);
+}
+
+TEST_CASE("LatencyHistogram records from many threads", "[histogram]")
+{
+    const int threadsCount = 4;
+    const uint64_t valuesPerThread = 100000;
+
+    auto histogram = std::make_unique<LatencyHistogram>();
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < threadsCount; ++t) {
+        threads.emplace_back([&histogram, t, valuesPerThread]() {
+            for (uint64_t value = 1; value <= valuesPerThread; ++value)
+                histogram->record(value * (t + 1));
+        });
+    }
+
+    for (std::thread& thread : threads)
+        thread.join();
+
+    CHECK(histogram->count() == threadsCount * valuesPerThread);
+    CHECK(histogram->min() == 1);
+    CHECK(histogram->max() == threadsCount * valuesPerThread);
+    CHECK(histogram->mean() == (valuesPerThread + 1) / 2.0 * (1 + 2 + 3 + 4) / threadsCount);
+}
+
+TEMPLATE_TEST_CASE("ScopedTimer records the duration of its scope", "[histogram]", SteadyTimerClock, FastTimerClock)
+{
+    auto histogram = std::make_unique<LatencyHistogram>();
+
+    {
+        ScopedTimer<TestType> timer(*histogram);
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+
+        CHECK(timer.elapsed() >= 1'500'000);
+        CHECK(histogram->count() == 0);
+    }
+
+    REQUIRE(histogram->count() == 1);
+
+    // Allow for a slightly imprecise calibration of the TSC
+    CHECK(histogram->min() >= 1'900'000);
+    CHECK(histogram->max() < 1'000'000'000);
+}
@@ -0,0 +1,84 @@
+#include "catch2/catch_all.hpp"
+#include "utils/Benchmark.h"
+#include "utils/PerfCounters.h"
+
+#include <memory>
+#include <sstream>
+
+// The counters may not be available where the tests run (e.g. in a
+// container or a virtual machine), so the tests check only what is
+// available, and that the rest is reported as such.
+
+TEST_CASE("PerfCounters have no values before they are stopped", "[perf]")
+{
+    PerfCounters counters;
+
+    for (int e = 0; e < PerfCounters::EventsCount; ++e)
+        CHECK_FALSE(counters.counted(static_cast<PerfCounters::Event>(e)));
+
+    std::ostringstream out;
+    out << counters;
+    CHECK_FALSE(out.str().empty());
+}
+
+TEST_CASE("PerfCounters count only the available events", "[perf]")
+{
+    PerfCounters counters;
+
+    counters.start();
+
+    // Touch new memory, to cause page faults
+    const size_t size = 16 * 1024 * 1024;
+    std::unique_ptr<char[]> memory(new char[size]);
+    for (size_t i = 0; i < size; i += 4096)
+        memory[i] = static_cast<char>(i);
+    doNotOptimize(memory[size / 2]);
+
+    counters.stop();
+
+    for (int e = 0; e < PerfCounters::EventsCount; ++e) {
+        auto event = static_cast<PerfCounters::Event>(e);
+
+        if ( ! counters.available(event) ) {
+            CHECK_FALSE(counters.counted(event));
+        }
+    }
+
+    if (counters.counted(PerfCounters::PageFaults))
+        CHECK(counters.value(PerfCounters::PageFaults) > 0);
+
+    if (counters.counted(PerfCounters::Instructions))
+        CHECK(counters.value(PerfCounters::Instructions) > size / 4096);
+}
+
+TEST_CASE("BenchmarkRunner reports events per operation", "[perf][benchmark]")
+{
+    BenchmarkOptions options;
+    options.warmupRuns = 0;
+    options.repetitions = 2;
+
+    SECTION("Not counted unless requested") {
+        BenchmarkRunner runner(options);
+        const BenchmarkResult& result = runner.run("name", "operation", 1, 1, []() {});
+
+        CHECK(runner.counters() == nullptr);
+
+        for (double count : result.eventsPerOperation)
+            CHECK(std::isnan(count));
+    }
+
+    SECTION("Counted when requested and available") {
+        options.countEvents = true;
+        BenchmarkRunner runner(options);
+        const BenchmarkResult& result = runner.run("name", "operation", 1, 1, []() {});
+
+        REQUIRE(runner.counters() != nullptr);
+
+        for (int e = 0; e < PerfCounters::EventsCount; ++e) {
+            if (runner.counters()->available(static_cast<PerfCounters::Event>(e)))
+                CHECK(result.eventsPerOperation[e] >= 0);
+            else
+                CHECK(std::isnan(result.eventsPerOperation[e]));
+        }
+    }
+}
@@ -0,0 +1,181 @@
+#include "catch2/catch_all.hpp"
+#include "utils/MockingObjects.h"
+#include "utils/TrackingAllocator.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+TEST_CASE("TrackingAllocator::buy correctly forwards its arguments", "[allocator]")
+{
+    TrackingAllocator<SingleNonCopiableParameterDummy> allocator;
+    SingleNonCopiableParameterDummy* result = allocator.buy(NonCopiableDummy());
+    allocator.release(result);
+}
+
+TEST_CASE("TrackingAllocator allocates and releases correctly", "[allocator]")
+{
+    TrackingAllocator<int> allocator;
+    std::vector<int*> allocations;
+    const int count = 5;
+
+    for(int i = 1; i <= count; ++i) {
+        allocations.push_back(allocator.buy(i));
+        CHECK(*allocations.back() == i);
+        CHECK(allocator.activeAllocationsCount() == i);
+        CHECK(allocator.totalAllocationsCount() == i);
+    }
+
+    for(int i = count-1; i >= 0; --i) {
+        CHECK_NOTHROW(allocator.release(allocations[i]));
+        CHECK(allocator.activeAllocationsCount() == i);
+        CHECK(allocator.totalAllocationsCount() == count);
+    }
+
+    CHECK_NOTHROW(allocator.release(nullptr));
+}
+
+TEST_CASE("TrackingAllocator respects the alignment of the objects", "[allocator]")
+{
+    struct alignas(64) Aligned {
+        char data[64];
+    };
+
+    TrackingAllocator<Aligned> allocator;
+    std::vector<Aligned*> allocations;
+
+    for(int i = 0; i < 10; ++i) {
+        allocations.push_back(allocator.buy());
+        CHECK(reinterpret_cast<uintptr_t>(allocations.back()) % 64 == 0);
+    }
+
+    for(Aligned* ptr : allocations)
+        allocator.release(ptr);
+}
+
+TEST_CASE("TrackingAllocator::failAfter() makes the following allocations fail", "[allocator]")
+{
+    SECTION("Set in the constructor") {
+        TrackingAllocator<int> allocator(3);
+
+        for(int i = 0; i < 3; ++i)
+            allocator.release(allocator.buy());
+
+        CHECK_THROWS_AS(allocator.buy(), std::bad_alloc);
+        CHECK(allocator.totalAllocationsCount() == 3);
+        CHECK(allocator.activeAllocationsCount() == 0);
+    }
+    SECTION("Set later, counting the allocations made so far") {
+        TrackingAllocator<int> allocator;
+        int* first = allocator.buy();
+
+        allocator.failAfter(3);
+
+        allocator.release(allocator.buy());
+        allocator.release(allocator.buy());
+
+        CHECK_THROWS_AS(allocator.buy(), std::bad_alloc);
+        allocator.release(first);
+    }
+}
+
+TEST_CASE("TrackingAllocator injects random faults reproducibly", "[allocator]")
+{
+    auto failures = [](uint64_t seed) {
+        TrackingOptions options;
+        options.failureProbability = 0.25;
+        options.seed = seed;
+
+        TrackingAllocator<int> allocator(options);
+        std::vector<bool> result;
+
+        for(int i = 0; i < 1000; ++i) {
+            try {
+                allocator.release(allocator.buy());
+                result.push_back(false);
+            }
+            catch(std::bad_alloc&) {
+                result.push_back(true);
+            }
+        }
+
+        return result;
+    };
+
+    std::vector<bool> first = failures(1);
+    size_t count = std::count(first.begin(), first.end(), true);
+
+    CHECK(count > 200);
+    CHECK(count < 300);
+    CHECK(failures(1) == first);
+    CHECK(failures(2) != first);
+}
+
+TEST_CASE("TrackingAllocator samples the allocations, which are not released", "[allocator]")
+{
+    TrackingOptions options;
+    options.sampleEvery = 1;
+
+    TrackingAllocator<int> allocator(options);
+
+    int* leaked = allocator.buy(1);
+    allocator.release(allocator.buy(2));
+
+    auto leaks = allocator.sampledLeaks();
+
+    REQUIRE(leaks.size() == 1);
+    CHECK(leaks[0].first == leaked);
+    CHECK(leaks[0].second.framesCount > 0);
+
+    std::ostringstream report;
+    allocator.printLeaks(report);
+    CHECK(report.str().find("1 live objects") == 0);
+
+    allocator.release(leaked);
+    CHECK(allocator.sampledLeaks().empty());
+}
+
+TEST_CASE("TrackingAllocator counts correctly from many threads", "[allocator]")
+{
+    TrackingOptions options;
+    options.sampleEvery = 7;
+
+    TrackingAllocator<int> allocator(options);
+    const int threadsCount = 4;
+    const int perThread = 10000;
+    std::vector<std::thread> threads;
+    std::vector<int*> kept(threadsCount);
+
+    for(int t = 0; t < threadsCount; ++t) {
+        threads.emplace_back([&allocator, &kept, t]() {
+            std::vector<int*> allocations;
+
+            for(int i = 0; i < perThread; ++i)
+                allocations.push_back(allocator.buy(i));
+
+            // Keep the last one alive
+            for(int i = 0; i < perThread - 1; ++i)
+                allocator.release(allocations[i]);
+
+            kept[t] = allocations.back();
+        });
+    }
+
+    for(std::thread& thread : threads)
+        thread.join();
+
+    CHECK(allocator.totalAllocationsCount() == threadsCount * perThread);
+    CHECK(allocator.activeAllocationsCount() == threadsCount);
+
+    // Only the objects, which are still alive, can be among the samples
+    for(const auto& leak : allocator.sampledLeaks())
+        CHECK(std::find(kept.begin(), kept.end(), leak.first) != kept.end());
+
+    for(int* ptr : kept)
+        allocator.release(ptr);
+
+    CHECK(allocator.activeAllocationsCount() == 0);
+    CHECK(allocator.sampledLeaks().empty());
+}
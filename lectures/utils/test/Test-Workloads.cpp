@@ -0,0 +1,123 @@
+#include "catch2/catch_all.hpp"
+#include "utils/Workloads.h"
+
+#include <set>
+
+TEMPLATE_TEST_CASE(
+	"Workloads have distinct keys, hits among them and misses outside",
+	"[workloads]",
+	int, uint64_t, std::string)
+{
+    std::vector<Workload<TestType>> workloads;
+
+    if constexpr (std::is_same_v<TestType, int>) {
+        workloads.push_back(sequentialWorkload(1000, 500));
+        workloads.push_back(negativeWorkload(1000, 500));
+        workloads.push_back(clusteredWorkload(1000, 500));
+    }
+    else if constexpr (std::is_same_v<TestType, uint64_t>) {
+        workloads.push_back(randomWorkload(1000, 500));
+        workloads.push_back(zipfWorkload(1000, 500));
+    }
+    else {
+        workloads.push_back(shortStringWorkload(1000, 500));
+        workloads.push_back(longStringWorkload(1000, 500));
+    }
+
+    for (const Workload<TestType>& workload : workloads) {
+        std::set<TestType> keys(workload.keys.begin(), workload.keys.end());
+
+        CHECK(workload.keys.size() == 1000);
+        CHECK(keys.size() == 1000);
+        CHECK(workload.hits.size() == 500);
+        CHECK(workload.misses.size() == 500);
+
+        for (const TestType& key : workload.hits)
+            REQUIRE(keys.count(key) == 1);
+
+        for (const TestType& key : workload.misses)
+            REQUIRE(keys.count(key) == 0);
+    }
+}
+
+TEST_CASE("Workloads are deterministic for a given seed", "[workloads]")
+{
+    CHECK(randomWorkload(100, 100, 1).hits == randomWorkload(100, 100, 1).hits);
+    CHECK(randomWorkload(100, 100, 1).keys != randomWorkload(100, 100, 2).keys);
+}
+
+TEST_CASE("negativeWorkload uses only negative keys", "[workloads]")
+{
+    Workload<int> workload = negativeWorkload(100, 100);
+
+    for (int key : workload.keys)
+        CHECK(key < 0);
+}
+
+TEST_CASE("ZipfDistribution prefers the lowest ranks", "[workloads]")
+{
+    ZipfDistribution zipf(1000, 0.99);
+    std::mt19937_64 random(42);
+    std::vector<size_t> counts(1000);
+
+    for (int i = 0; i < 100'000; ++i) {
+        size_t rank = zipf(random);
+        REQUIRE(rank < 1000);
+        ++counts[rank];
+    }
+
+    // The first rank gets ~13% of the samples, the top 10 ~39%
+    CHECK(counts[0] > 10'000);
+    CHECK(counts[0] > counts[1]);
+    CHECK(counts[1] > counts[10]);
+    CHECK(counts[10] > counts[999]);
+
+    CHECK_THROWS_AS(ZipfDistribution(0, 1.0), std::invalid_argument);
+}
+
+TEST_CASE("generateOperations follows the operation mix", "[workloads]")
+{
+    Workload<int> workload = sequentialWorkload(1000, 1000);
+    std::vector<Operation<int>> operations = generateOperations(workload, OperationMix{ 10, 80, 10 }, 10'000);
+
+    REQUIRE(operations.size() == 10'000);
+
+    size_t counts[3] = {};
+    std::set<int> present(workload.keys.begin(), workload.keys.end());
+
+    for (const Operation<int>& operation : operations) {
+        ++counts[static_cast<int>(operation.type)];
+
+        if (operation.type == OperationType::Lookup)
+            CHECK(present.count(operation.key) == 1);
+    }
+
+    CHECK(counts[0] > 800);
+    CHECK(counts[0] < 1200);
+    CHECK(counts[1] > 7500);
+    CHECK(counts[2] > 800);
+    CHECK(counts[2] < 1200);
+
+    CHECK_THROWS_AS(generateOperations(workload, OperationMix{ 0, 0, 0 }, 10), std::invalid_argument);
+}
+
+TEST_CASE("generateOperations erases the inserted keys first", "[workloads]")
+{
+    Workload<int> workload = sequentialWorkload(10, 10);
+    std::vector<Operation<int>> operations = generateOperations(workload, OperationMix{ 50, 0, 50 }, 1000);
+    std::vector<int> inserted;
+    size_t nextErased = 0;
+
+    for (const Operation<int>& operation : operations) {
+        if (operation.type == OperationType::Insert) {
+            CHECK(operation.key >= 10); // Taken from the misses
+            inserted.push_back(operation.key);
+        }
+        else if (nextErased < inserted.size()) {
+            CHECK(operation.key == inserted[nextErased++]);
+        }
+        else {
+            CHECK(operation.key < 10); // Nothing inserted, so an original key is erased
+        }
+    }
+}